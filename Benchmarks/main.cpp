@@ -0,0 +1,1823 @@
+#include "FileSystem/Pak/PakBuilder.h"
+#include "FileSystem/Pak/PakFile.h"
+#include "System/Hash32.h"
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/File/TextFile.h"
+#include "FileSystem/File/TextReader.h"
+#include "System/ConfigFile.h"
+#include "FileSystem/Path.h"
+#include "FileSystem/Serialize.h"
+#include "FileSystem/Endian.h"
+#include "FileSystem/File/MappedFile.h"
+#include "Resource/MeshCooker.h"
+#include "Resource/ObjParser.h"
+#include "Resource/VertexWelder.h"
+#include "Resource/MeshOptimizer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+
+#ifdef WIN32
+	#include <Windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+	#include <unistd.h>
+#endif // WIN32
+
+//NOTE:
+/*
+	Timings for the pak, file, mesh and config code, split out of PakBuilder so the tool
+	only builds content. Each mode prints what it measured, they sanity check their own
+	output so a broken build cant report a good number, but the real checks are in Tests.
+	Benchmarks -codecbench <ContentFolder>
+	Benchmarks -readbench <Archive.pak> [MaxThreads]
+	Benchmarks -mountbench <Output.pak> [Entries]
+	Benchmarks -tracebench <Trace.txt> <Ordered.pak> <Unordered.pak>
+	Benchmarks -decodebench <Archive.pak> [MaxThreads]
+	Benchmarks -streambench <Archive.pak> [ReadSize]
+	Benchmarks -writebench <Output.bin> [MB]
+	Benchmarks -serialbench <Output.bin> [Vertices]
+	Benchmarks -swapbench [MB]
+	Benchmarks -configbench <Output.ini> [Lines]
+	Benchmarks -meshbench <Output.obj> [Triangles]
+	Benchmarks -meshload <Mesh.obj|Mesh.mesh>
+	Benchmarks -objbench <Output.obj> [Triangles] [MaxThreads]
+	Benchmarks -weldbench [Triangles]
+	Benchmarks -cachebench [Triangles]
+	Benchmarks -overdrawbench [Triangles] [Threshold]
+*/
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static void PrintUsage()
+{
+	printf("Usage: Benchmarks -codecbench <ContentFolder>\n");
+	printf("       Benchmarks -readbench <Archive.pak> [MaxThreads]\n");
+	printf("       Benchmarks -mountbench <Output.pak> [Entries]\n");
+	printf("       Benchmarks -tracebench <Trace.txt> <Ordered.pak> <Unordered.pak>\n");
+	printf("       Benchmarks -decodebench <Archive.pak> [MaxThreads]\n");
+	printf("       Benchmarks -streambench <Archive.pak> [ReadSize]\n");
+	printf("       Benchmarks -writebench <Output.bin> [MB]\n");
+	printf("       Benchmarks -serialbench <Output.bin> [Vertices]\n");
+	printf("       Benchmarks -swapbench [MB]\n");
+	printf("       Benchmarks -configbench <Output.ini> [Lines]\n");
+	printf("       Benchmarks -meshbench <Output.obj> [Triangles]\n");
+	printf("       Benchmarks -meshload <Mesh.obj|Mesh.mesh>\n");
+	printf("       Benchmarks -objbench <Output.obj> [Triangles] [MaxThreads]\n");
+	printf("       Benchmarks -weldbench [Triangles]\n");
+	printf("       Benchmarks -cachebench [Triangles]\n");
+	printf("       Benchmarks -overdrawbench [Triangles] [Threshold]\n");
+	printf("  -codecbench Report compress/decompress MB/s per codec for each file type\n");
+	printf("  -readbench  Read every entry from 1..MaxThreads loader threads, mapped and stdio,\n");
+	printf("              checking each read against a single threaded reference\n");
+	printf("  -mountbench Write an Entries (default 100000) directory as v1 (256 byte inline paths) and v2,\n");
+	printf("              then -mountload each in its own process for mount time and memory\n");
+	printf("  -tracebench Replay a trace against two archives, reports read time and seeks\n");
+	printf("  -decodebench Read every entry on one thread with 1..MaxThreads (default 16) decode threads\n");
+	printf("  -streambench Stream the largest entry in ReadSize (default 4096) reads, reports peak memory\n");
+	printf("  -writebench Write MB (default 500) as dwords unbuffered, buffered, then as one gather\n");
+	printf("  -serialbench Save and load a mesh sized vertex/index set per field vs through Serialize\n");
+	printf("  -swapbench  Endian swap MB (default 256) of 16/32/64 bit words with each kernel the cpu has\n");
+	printf("  -configbench Write a Lines (default 100000) line config, parse it the old way and with ConfigFile\n");
+	printf("  -meshbench  Write a Triangles (default 1000000) grid obj, cook it, then -meshload each in\n");
+	printf("              its own process so the peak memory is only that load's\n");
+	printf("  -meshload   Load one mesh the way Mesh does and report time and peak memory\n");
+	printf("  -objbench   Write a Triangles (default 1000000, 0 = use the file) quad grid obj, read it with\n");
+	printf("              tinyobj then ObjParser on 1..MaxThreads threads, checking each matches tinyobj\n");
+	printf("  -weldbench  Weld a Triangles (default 1000000) grid's corners with the old crc map and\n");
+	printf("              VertexWelder, checking no corner lands on a different vertex\n");
+	printf("  -cachebench Vertex cache optimize a Triangles (default 1000000) grid in row and shuffled\n");
+	printf("              order, reports ACMR/ATVR before and after and checks no triangle changed\n");
+	printf("  -overdrawbench Run a shuffled Triangles (default 200000) bumpy sphere through the cache,\n");
+	printf("              overdraw (Threshold default 1.05) and vertex fetch passes, reporting ACMR,\n");
+	printf("              rasterized overdraw and position stream overfetch after each\n");
+}
+
+static double Seconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Peak resident memory of the whole process so far, in MB
+static double PeakMemoryMB()
+{
+	#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS counters = {};
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+	#else
+		struct rusage usage = {};
+		getrusage(RUSAGE_SELF, &usage);
+		return usage.ru_maxrss / 1024.0; // KB on Linux
+	#endif // WIN32
+}
+
+// Resident memory of the whole process right now and the part of it that's private (heap,
+// not pages of mapped files the OS can drop and read back), in MB
+static void CurrentMemoryMB(double& resident, double& privateMB)
+{
+	#ifdef WIN32
+		PROCESS_MEMORY_COUNTERS_EX counters = {};
+		GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters));
+		resident = counters.WorkingSetSize / (1024.0 * 1024.0);
+		privateMB = counters.PrivateUsage / (1024.0 * 1024.0);
+	#else
+		long pages = 0, residentPages = 0, sharedPages = 0;
+		FILE* file = fopen("/proc/self/statm", "r");
+		if (file == nullptr || fscanf(file, "%ld %ld %ld", &pages, &residentPages, &sharedPages) != 3)
+		{
+			residentPages = sharedPages = 0;
+		}
+		if (file)
+		{
+			fclose(file);
+		}
+		double pageMB = sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+		resident = residentPages * pageMB;
+		privateMB = (residentPages - sharedPages) * pageMB;
+	#endif // WIN32
+}
+
+// Groups the content by extension (.obj, .png, .shader...) and times every compiled
+// in codec over each group, decode is looped until it's been timed for long enough.
+static int RunBenchmark(const std::string& contentFolder)
+{
+	std::map<std::string, std::vector<std::vector<u8>>> groups;
+	for (const std::string& path : Path::GetFiles(contentFolder, true))
+	{
+		BinaryFile file(path, FileMode::Read);
+		std::vector<u8> data((size_t)file.FileSize());
+		if (file.IsOpen() && data.empty() == false && file.Read(data.data(), (u32)data.size()))
+		{
+			groups[Path::FileExtention(path)].push_back(std::move(data));
+		}
+	}
+
+	if (groups.empty())
+	{
+		printf("No files found in %s\n", contentFolder.c_str());
+		return 1;
+	}
+
+	printf("%-10s %-6s %12s %8s %14s %14s\n", "Type", "Codec", "Bytes", "Ratio", "Compress MB/s", "Decode MB/s");
+	for (auto& group : groups)
+	{
+		u64 totalBytes = 0;
+		for (const std::vector<u8>& data : group.second)
+		{
+			totalBytes += data.size();
+		}
+
+		for (u32 c = (u32)PakCodec::LZ4; c < (u32)PakCodec::Count; ++c)
+		{
+			PakCodec codec = (PakCodec)c;
+			if (PakCompression::IsSupported(codec) == false)
+			{
+				continue;
+			}
+
+			std::vector<std::vector<u8>> compressed(group.second.size());
+			u64 compressedBytes = 0;
+
+			Clock::time_point start = Clock::now();
+			for (size_t i = 0; i < group.second.size(); ++i)
+			{
+				const std::vector<u8>& source = group.second[i];
+				compressed[i].resize(PakCompression::CompressBound(codec, (u32)source.size()));
+				u32 size = PakCompression::Compress(codec, source.data(), (u32)source.size(), compressed[i].data(), (u32)compressed[i].size());
+				compressed[i].resize(size);
+				compressedBytes += size;
+			}
+			double compressTime = Seconds(start);
+
+			std::vector<u8> decoded;
+			u32 passes = 0;
+			start = Clock::now();
+			do
+			{
+				for (size_t i = 0; i < group.second.size(); ++i)
+				{
+					decoded.resize(group.second[i].size());
+					PakCompression::Decompress(codec, compressed[i].data(), (u32)compressed[i].size(), decoded.data(), (u32)decoded.size());
+				}
+				++passes;
+			} while (Seconds(start) < 0.5);
+			double decodeTime = Seconds(start);
+
+			double megaBytes = totalBytes / (1024.0 * 1024.0);
+			printf("%-10s %-6s %12llu %8.3f %14.1f %14.1f\n", group.first.c_str(), PakCompression::Name(codec),
+				(unsigned long long)totalBytes, (double)compressedBytes / totalBytes, megaBytes / compressTime, (megaBytes * passes) / decodeTime);
+		}
+	}
+
+	return 0;
+}
+
+static bool ReadEntry(PakArchive& archive, u32 id, std::vector<u8>& buffer, u32& crc)
+{
+	std::unique_ptr<PakFile> file = archive.GetPakFile(id);
+	file->SeekEnd();
+	buffer.resize((size_t)file->FilePosition());
+	file->SeekStart();
+
+	if (buffer.empty() == false && file->Read(buffer.data(), (u32)buffer.size()) == false)
+	{
+		return false;
+	}
+
+	crc = Hash32::ComputeHash(buffer.data(), (u32)buffer.size());
+	return true;
+}
+
+// Stress test and scaling benchmark in one, every thread count reads the whole archive
+// through one shared PakArchive and any entry that doesnt match the reference fails the run.
+static int RunReadBenchmark(const std::string& pakPath, u32 maxThreads)
+{
+	for (int mapped = 1; mapped >= 0; --mapped)
+	{
+		Clock::time_point mountStart = Clock::now();
+		PakArchive archive(pakPath, mapped == 1);
+		if (archive.Mount() == false)
+		{
+			printf("Failed to mount %s\n", pakPath.c_str());
+			return 1;
+		}
+		double mountTime = Seconds(mountStart);
+
+		std::vector<u32> ids;
+		archive.GetFileIDs(ids);
+
+		std::vector<u32> reference(ids.size());
+		std::vector<u8> buffer;
+		u64 totalBytes = 0;
+		for (size_t i = 0; i < ids.size(); ++i)
+		{
+			if (ReadEntry(archive, ids[i], buffer, reference[i]) == false)
+			{
+				printf("Failed to read entry %08x\n", ids[i]);
+				return 1;
+			}
+			totalBytes += buffer.size();
+		}
+
+		u64 directoryBytes = (u64)archive.FileCount() * sizeof(PakEntry) + archive.Header().m_StringSize;
+		printf("%s (%s): %zu files, %.1f MB, mounted in %.3f ms, %.1f KB directory\n", pakPath.c_str(), archive.IsMapped() ? "mapped" : "stdio",
+			ids.size(), totalBytes / (1024.0 * 1024.0), mountTime * 1000.0, directoryBytes / 1024.0);
+		for (u32 threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+		{
+			std::atomic<size_t> next(0);
+			std::atomic<u32> failures(0);
+			const size_t passes = 4;
+
+			auto worker = [&]()
+			{
+				std::vector<u8> local;
+				u32 crc = 0;
+				for (size_t i = next++; i < ids.size() * passes; i = next++)
+				{
+					size_t index = i % ids.size();
+					if (ReadEntry(archive, ids[index], local, crc) == false || crc != reference[index])
+					{
+						++failures;
+					}
+				}
+			};
+
+			Clock::time_point start = Clock::now();
+			std::vector<std::thread> threads;
+			for (u32 i = 0; i < threadCount; ++i)
+			{
+				threads.emplace_back(worker);
+			}
+
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+
+			double time = Seconds(start);
+			printf("  %2u threads: %10.1f MB/s  %u mismatches\n", threadCount, (totalBytes * passes) / (1024.0 * 1024.0) / time, failures.load());
+			if (failures > 0)
+			{
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+// The version 1 layout, [PakEntryV1 * n][data][PakHeaderV1], as it was before the v2 directory.
+// Only kept here so the mount benchmark has something real too measure against.
+struct PakHeaderV1
+{
+	char m_ID[4] = { "PAK" };
+	int  m_Version = 1;
+	char m_FolderPath[256];
+	char m_PakName[50];
+	u32  m_Entries = 0;
+};
+
+struct PakEntryV1
+{
+	char m_FilePath[256];
+	bool m_Compressed;
+	u32	 m_HashID;
+	u32  m_UncompressedSize;
+	u32  m_CompressedSize;
+	u32  m_Offset;
+};
+
+// The v1 mount, read the header from the end then every entry one at a time into a map
+static bool MountV1(const std::string& pakPath, std::unordered_map<u32, PakEntryV1>& entries)
+{
+	BinaryFile file(pakPath, FileMode::Read);
+	PakHeaderV1 header;
+	int size = file.FileSize();
+	if (file.IsOpen() == false || size < (int)sizeof(PakHeaderV1) || file.ReadFrom((Byte*)&header, size - sizeof(PakHeaderV1), sizeof(PakHeaderV1)) == false)
+	{
+		return false;
+	}
+
+	file.SeekStart();
+	for (u32 i = 0; i < header.m_Entries; ++i)
+	{
+		PakEntryV1 entry;
+		if (file.Read((Byte*)&entry, sizeof(PakEntryV1)) == false)
+		{
+			return false;
+		}
+
+		entries.insert(std::make_pair(entry.m_HashID, entry));
+	}
+
+	return true;
+}
+
+// Writes the same made up directory in both layouts, the entries have no data since only
+// the directory is being measured. Paths look like a big game's, about 40 characters.
+static bool WriteMountArchives(const std::string& v2Path, const std::string& v1Path, u32 entryCount, std::vector<std::string>& paths)
+{
+	const char* folders[] = { "Textures", "Meshes", "Materials", "Shaders", "Audio", "Animations" };
+	const char* extensions[] = { ".dds", ".mesh", ".mat", ".shader", ".ogg", ".anim" };
+	std::unordered_set<u32> seen;
+	std::vector<PakEntry> entries;
+	std::vector<char> strings;
+	for (u32 i = 0; paths.size() < entryCount; ++i)
+	{
+		char path[128];
+		snprintf(path, sizeof(path), "Levels\\Level%03u\\%s\\Asset%06u%s", i % 200, folders[i % 6], i, extensions[i % 6]);
+		u32 hash = Hash32::ComputeHash((const Byte*)path, (u32)strlen(path));
+		if (seen.insert(hash).second == false)
+		{
+			continue;
+		}
+
+		PakEntry entry = {};
+		entry.m_HashID = hash;
+		entry.m_PathOffset = (u32)strings.size();
+		entries.push_back(entry);
+		strings.insert(strings.end(), path, path + strlen(path) + 1);
+		paths.push_back(path);
+	}
+
+	PakHeader header;
+	header.m_FolderPath = (u32)strings.size();
+	strings.insert(strings.end(), { 'C', 'o', 'n', 't', 'e', 'n', 't', '\0' });
+	header.m_PakName = header.m_FolderPath + 7;
+	header.m_Entries = (u32)entries.size();
+	header.m_StringOffset = 0;
+	header.m_StringSize = (u32)strings.size();
+	header.m_EntryOffset = (u32)(strings.size() + alignof(PakEntry) - 1) / alignof(PakEntry) * alignof(PakEntry);
+	std::sort(entries.begin(), entries.end(), [](const PakEntry& a, const PakEntry& b) { return a.m_HashID < b.m_HashID; });
+
+	BinaryFile v2(v2Path, FileMode::Write);
+	std::vector<Byte> padding(header.m_EntryOffset - strings.size(), 0);
+	FileSpan spans[] =
+	{
+		{ (const Byte*)strings.data(), (u32)strings.size() },
+		{ padding.data(), (u32)padding.size() },
+		{ (const Byte*)entries.data(), (u32)(entries.size() * sizeof(PakEntry)) },
+		{ (const Byte*)&header, sizeof(PakHeader) }
+	};
+	if (v2.IsOpen() == false || v2.WriteGather(spans, 4) == false || v2.Flush() == false)
+	{
+		return false;
+	}
+	v2.Close();
+
+	BinaryFile v1(v1Path, FileMode::Write);
+	if (v1.IsOpen() == false || v1.SetWriteBuffer(4 * 1024 * 1024) == false)
+	{
+		return false;
+	}
+
+	for (const std::string& path : paths)
+	{
+		PakEntryV1 entry = {};
+		memcpy(entry.m_FilePath, path.c_str(), std::min(path.length(), sizeof(entry.m_FilePath) - 1));
+		entry.m_HashID = Hash32::ComputeHash((const Byte*)path.c_str(), (u32)path.length());
+		if (v1.Write((const Byte*)&entry, sizeof(PakEntryV1)) == false)
+		{
+			return false;
+		}
+	}
+
+	PakHeaderV1 headerV1 = {};
+	memcpy(headerV1.m_ID, "PAK", 4);
+	headerV1.m_Version = 1;
+	memcpy(headerV1.m_FolderPath, "Content", 8);
+	memcpy(headerV1.m_PakName, "Content", 8);
+	headerV1.m_Entries = (u32)paths.size();
+	return v1.Write((const Byte*)&headerV1, sizeof(PakHeaderV1)) && v1.Flush();
+}
+
+// Mount cost of the v1 directory (a 256 byte path in every entry, copied one by one into an
+// unordered_map) against v2 used in place. Each mount runs in its own process so the memory
+// numbers are only that directory's. The files were just written so they're in the OS cache,
+// this is the cpu and memory side of mounting, a cold disk only makes v1 worse.
+static int RunMountBenchmark(const std::string& pakPath, u32 entryCount, const char* exePath)
+{
+	std::string v1Path = pakPath + ".v1";
+	std::vector<std::string> paths;
+	if (WriteMountArchives(pakPath, v1Path, entryCount, paths) == false)
+	{
+		printf("Failed to write %s\n", pakPath.c_str());
+		return 1;
+	}
+
+	BinaryFile v1(v1Path, FileMode::Read);
+	BinaryFile v2(pakPath, FileMode::Read);
+	printf("%zu entries, directory on disk: v1 %.1f MB (%zu bytes an entry), v2 %.1f MB\n", paths.size(),
+		v1.FileSize() / (1024.0 * 1024.0), sizeof(PakEntryV1), v2.FileSize() / (1024.0 * 1024.0));
+	v1.Close();
+	v2.Close();
+
+	printf("  %-22s %10s %14s %12s\n", "", "mount ms", "resident MB", "private MB");
+	const char* layouts[] = { "v1", "mapped", "stdio" };
+	for (const char* layout : layouts)
+	{
+		std::string command = "\"" + std::string(exePath) + "\" -mountload \"" + pakPath + "\" " + layout;
+		fflush(stdout);
+		if (std::system(command.c_str()) != 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// One -mountbench layout, best of a few mounts for time and the first one's memory, which
+// stays mounted while it's measured. Every entry's path has too hash back too its id.
+static int RunMountLoad(const std::string& pakPath, const std::string& layout)
+{
+	const u32 passes = 5;
+	double best = 1e30;
+	double resident = 0.0;
+	double privateMB = 0.0;
+	std::unique_ptr<PakArchive> kept;
+	std::unordered_map<u32, PakEntryV1> keptV1;
+	for (u32 pass = 0; pass < passes; ++pass)
+	{
+		double residentBefore, privateBefore;
+		CurrentMemoryMB(residentBefore, privateBefore);
+
+		u32 count = 0;
+		u32 found = 0;
+		Clock::time_point start = Clock::now();
+		if (layout == "v1")
+		{
+			std::unordered_map<u32, PakEntryV1> entries;
+			if (MountV1(pakPath + ".v1", entries) == false)
+			{
+				printf("Failed to mount %s.v1\n", pakPath.c_str());
+				return 1;
+			}
+			best = std::min(best, Seconds(start));
+
+			for (const std::pair<const u32, PakEntryV1>& entry : entries)
+			{
+				found += (entry.first == Hash32::ComputeHash((const Byte*)entry.second.m_FilePath, (u32)strlen(entry.second.m_FilePath))) ? 1 : 0;
+			}
+			count = (u32)entries.size();
+			if (pass == 0)
+			{
+				keptV1.swap(entries);
+			}
+		}
+		else
+		{
+			std::unique_ptr<PakArchive> archive = std::make_unique<PakArchive>(pakPath, layout == "mapped");
+			if (archive->Mount() == false)
+			{
+				printf("Failed to mount %s\n", pakPath.c_str());
+				return 1;
+			}
+			best = std::min(best, Seconds(start));
+
+			for (u32 i = 0; i < archive->FileCount(); ++i)
+			{
+				const char* path = archive->EntryPath(archive->Entries()[i]);
+				found += (archive->Entries()[i].m_HashID == Hash32::ComputeHash((const Byte*)path, (u32)strlen(path))) ? 1 : 0;
+			}
+			count = archive->FileCount();
+			if (pass == 0)
+			{
+				kept = std::move(archive);
+			}
+		}
+
+		if (pass == 0)
+		{
+			double residentAfter, privateAfter;
+			CurrentMemoryMB(residentAfter, privateAfter);
+			resident = residentAfter - residentBefore;
+			privateMB = privateAfter - privateBefore;
+		}
+
+		if (count == 0 || found != count)
+		{
+			printf("%s: only %u of %u paths hash back too their entry\n", layout.c_str(), found, count);
+			return 1;
+		}
+	}
+
+	// Mapping can fall back too stdio, say what actually ran
+	const char* name = (layout == "v1") ? "v1 copied into a map" : kept->IsMapped() ? "v2 in place, mapped" : "v2 in place, stdio";
+	printf("  %-22s %10.3f %14.2f %12.2f\n", name, best * 1000.0, resident, privateMB);
+	return 0;
+}
+
+// One loader thread reading every entry whole, only the chunk decode is spread over threads
+// so this shows how a single big texture/mesh load scales. Mapped so disk speed stays out of it.
+static int RunDecodeBenchmark(const std::string& pakPath, u32 maxThreads)
+{
+	PakArchive archive(pakPath);
+	if (archive.Mount() == false)
+	{
+		printf("Failed to mount %s\n", pakPath.c_str());
+		return 1;
+	}
+
+	std::vector<u32> ids;
+	archive.GetFileIDs(ids);
+
+	std::vector<u32> reference(ids.size());
+	std::vector<u8> buffer;
+	u64 totalBytes = 0;
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		if (ReadEntry(archive, ids[i], buffer, reference[i]) == false)
+		{
+			printf("Failed to read entry %08x\n", ids[i]);
+			return 1;
+		}
+		totalBytes += buffer.size();
+	}
+
+	printf("%s: %zu files, %.1f MB\n", pakPath.c_str(), ids.size(), totalBytes / (1024.0 * 1024.0));
+	for (u32 threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		archive.SetDecodeThreads(threadCount);
+
+		u32 failures = 0;
+		u32 passes = 0;
+		u32 crc = 0;
+		Clock::time_point start = Clock::now();
+		do
+		{
+			for (size_t i = 0; i < ids.size(); ++i)
+			{
+				if (ReadEntry(archive, ids[i], buffer, crc) == false || crc != reference[i])
+				{
+					++failures;
+				}
+			}
+			++passes;
+		} while (Seconds(start) < 0.5);
+		double time = Seconds(start);
+
+		printf("  %2u threads: %10.1f MB/s  %u mismatches\n", threadCount, (totalBytes * passes) / (1024.0 * 1024.0) / time, failures);
+		if (failures > 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Streams the biggest entry through one PakFile in small reads, peak memory should stay flat
+// however big the entry is. Run it first thing so nothing else has pushed the peak up, the
+// whole entry read at the end is there for comparison. Stdio so the mapping doesnt count.
+static int RunStreamBenchmark(const std::string& pakPath, u32 readSize)
+{
+	double baseline = PeakMemoryMB();
+
+	PakArchive archive(pakPath, false);
+	if (archive.Mount() == false || archive.FileCount() == 0)
+	{
+		printf("Failed to mount %s\n", pakPath.c_str());
+		return 1;
+	}
+
+	const PakEntry* largest = &archive.Entries()[0];
+	for (u32 i = 1; i < archive.FileCount(); ++i)
+	{
+		if (archive.Entries()[i].m_UncompressedSize > largest->m_UncompressedSize)
+		{
+			largest = &archive.Entries()[i];
+		}
+	}
+
+	printf("%s: %.1f MB, %s\n", archive.EntryPath(*largest), largest->m_UncompressedSize / (1024.0 * 1024.0), PakCompression::Name(largest->m_Codec));
+
+	std::vector<u8> buffer(readSize);
+	std::unique_ptr<PakFile> file = archive.GetPakFile(largest->m_HashID);
+	Clock::time_point start = Clock::now();
+	while (file->IsEndOfFile() == false)
+	{
+		u32 bytes = std::min(readSize, largest->m_UncompressedSize - (u32)file->FilePosition());
+		if (file->Read(buffer.data(), bytes) == false)
+		{
+			printf("Read failed at %d\n", file->FilePosition());
+			return 1;
+		}
+	}
+	double time = Seconds(start);
+	file.reset();
+
+	printf("  Streamed, %7u byte reads: %10.1f MB/s, peak +%.1f MB\n", readSize, largest->m_UncompressedSize / (1024.0 * 1024.0) / time, PeakMemoryMB() - baseline);
+
+	buffer.resize(largest->m_UncompressedSize);
+	file = archive.GetPakFile(largest->m_HashID);
+	start = Clock::now();
+	if (buffer.empty() == false && file->Read(buffer.data(), (u32)buffer.size()) == false)
+	{
+		printf("Whole read failed\n");
+		return 1;
+	}
+	time = Seconds(start);
+
+	printf("  Whole entry, one read:        %10.1f MB/s, peak +%.1f MB\n", largest->m_UncompressedSize / (1024.0 * 1024.0) / time, PeakMemoryMB() - baseline);
+	return 0;
+}
+
+// Writes the same dwords three ways, the old fwrite per value path, the same calls through a
+// write buffer, and the whole lot handed over as blocks in a single WriteGather.
+static int RunWriteBenchmark(const std::string& outputPath, u32 megabytes)
+{
+	const u32 blockSize = 4 * 1024 * 1024;
+	std::vector<Dword> block(blockSize / sizeof(Dword));
+	for (size_t i = 0; i < block.size(); ++i)
+	{
+		block[i] = (Dword)(i * 2654435761u);
+	}
+
+	u32 blocks = std::max(megabytes / 4, 1u);
+	double totalMB = blocks * (blockSize / (1024.0 * 1024.0));
+	printf("Writing %.0f MB too %s\n", totalMB, outputPath.c_str());
+
+	for (u32 pass = 0; pass < 3; ++pass)
+	{
+		Clock::time_point start = Clock::now();
+		BinaryFile file(outputPath, FileMode::Write);
+		if (file.IsOpen() == false)
+		{
+			printf("Failed to open %s\n", outputPath.c_str());
+			return 1;
+		}
+
+		bool result = true;
+		if (pass < 2)
+		{
+			if (pass == 1)
+			{
+				file.SetWriteBuffer(blockSize);
+			}
+
+			for (u32 b = 0; b < blocks && result; ++b)
+			{
+				for (size_t i = 0; i < block.size() && result; ++i)
+				{
+					result = file.WriteDword(block[i]);
+				}
+			}
+		}
+		else
+		{
+			std::vector<FileSpan> spans(blocks, { (const Byte*)block.data(), blockSize });
+			result = file.WriteGather(spans.data(), blocks);
+		}
+
+		result = result && file.Flush();
+		file.Close();
+		double time = Seconds(start);
+		if (result == false)
+		{
+			printf("Write failed\n");
+			return 1;
+		}
+
+		const char* names[] = { "WriteDword, unbuffered", "WriteDword, 4MB buffer", "WriteGather" };
+		printf("  %-24s %8.2fs %10.1f MB/s\n", names[pass], time, totalMB / time);
+	}
+
+	return 0;
+}
+
+// Same size and layout as VertexMesh, without dragging the math library into the tool
+struct BenchVertex
+{
+	float m_Position[3];
+	float m_Normal[3];
+	float m_Tangent[4];
+	float m_Color[4];
+	float m_Texture[2];
+};
+
+// Per field is how the old .mesh loader worked, a ReadDword for every float
+static int RunSerializeBenchmark(const std::string& outputPath, u32 vertexCount)
+{
+	const u32 fields = sizeof(BenchVertex) / sizeof(float);
+	std::vector<BenchVertex> vertices(vertexCount);
+	std::vector<u32> indices((size_t)vertexCount * 3);
+	for (u32 i = 0; i < vertexCount; ++i)
+	{
+		float* values = (float*)&vertices[i];
+		for (u32 f = 0; f < fields; ++f)
+		{
+			values[f] = (float)(i * fields + f);
+		}
+	}
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		indices[i] = (u32)((i * 7) % vertexCount);
+	}
+
+	double totalMB = (vertices.size() * sizeof(BenchVertex) + indices.size() * sizeof(u32)) / (1024.0 * 1024.0);
+	printf("%u vertices, %.1f MB\n", vertexCount, totalMB);
+
+	for (u32 pass = 0; pass < 2; ++pass)
+	{
+		std::vector<BenchVertex> loadedVertices;
+		std::vector<u32> loadedIndices;
+		bool result = true;
+
+		Clock::time_point start = Clock::now();
+		{
+			BinaryFile file(outputPath, FileMode::Write);
+			if (pass == 0)
+			{
+				result = file.WriteDword(vertexCount) && file.WriteDword((u32)indices.size());
+				for (u32 i = 0; i < vertexCount && result; ++i)
+				{
+					const Dword* values = (const Dword*)&vertices[i];
+					for (u32 f = 0; f < fields && result; ++f)
+					{
+						result = file.WriteDword(values[f]);
+					}
+				}
+				for (size_t i = 0; i < indices.size() && result; ++i)
+				{
+					result = file.WriteDword(indices[i]);
+				}
+			}
+			else
+			{
+				BinaryFileArchive archive(file);
+				result = Serialize(archive, vertices) && Serialize(archive, indices);
+			}
+			result = result && file.Flush();
+			file.Close();
+		}
+		double saveTime = Seconds(start);
+
+		start = Clock::now();
+		{
+			BinaryFile file(outputPath, FileMode::Read);
+			if (pass == 0)
+			{
+				loadedVertices.resize(file.ReadDword());
+				loadedIndices.resize(file.ReadDword());
+				for (size_t i = 0; i < loadedVertices.size(); ++i)
+				{
+					Dword* values = (Dword*)&loadedVertices[i];
+					for (u32 f = 0; f < fields; ++f)
+					{
+						values[f] = file.ReadDword();
+					}
+				}
+				for (size_t i = 0; i < loadedIndices.size(); ++i)
+				{
+					loadedIndices[i] = file.ReadDword();
+				}
+			}
+			else
+			{
+				BinaryFileArchive archive(file);
+				result = result && Serialize(archive, loadedVertices) && Serialize(archive, loadedIndices);
+			}
+			file.Close();
+		}
+		double loadTime = Seconds(start);
+
+		bool same = loadedIndices == indices && loadedVertices.size() == vertices.size() &&
+			(vertices.empty() || memcmp(loadedVertices.data(), vertices.data(), vertices.size() * sizeof(BenchVertex)) == 0);
+		if (result == false || same == false)
+		{
+			printf("Round trip failed\n");
+			return 1;
+		}
+
+		printf("  %-10s save %8.3fs %9.1f MB/s, load %8.3fs %9.1f MB/s\n", pass == 0 ? "Per field" : "Serialize",
+			saveTime, totalMB / saveTime, loadTime, totalMB / loadTime);
+	}
+
+	return 0;
+}
+
+// Each kernel flips the same buffer a few times, an even number so it ends where it started
+// and the result is checked against the scalar swap.
+static int RunSwapBenchmark(u32 megabytes)
+{
+	std::vector<Byte> buffer((size_t)std::max(megabytes, 1u) * 1024 * 1024);
+	for (size_t i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = (Byte)(i * 31);
+	}
+
+	const u32 passes = 8;
+	double totalGB = passes * buffer.size() / (1024.0 * 1024.0 * 1024.0);
+	printf("Best kernel: %s\n", SwapKernelName(BestSwapKernel()));
+
+	std::vector<Byte> reference = buffer;
+	std::vector<Byte> swapped;
+	for (u32 wordSize = 2; wordSize <= 8; wordSize *= 2)
+	{
+		u64 count = buffer.size() / wordSize;
+		swapped = reference;
+		SwapEndian(swapped.data(), count, wordSize, SwapKernel::Scalar);
+
+		for (u32 k = (u32)SwapKernel::Scalar; k <= (u32)BestSwapKernel(); ++k)
+		{
+			SwapKernel kernel = (SwapKernel)k;
+			SwapEndian(buffer.data(), count, wordSize, kernel);
+			bool same = memcmp(buffer.data(), swapped.data(), buffer.size()) == 0;
+			SwapEndian(buffer.data(), count, wordSize, kernel);
+
+			Clock::time_point start = Clock::now();
+			for (u32 p = 0; p < passes; ++p)
+			{
+				SwapEndian(buffer.data(), count, wordSize, kernel);
+			}
+			double time = Seconds(start);
+
+			if (same == false || memcmp(buffer.data(), reference.data(), buffer.size()) != 0)
+			{
+				printf("%s swap of %u byte words is wrong\n", SwapKernelName(kernel), wordSize);
+				return 1;
+			}
+			printf("  %2u bit %-7s %8.2f GB/s\n", wordSize * 8, SwapKernelName(kernel), totalGB / time);
+		}
+	}
+
+	return 0;
+}
+
+// Reads every byte like the upload copy would, so mapped pages are really touched
+static u64 TouchBytes(const Byte* data, u64 size)
+{
+	u64 sum = 0;
+	u64 i = 0;
+	for (; i + sizeof(u64) <= size; i += sizeof(u64))
+	{
+		u64 word;
+		memcpy(&word, data + i, sizeof(u64));
+		sum += word;
+	}
+	for (; i < size; ++i)
+	{
+		sum += data[i];
+	}
+	return sum;
+}
+
+static int RunMeshLoad(const std::string& path)
+{
+	u64 vertexCount = 0;
+	u64 indexCount = 0;
+	u64 checksum = 0;
+	const char* how = "";
+
+	Clock::time_point start = Clock::now();
+	if (path.substr(path.find_last_of('.') + 1) == "obj")
+	{
+		// What Mesh::LoadFromObj does before PackMesh
+		CookedMesh mesh;
+		if (MeshCooker::ImportObj(path, mesh) == false)
+		{
+			printf("Failed to import %s\n", path.c_str());
+			return 1;
+		}
+		vertexCount = mesh.m_Vertices.size();
+		indexCount = mesh.m_Indices.size();
+		checksum = TouchBytes((const Byte*)mesh.m_Vertices.data(), vertexCount * sizeof(VertexMesh)) +
+			TouchBytes((const Byte*)mesh.m_Indices.data(), indexCount * sizeof(u32));
+		how = "obj";
+	}
+	else
+	{
+		MappedFile mapping;
+		MeshView view;
+		if (mapping.Open(path) && view.Open(mapping.Data(), mapping.Size()))
+		{
+			vertexCount = view.m_VertexCount;
+			indexCount = view.m_IndexCount;
+			checksum = TouchBytes(view.m_Vertices, vertexCount * sizeof(VertexMesh)) + TouchBytes(view.m_Indices, indexCount * sizeof(u32));
+			how = "mapped";
+		}
+		else
+		{
+			// Same fallback as Mesh::LoadFromBinary when the file cant be mapped
+			CookedMesh mesh;
+			BinaryFile file(path, FileMode::Read);
+			BinaryFileArchive archive(file);
+			if (Serialize(archive, mesh) == false)
+			{
+				printf("Failed to load %s\n", path.c_str());
+				return 1;
+			}
+			vertexCount = mesh.m_Vertices.size();
+			indexCount = mesh.m_Indices.size();
+			checksum = TouchBytes((const Byte*)mesh.m_Vertices.data(), vertexCount * sizeof(VertexMesh)) +
+				TouchBytes((const Byte*)mesh.m_Indices.data(), indexCount * sizeof(u32));
+			how = "read";
+		}
+	}
+	double seconds = Seconds(start);
+
+	printf("  %-7s %9.2f ms  peak %7.1f MB  %llu vertices  %llu indices  (sum %016llx)\n", how, seconds * 1000.0, PeakMemoryMB(),
+		(unsigned long long)vertexCount, (unsigned long long)indexCount, (unsigned long long)checksum);
+	return 0;
+}
+
+// Grid with positions, uvs and normals all indexed alike, like an exported obj. Quads
+// leaves the faces for the reader too triangulate.
+static bool WriteGridObj(const std::string& objPath, u32 quads, bool quadFaces)
+{
+	u32 side = quads + 1;
+	BinaryFile file(objPath, FileMode::Write);
+	if (file.IsOpen() == false)
+	{
+		printf("Failed to open %s\n", objPath.c_str());
+		return false;
+	}
+	file.SetWriteBuffer(4 * 1024 * 1024);
+
+	char line[256];
+	for (u32 y = 0; y < side; ++y)
+	{
+		for (u32 x = 0; x < side; ++x)
+		{
+			float u = (float)x / quads;
+			float v = (float)y / quads;
+			int length = snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\nvn 0 1 0\n", u * 10.0f, std::sin(u * 20.0f) * std::cos(v * 20.0f), v * 10.0f, u, v);
+			file.Write((const Byte*)line, (u32)length);
+		}
+	}
+
+	for (u32 y = 0; y < quads; ++y)
+	{
+		for (u32 x = 0; x < quads; ++x)
+		{
+			u32 a = y * side + x + 1;
+			u32 b = a + 1;
+			u32 c = a + side;
+			u32 d = c + 1;
+			int length = quadFaces ?
+				snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, d, d, d, b, b, b) :
+				snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\nf %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, b, b, b, b, b, b, c, c, c, d, d, d);
+			file.Write((const Byte*)line, (u32)length);
+		}
+	}
+	file.Close();
+	return true;
+}
+
+static int RunMeshBenchmark(const std::string& objPath, u32 triangleCount, const char* exePath)
+{
+	std::string meshPath = objPath.substr(0, objPath.find_last_of('.')) + ".mesh";
+	u32 quads = (u32)std::sqrt(triangleCount / 2.0);
+	u32 side = quads + 1;
+	if (quads == 0)
+	{
+		printf("Need at least 2 triangles\n");
+		return 1;
+	}
+
+	Clock::time_point start = Clock::now();
+	if (WriteGridObj(objPath, quads, false) == false)
+	{
+		return 1;
+	}
+	printf("%u triangles, %u vertices, wrote obj in %.2f s\n", quads * quads * 2, side * side, Seconds(start));
+
+	// Cook, then check the view hands back exactly what was cooked
+	CookedMesh mesh;
+	start = Clock::now();
+	if (MeshCooker::ImportObj(objPath, mesh) == false || MeshCooker::Save(meshPath, mesh) == false)
+	{
+		printf("Failed to cook %s\n", objPath.c_str());
+		return 1;
+	}
+	printf("Cooked %s in %.2f s\n", meshPath.c_str(), Seconds(start));
+
+	std::vector<u8> cooked;
+	{
+		BinaryFile file(meshPath, FileMode::Read);
+		cooked.resize((size_t)file.FileSize());
+		file.Read(cooked.data(), (u32)cooked.size());
+	}
+
+	MeshView view;
+	if (view.Open(cooked.data(), cooked.size()) == false || view.m_VertexCount != mesh.m_Vertices.size() || view.m_IndexCount != mesh.m_Indices.size() ||
+		memcmp(view.m_Vertices, mesh.m_Vertices.data(), mesh.m_Vertices.size() * sizeof(VertexMesh)) != 0 ||
+		memcmp(view.m_Indices, mesh.m_Indices.data(), mesh.m_Indices.size() * sizeof(u32)) != 0)
+	{
+		printf("Cooked mesh doesnt match the import\n");
+		return 1;
+	}
+	mesh = CookedMesh();
+	cooked = std::vector<u8>();
+
+	// A process each, peak memory cant be reset
+	const std::string paths[2] = { objPath, meshPath };
+	for (const std::string& path : paths)
+	{
+		std::string command = "\"" + std::string(exePath) + "\" -meshload \"" + path + "\"";
+		fflush(stdout);
+		if (std::system(command.c_str()) != 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static bool SameObj(const ObjData& a, const ObjData& b)
+{
+	if (a.m_Positions != b.m_Positions || a.m_TexCoords != b.m_TexCoords || a.m_Normals != b.m_Normals || a.m_Colors != b.m_Colors ||
+		a.m_Indices.size() != b.m_Indices.size() || a.m_Shapes.size() != b.m_Shapes.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < a.m_Indices.size(); ++i)
+	{
+		const ObjIndex& x = a.m_Indices[i];
+		const ObjIndex& y = b.m_Indices[i];
+		if (x.m_Vertex != y.m_Vertex || x.m_TexCoord != y.m_TexCoord || x.m_Normal != y.m_Normal)
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < a.m_Shapes.size(); ++i)
+	{
+		if (a.m_Shapes[i].m_Start != b.m_Shapes[i].m_Start || a.m_Shapes[i].m_Count != b.m_Shapes[i].m_Count)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static int RunObjBenchmark(const std::string& objPath, u32 triangleCount, u32 maxThreads)
+{
+	// 0 triangles benchmarks an obj thats already there
+	if (triangleCount > 0)
+	{
+		u32 quads = (u32)std::sqrt(triangleCount / 2.0);
+		if (quads == 0 || WriteGridObj(objPath, quads, true) == false)
+		{
+			printf("Failed to write %s\n", objPath.c_str());
+			return 1;
+		}
+	}
+
+	ObjData reference;
+	Clock::time_point start = Clock::now();
+	if (ObjParser::LoadTinyObj(objPath, reference) == false)
+	{
+		printf("Failed to load %s\n", objPath.c_str());
+		return 1;
+	}
+	double tinyTime = Seconds(start);
+	printf("%zu vertices, %zu triangles, %zu shapes\n", reference.m_Positions.size() / 3, reference.m_Indices.size() / 3, reference.m_Shapes.size());
+	printf("tinyobj      %8.1f ms\n", tinyTime * 1000.0);
+
+	{
+		TextReader reader(objPath);
+		ObjData obj;
+		if (ObjParser::Parse(reader.Text().data(), reader.Text().size(), obj, 1) != ObjResult::Ok)
+		{
+			printf("Obj uses something only tinyobj reads, Load would fall back\n");
+			return 0;
+		}
+	}
+
+	for (u32 threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		ObjData obj;
+		start = Clock::now();
+		if (ObjParser::Load(objPath, obj, threads) == false)
+		{
+			printf("Failed to parse %s\n", objPath.c_str());
+			return 1;
+		}
+		double time = Seconds(start);
+
+		if (SameObj(reference, obj) == false)
+		{
+			printf("%u threads doesnt match tinyobj\n", threads);
+			return 1;
+		}
+		printf("%2u threads   %8.1f ms  %5.2fx\n", threads, time * 1000.0, tinyTime / time);
+	}
+
+	// The whole cook import, weld and tangents included
+	reference = ObjData();
+	CookedMesh mesh;
+	start = Clock::now();
+	if (MeshCooker::ImportObj(objPath, mesh) == false)
+	{
+		printf("Failed to import %s\n", objPath.c_str());
+		return 1;
+	}
+	printf("ImportObj    %8.1f ms, %zu vertices after welding\n", Seconds(start) * 1000.0, mesh.m_Vertices.size());
+	return 0;
+}
+
+// Corners of a grid mesh in face order, each vertex shows up about six times like an import
+static std::vector<VertexMesh> MakeGridCorners(u32 quads)
+{
+	u32 side = quads + 1;
+	std::vector<VertexMesh> grid(side * side);
+	for (u32 y = 0; y < side; ++y)
+	{
+		for (u32 x = 0; x < side; ++x)
+		{
+			float u = (float)x / quads;
+			float v = (float)y / quads;
+			VertexMesh& vertex = grid[y * side + x];
+			vertex.m_Position = Vector3(u * 10.0f, std::sin(u * 20.0f) * std::cos(v * 20.0f), v * 10.0f);
+			vertex.m_Normal = Vector3(0, 1, 0);
+			vertex.m_Texture = Vector2(u, 1.0f - v);
+			vertex.m_Color = Color(1, 1, 1);
+		}
+	}
+
+	std::vector<VertexMesh> corners;
+	corners.reserve((size_t)quads * quads * 6);
+	for (u32 y = 0; y < quads; ++y)
+	{
+		for (u32 x = 0; x < quads; ++x)
+		{
+			u32 a = y * side + x;
+			u32 b = a + 1;
+			u32 c = a + side;
+			u32 d = c + 1;
+			for (u32 index : { a, c, b, b, c, d })
+			{
+				corners.push_back(grid[index]);
+			}
+		}
+	}
+	return corners;
+}
+
+// Corners whose welded vertex isnt byte for byte the one that went in
+static u64 CountWrongWelds(const std::vector<VertexMesh>& corners, const VertexMesh* welded, const std::vector<u32>& indices)
+{
+	u64 wrong = 0;
+	for (size_t i = 0; i < corners.size(); ++i)
+	{
+		if (memcmp(&welded[indices[i]], &corners[i], sizeof(VertexMesh)) != 0)
+		{
+			++wrong;
+		}
+	}
+	return wrong;
+}
+
+static int RunWeldBenchmark(u32 triangleCount)
+{
+	u32 quads = (u32)std::sqrt(triangleCount / 2.0);
+	if (quads == 0)
+	{
+		printf("Need at least 2 triangles\n");
+		return 1;
+	}
+
+	std::vector<VertexMesh> corners = MakeGridCorners(quads);
+	u32 expected = (quads + 1) * (quads + 1);
+	printf("%zu corners, %u unique vertices\n", corners.size(), expected);
+
+	// The weld ImportObj used before, a crc of the vertex into a node map and no compare
+	std::vector<VertexMesh> oldVertices;
+	std::vector<u32> oldIndices;
+	Clock::time_point start = Clock::now();
+	{
+		std::unordered_map<u64, u64> indexMap = {};
+		for (const VertexMesh& vertex : corners)
+		{
+			u32 hash = Hash32::ComputeHash((Byte*)&vertex, (u64)VertexFormat::VertexMesh);
+			std::unordered_map<u64, u64>::iterator itr = indexMap.find(hash);
+			u64 index = oldVertices.size();
+			if (itr == indexMap.end())
+			{
+				oldVertices.push_back(vertex);
+				indexMap[hash] = index;
+			}
+			else
+			{
+				index = itr->second;
+			}
+			oldIndices.push_back((u32)index);
+		}
+	}
+	double oldTime = Seconds(start);
+	u64 oldWrong = CountWrongWelds(corners, oldVertices.data(), oldIndices);
+	printf("%-18s %8.1f ms  %6.1f M corners/s  %zu vertices, %llu corners welded too the wrong vertex\n",
+		"crc32 map", oldTime * 1000.0, corners.size() / oldTime / 1e6, oldVertices.size(), (unsigned long long)oldWrong);
+
+	const char* names[2] = { "welder", "welder (0 reserve)" };
+	for (u32 pass = 0; pass < 2; ++pass)
+	{
+		std::vector<u32> indices;
+		indices.reserve(corners.size());
+		start = Clock::now();
+		VertexWelder welder(sizeof(VertexMesh), pass == 0 ? expected : 0);
+		for (const VertexMesh& vertex : corners)
+		{
+			indices.push_back(welder.Add(&vertex));
+		}
+		double time = Seconds(start);
+
+		u64 wrong = CountWrongWelds(corners, (const VertexMesh*)welder.Vertices(), indices);
+		printf("%-18s %8.1f ms  %6.1f M corners/s  %u vertices, %.2fx\n", names[pass], time * 1000.0, corners.size() / time / 1e6, welder.Count(), oldTime / time);
+		if (wrong != 0 || welder.Count() != expected)
+		{
+			printf("Welder merged vertices that differ, or kept duplicates\n");
+			return 1;
+		}
+	}
+
+	// Every crc collision the old weld hit, fed straight in as pairs that must stay apart
+	VertexWelder collisions(sizeof(VertexMesh));
+	for (size_t i = 0; i < corners.size(); ++i)
+	{
+		const VertexMesh& kept = oldVertices[oldIndices[i]];
+		if (memcmp(&kept, &corners[i], sizeof(VertexMesh)) != 0 && (collisions.Add(&kept) == collisions.Add(&corners[i])))
+		{
+			printf("Welder merged a crc collision\n");
+			return 1;
+		}
+	}
+	printf("%u vertices from crc collisions kept apart\n", collisions.Count());
+
+	// Noise well under the epsilon, every copy has too land back on its vertex
+	VertexWelder snapped(sizeof(VertexMesh), expected, 1.0f / 4096.0f);
+	start = Clock::now();
+	for (size_t i = 0; i < corners.size(); ++i)
+	{
+		VertexMesh vertex = corners[i];
+		vertex.m_Position.y += (float)((i * 7) % 5) * 1e-6f;
+		snapped.Add(&vertex);
+	}
+	double time = Seconds(start);
+	printf("%-18s %8.1f ms  %6.1f M corners/s  %u vertices (rounding edges split a few)\n", "welder (epsilon)", time * 1000.0, corners.size() / time / 1e6, snapped.Count());
+	return 0;
+}
+
+struct Triangle
+{
+	u32 m_Index[3];
+	bool operator<(const Triangle& other)const { return std::lexicographical_compare(m_Index, m_Index + 3, other.m_Index, other.m_Index + 3); }
+	bool operator!=(const Triangle& other)const { return memcmp(m_Index, other.m_Index, sizeof(m_Index)) != 0; }
+};
+
+// Same triangles with the same winding, only the order may differ
+static bool SameTriangles(const std::vector<u32>& a, const std::vector<u32>& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+
+	std::vector<Triangle> x(a.size() / 3);
+	std::vector<Triangle> y(b.size() / 3);
+	memcpy(x.data(), a.data(), x.size() * sizeof(Triangle));
+	memcpy(y.data(), b.data(), y.size() * sizeof(Triangle));
+	std::sort(x.begin(), x.end());
+	std::sort(y.begin(), y.end());
+	for (size_t i = 0; i < x.size(); ++i)
+	{
+		if (x[i] != y[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void PrintCacheStats(const char* name, const std::vector<u32>& indices, u32 vertexCount)
+{
+	VertexCacheStats fifo = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, 16, CacheModel::Fifo);
+	VertexCacheStats lru = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, 16, CacheModel::Lru);
+	printf("  %-10s FIFO16 ACMR %.3f ATVR %.3f   LRU16 ACMR %.3f ATVR %.3f\n", name, fifo.m_Acmr, fifo.m_Atvr, lru.m_Acmr, lru.m_Atvr);
+}
+
+static int RunCacheBenchmark(u32 triangleCount)
+{
+	u32 quads = (u32)std::sqrt(triangleCount / 2.0);
+	if (quads == 0)
+	{
+		printf("Need at least 2 triangles\n");
+		return 1;
+	}
+
+	std::vector<VertexMesh> corners = MakeGridCorners(quads);
+	VertexWelder welder(sizeof(VertexMesh), corners.size());
+	std::vector<u32> rows;
+	rows.reserve(corners.size());
+	for (const VertexMesh& vertex : corners)
+	{
+		rows.push_back(welder.Add(&vertex));
+	}
+	u32 vertexCount = welder.Count();
+
+	// Rows is a friendly order already, a shuffle is what a messy exporter looks like
+	std::vector<Triangle> triangles(rows.size() / 3);
+	memcpy(triangles.data(), rows.data(), rows.size() * sizeof(u32));
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+	std::vector<u32> shuffled(rows.size());
+	memcpy(shuffled.data(), triangles.data(), shuffled.size() * sizeof(u32));
+	triangles = std::vector<Triangle>();
+
+	printf("%zu triangles, %u vertices\n", rows.size() / 3, vertexCount);
+	const char* names[2] = { "rows", "shuffled" };
+	std::vector<u32>* inputs[2] = { &rows, &shuffled };
+	for (u32 i = 0; i < 2; ++i)
+	{
+		std::vector<u32> optimized(inputs[i]->size());
+		Clock::time_point start = Clock::now();
+		MeshOptimizer::OptimizeVertexCache(optimized.data(), inputs[i]->data(), inputs[i]->size(), vertexCount);
+		double time = Seconds(start);
+
+		printf("%s, optimized in %.1f ms (%.1f M triangles/s)\n", names[i], time * 1000.0, optimized.size() / 3 / time / 1e6);
+		PrintCacheStats("before", *inputs[i], vertexCount);
+		PrintCacheStats("after", optimized, vertexCount);
+
+		if (SameTriangles(*inputs[i], optimized) == false)
+		{
+			printf("Optimized indices arent the same triangles\n");
+			return 1;
+		}
+
+		VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(inputs[i]->data(), inputs[i]->size(), vertexCount);
+		VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+		if (after.m_Acmr > before.m_Acmr)
+		{
+			printf("Optimizing made the FIFO cache worse\n");
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Sphere with bumps big enough too hide each other, the kind of prop overdraw ordering is for
+static void MakeBumpySphere(u32 triangleCount, std::vector<Vector3>& positions, std::vector<u32>& indices)
+{
+	u32 rings = std::max((u32)std::sqrt(triangleCount / 2.0), 3u);
+	u32 segments = rings;
+	const float pi = 3.14159265f;
+
+	positions.clear();
+	indices.clear();
+	for (u32 r = 0; r <= rings; ++r)
+	{
+		for (u32 s = 0; s < segments; ++s)
+		{
+			float theta = pi * r / rings;
+			float phi = 2.0f * pi * s / segments;
+			float radius = 1.0f + 0.4f * std::sin(theta * 7.0f) * std::sin(phi * 7.0f);
+			positions.push_back(Vector3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)) * radius);
+		}
+	}
+
+	for (u32 r = 0; r < rings; ++r)
+	{
+		for (u32 s = 0; s < segments; ++s)
+		{
+			u32 a = r * segments + s;
+			u32 b = r * segments + (s + 1) % segments;
+			u32 c = a + segments;
+			u32 d = b + segments;
+			indices.insert(indices.end(), { a, c, b, b, c, d });
+		}
+	}
+}
+
+static void PrintMeshStats(const char* name, const std::vector<u32>& indices, std::vector<Vector3>& positions)
+{
+	u32 vertexCount = (u32)positions.size();
+	VertexCacheStats cache = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+	OverdrawStats overdraw = MeshOptimizer::AnalyzeOverdraw(indices.data(), indices.size(), positions.data(), vertexCount);
+	// A VertexMesh is exactly one line so its order cant matter, Mesh's position stream is 12 bytes
+	VertexFetchStats fetch = MeshOptimizer::AnalyzeVertexFetch(indices.data(), indices.size(), vertexCount, sizeof(Vector3));
+	printf("  %-22s ACMR %.3f  overdraw %.3f  position overfetch %.3f\n", name, cache.m_Acmr, overdraw.m_Overdraw, fetch.m_Overfetch);
+}
+
+static int RunOverdrawBenchmark(u32 triangleCount, float threshold)
+{
+	std::vector<Vector3> positions;
+	std::vector<u32> rings;
+	MakeBumpySphere(triangleCount, positions, rings);
+	u32 vertexCount = (u32)positions.size();
+	printf("%zu triangles, %u vertices, threshold %.2f\n", rings.size() / 3, vertexCount, threshold);
+
+	std::vector<Triangle> triangles(rings.size() / 3);
+	memcpy(triangles.data(), rings.data(), rings.size() * sizeof(u32));
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+	std::vector<u32> shuffled(rings.size());
+	memcpy(shuffled.data(), triangles.data(), shuffled.size() * sizeof(u32));
+	triangles = std::vector<Triangle>();
+
+	PrintMeshStats("rings", rings, positions);
+	PrintMeshStats("shuffled", shuffled, positions);
+
+	std::vector<u32> cached(shuffled.size());
+	MeshOptimizer::OptimizeVertexCache(cached.data(), shuffled.data(), shuffled.size(), vertexCount);
+	PrintMeshStats("+ vertex cache", cached, positions);
+
+	std::vector<u32> overdrawn(cached.size());
+	Clock::time_point start = Clock::now();
+	MeshOptimizer::OptimizeOverdraw(overdrawn.data(), cached.data(), cached.size(), positions.data(), vertexCount, threshold);
+	double overdrawTime = Seconds(start);
+	PrintMeshStats("+ overdraw", overdrawn, positions);
+
+	if (SameTriangles(cached, overdrawn) == false)
+	{
+		printf("Overdraw pass changed the triangles\n");
+		return 1;
+	}
+
+	VertexCacheStats cachedStats = MeshOptimizer::AnalyzeVertexCache(cached.data(), cached.size(), vertexCount);
+	VertexCacheStats overdrawnStats = MeshOptimizer::AnalyzeVertexCache(overdrawn.data(), overdrawn.size(), vertexCount);
+	if (overdrawnStats.m_Acmr > cachedStats.m_Acmr * threshold * 1.01f)
+	{
+		printf("Overdraw pass lost more ACMR than the threshold allows\n");
+		return 1;
+	}
+
+	// Fetch order last, every corner has too still land on the same position
+	std::vector<u32> remap(vertexCount);
+	start = Clock::now();
+	u32 used = MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), overdrawn.data(), overdrawn.size(), vertexCount);
+	std::vector<u32> fetched = overdrawn;
+	MeshOptimizer::RemapIndices(fetched.data(), fetched.size(), remap.data());
+	std::vector<Vector3> remapped = positions;
+	MeshOptimizer::RemapVertices(remapped, remap.data());
+	double fetchTime = Seconds(start);
+	PrintMeshStats("+ vertex fetch", fetched, remapped);
+
+	for (size_t i = 0; i < fetched.size(); ++i)
+	{
+		if (memcmp(&remapped[fetched[i]], &positions[overdrawn[i]], sizeof(Vector3)) != 0)
+		{
+			printf("Vertex fetch remap moved a corner\n");
+			return 1;
+		}
+	}
+
+	printf("Overdraw pass %.1f ms, fetch remap %.1f ms, %u of %u vertices used\n", overdrawTime * 1000.0, fetchTime * 1000.0, used, vertexCount);
+	return 0;
+}
+
+// The ConfigFile::Open loop before TextReader, fgets + a substr per key and value
+static void ParseConfigOld(const std::string& path, Section& sections)
+{
+	TextFile file;
+	if (file.Open(path, FileMode::Read) == false)
+	{
+		return;
+	}
+
+	std::string line;
+	Settings* current = nullptr;
+	while (!file.IsEndOfFile())
+	{
+		file.ReadLine(line, true);
+		if (line.length() > 0 && line.at(0) != '#')
+		{
+			if (line.at(0) == '[' && line.at(line.length() - 1) == ']')
+			{
+				current = &sections[line.substr(1, line.length() - 2)];
+			}
+			else
+			{
+				int seperator = (int)line.find_first_of('=', (size_t)0);
+				if (seperator > 0 && current != nullptr)
+				{
+					std::string key = line.substr(0, seperator);
+					std::string value = line.substr((size_t)seperator + 1);
+					current->insert(std::make_pair(key, value));
+				}
+			}
+		}
+	}
+	file.Close();
+}
+
+static int RunConfigBenchmark(const std::string& outputPath, u32 lineCount)
+{
+	{
+		TextFile file(outputPath, FileMode::Write);
+		if (file.IsOpen() == false)
+		{
+			printf("Failed to open %s\n", outputPath.c_str());
+			return 1;
+		}
+
+		char line[128];
+		for (u32 i = 0; i < lineCount; ++i)
+		{
+			int length = (i % 50 == 0) ? snprintf(line, sizeof(line), "[Section%u]\n", i / 50) :
+				((i % 10 == 5) ? snprintf(line, sizeof(line), "# Comment %u\n", i) : snprintf(line, sizeof(line), "Setting%u=Some value %u  \n", i, i * 7));
+			file.Write(line, (u32)length);
+		}
+		file.Close();
+	}
+
+	const u32 passes = 5;
+	printf("%u lines, best of %u\n", lineCount, passes);
+
+	double lineOld = 1e9, lineNew = 1e9, parseOld = 1e9, parseNew = 1e9;
+	size_t lines = 0, linesNew = 0, keys = 0, keysNew = 0;
+	for (u32 p = 0; p < passes; ++p)
+	{
+		Clock::time_point start = Clock::now();
+		{
+			TextFile file(outputPath, FileMode::Read);
+			std::string line;
+			lines = 0;
+			while (file.ReadLine(line, true))
+			{
+				++lines;
+			}
+			file.Close();
+		}
+		lineOld = std::min(lineOld, Seconds(start));
+
+		start = Clock::now();
+		{
+			TextReader reader(outputPath);
+			std::string_view line;
+			linesNew = 0;
+			while (reader.ReadLine(line))
+			{
+				++linesNew;
+			}
+		}
+		lineNew = std::min(lineNew, Seconds(start));
+
+		start = Clock::now();
+		{
+			Section sections;
+			ParseConfigOld(outputPath, sections);
+			keys = 0;
+			for (const auto& section : sections)
+			{
+				keys += section.second.size();
+			}
+		}
+		parseOld = std::min(parseOld, Seconds(start));
+
+		start = Clock::now();
+		{
+			ConfigFile config;
+			config.Open(outputPath);
+			keysNew = 0;
+			for (const auto& section : config.m_Settings)
+			{
+				keysNew += section.second.size();
+			}
+			config.Clear(); // Close would write it back out
+		}
+		parseNew = std::min(parseNew, Seconds(start));
+	}
+
+	if (lines != linesNew || keys != keysNew)
+	{
+		printf("Mismatch, %zu/%zu lines and %zu/%zu keys\n", lines, linesNew, keys, keysNew);
+		return 1;
+	}
+
+	printf("  Lines   TextFile::ReadLine %8.2f ms, TextReader %8.2f ms\n", lineOld * 1000.0, lineNew * 1000.0);
+	printf("  Config  old parse          %8.2f ms, ConfigFile %8.2f ms (%zu keys)\n", parseOld * 1000.0, parseNew * 1000.0, keysNew);
+	return 0;
+}
+
+// Reads every traced file in order through stdio, a seek is any read that doesnt start where
+// the last one ended. Time is only meaningful with a cold cache (fresh boot or another drive).
+static bool ReplayTrace(const std::string& pakPath, const std::vector<std::string>& trace)
+{
+	PakArchive archive(pakPath, false);
+	if (archive.Mount() == false)
+	{
+		printf("Failed to mount %s\n", pakPath.c_str());
+		return false;
+	}
+
+	std::vector<u8> buffer;
+	u64 totalBytes = 0;
+	u64 seekDistance = 0;
+	u32 seeks = 0;
+	u32 files = 0;
+	u32 lastEnd = 0;
+
+	Clock::time_point start = Clock::now();
+	for (const std::string& path : trace)
+	{
+		const PakEntry* entry = archive.FindEntry(Hash32::ComputeHash((const Byte*)path.c_str(), (u32)path.length()));
+		if (entry == nullptr)
+		{
+			continue;
+		}
+
+		if (entry->m_Offset != lastEnd)
+		{
+			++seeks;
+			seekDistance += (entry->m_Offset > lastEnd) ? entry->m_Offset - lastEnd : lastEnd - entry->m_Offset;
+		}
+		lastEnd = entry->m_Offset + entry->m_CompressedSize;
+
+		std::unique_ptr<PakFile> file = archive.GetPakFile(entry->m_HashID);
+		buffer.resize(entry->m_UncompressedSize);
+		if (buffer.empty() == false && file->Read(buffer.data(), (u32)buffer.size()) == false)
+		{
+			printf("Failed to read %s\n", path.c_str());
+			return false;
+		}
+
+		totalBytes += buffer.size();
+		++files;
+	}
+	double time = Seconds(start);
+
+	printf("%-30s %6u files %10.1f MB %10.3f ms %8u seeks %12.1f MB seeked\n", pakPath.c_str(), files,
+		totalBytes / (1024.0 * 1024.0), time * 1000.0, seeks, seekDistance / (1024.0 * 1024.0));
+	return true;
+}
+
+static int RunTraceBenchmark(const std::string& tracePath, const std::string& orderedPath, const std::string& unorderedPath)
+{
+	TextFile file(tracePath, FileMode::Read);
+	if (file.IsOpen() == false)
+	{
+		printf("Failed to open %s\n", tracePath.c_str());
+		return 1;
+	}
+
+	std::vector<std::string> trace;
+	std::string line;
+	while (file.ReadLine(line, true))
+	{
+		if (line.empty() == false)
+		{
+			trace.push_back(line);
+		}
+	}
+	file.Close();
+
+	return (ReplayTrace(orderedPath, trace) && ReplayTrace(unorderedPath, trace)) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 3 && std::string(argv[1]) == "-codecbench")
+	{
+		return RunBenchmark(argv[2]);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-readbench")
+	{
+		u32 maxThreads = (argc == 4) ? (u32)atoi(argv[3]) : std::thread::hardware_concurrency();
+		return RunReadBenchmark(argv[2], maxThreads > 0 ? maxThreads : 1);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-mountbench")
+	{
+		u32 entryCount = (argc == 4) ? (u32)atoi(argv[3]) : 100000;
+		return RunMountBenchmark(argv[2], entryCount > 0 ? entryCount : 100000, argv[0]);
+	}
+
+	if (argc == 4 && std::string(argv[1]) == "-mountload")
+	{
+		return RunMountLoad(argv[2], argv[3]);
+	}
+
+	if (argc == 5 && std::string(argv[1]) == "-tracebench")
+	{
+		return RunTraceBenchmark(argv[2], argv[3], argv[4]);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-decodebench")
+	{
+		u32 maxThreads = (argc == 4) ? (u32)atoi(argv[3]) : 16;
+		return RunDecodeBenchmark(argv[2], maxThreads > 0 ? maxThreads : 1);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-streambench")
+	{
+		u32 readSize = (argc == 4) ? (u32)atoi(argv[3]) : 4096;
+		return RunStreamBenchmark(argv[2], readSize > 0 ? readSize : 4096);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-writebench")
+	{
+		u32 megabytes = (argc == 4) ? (u32)atoi(argv[3]) : 500;
+		return RunWriteBenchmark(argv[2], megabytes);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-serialbench")
+	{
+		u32 vertexCount = (argc == 4) ? (u32)atoi(argv[3]) : 4000000;
+		return RunSerializeBenchmark(argv[2], vertexCount > 0 ? vertexCount : 4000000);
+	}
+
+	if ((argc == 2 || argc == 3) && std::string(argv[1]) == "-swapbench")
+	{
+		return RunSwapBenchmark((argc == 3) ? (u32)atoi(argv[2]) : 256);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-configbench")
+	{
+		u32 lineCount = (argc == 4) ? (u32)atoi(argv[3]) : 100000;
+		return RunConfigBenchmark(argv[2], lineCount);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-meshbench")
+	{
+		u32 triangleCount = (argc == 4) ? (u32)atoi(argv[3]) : 1000000;
+		return RunMeshBenchmark(argv[2], triangleCount, argv[0]);
+	}
+
+	if (argc == 3 && std::string(argv[1]) == "-meshload")
+	{
+		return RunMeshLoad(argv[2]);
+	}
+
+	if (argc >= 3 && argc <= 5 && std::string(argv[1]) == "-objbench")
+	{
+		u32 triangleCount = (argc >= 4) ? (u32)atoi(argv[3]) : 1000000;
+		u32 maxThreads = (argc == 5) ? (u32)atoi(argv[4]) : std::max(std::thread::hardware_concurrency(), 1u);
+		return RunObjBenchmark(argv[2], triangleCount, std::max(maxThreads, 1u));
+	}
+
+	if ((argc == 2 || argc == 3) && std::string(argv[1]) == "-weldbench")
+	{
+		u32 triangleCount = (argc == 3) ? (u32)atoi(argv[2]) : 1000000;
+		return RunWeldBenchmark(triangleCount);
+	}
+
+	if ((argc == 2 || argc == 3) && std::string(argv[1]) == "-cachebench")
+	{
+		u32 triangleCount = (argc == 3) ? (u32)atoi(argv[2]) : 1000000;
+		return RunCacheBenchmark(triangleCount);
+	}
+
+	if (argc >= 2 && argc <= 4 && std::string(argv[1]) == "-overdrawbench")
+	{
+		u32 triangleCount = (argc >= 3) ? (u32)atoi(argv[2]) : 200000;
+		float threshold = (argc == 4) ? (float)atof(argv[3]) : 1.05f;
+		return RunOverdrawBenchmark(triangleCount, threshold);
+	}
+
+	PrintUsage();
+	return 1;
+}
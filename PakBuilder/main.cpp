@@ -0,0 +1,255 @@
+#include "FileSystem/Pak/PakBuilder.h"
+#include "FileSystem/Pak/PakFile.h"
+#include "System/Hash32.h"
+#include "Resource/MeshCooker.h"
+#include "Resource/MeshOptimizer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+
+//NOTE:
+/*
+	Command line front end for PakBuilder.
+	PakBuilder <ContentFolder> <Output.pak> [-threads N] [-codec none|lz4|zstd] [-level N] [-order Trace.txt] [-nodedup] [-verify]
+	PakBuilder -check <Archive.pak> [Threads]
+	PakBuilder -patch <Base.pak> <New.pak> <Patch.pak>
+	PakBuilder -cookmesh <Input.obj> <Output.mesh>
+
+	Timings live in the Benchmarks tool and correctness checks in Tests, this only builds.
+*/
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static void PrintUsage()
+{
+	printf("Usage: PakBuilder <ContentFolder> <Output.pak> [options]\n");
+	printf("       PakBuilder -check <Archive.pak> [Threads]\n");
+	printf("       PakBuilder -patch <Base.pak> <New.pak> <Patch.pak>\n");
+	printf("       PakBuilder -cookmesh <Input.obj> <Output.mesh>\n");
+	printf("  -threads N  Worker threads used to pack files, 0 = all cores\n");
+	printf("  -codec C    none, lz4 or zstd, entries that dont shrink are stored\n");
+	printf("  -level N    Codec compression level, 0 = codec default\n");
+	printf("  -order T    Lay files out in the first access order recorded by PakArchive::StartTrace\n");
+	printf("  -nodedup    Store byte identical files separately instead of sharing one blob\n");
+	printf("  -verify     Mount the output and byte compare every file against the source\n");
+	printf("  -check      Verify every entry checksum in parallel, reports GB/s, 0 threads = all cores\n");
+	printf("  -patch      Write a delta of New against Base, then check Base + Patch reads back as New\n");
+	printf("  -cookmesh   Import an obj (weld, optimize, tangents) and write a cooked .mesh\n");
+}
+
+static double Seconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool ReadEntry(PakArchive& archive, u32 id, std::vector<u8>& buffer, u32& crc)
+{
+	std::unique_ptr<PakFile> file = archive.GetPakFile(id);
+	file->SeekEnd();
+	buffer.resize((size_t)file->FilePosition());
+	file->SeekStart();
+
+	if (buffer.empty() == false && file->Read(buffer.data(), (u32)buffer.size()) == false)
+	{
+		return false;
+	}
+
+	crc = Hash32::ComputeHash(buffer.data(), (u32)buffer.size());
+	return true;
+}
+
+static int RunCheck(const std::string& pakPath, u32 threadCount)
+{
+	PakArchive archive(pakPath);
+	if (archive.Mount() == false)
+	{
+		printf("Failed to mount %s\n", pakPath.c_str());
+		return 1;
+	}
+
+	Clock::time_point start = Clock::now();
+	std::vector<u32> failed;
+	bool result = archive.Verify(threadCount, &failed);
+	double time = Seconds(start);
+
+	// Archive size minus the directory is close enough for throughput
+	u64 dataBytes = archive.Header().m_StringOffset;
+	printf("%s (%s): %u files, %.1f MB checked in %.3f ms, %.2f GB/s\n", pakPath.c_str(), archive.IsMapped() ? "mapped" : "stdio",
+		archive.FileCount(), dataBytes / (1024.0 * 1024.0), time * 1000.0, dataBytes / (1024.0 * 1024.0 * 1024.0) / time);
+
+	for (u32 id : failed)
+	{
+		const PakEntry* entry = archive.FindEntry(id);
+		printf("  Corrupt: %s\n", archive.EntryPath(*entry));
+	}
+
+	return result ? 0 : 1;
+}
+
+static int RunPatch(const std::string& basePath, const std::string& newPath, const std::string& patchPath)
+{
+	PakPatchStats stats;
+	if (PakBuilder::BuildPatch(basePath, newPath, patchPath, &stats) == false)
+	{
+		printf("Failed to build patch %s\n", patchPath.c_str());
+		return 1;
+	}
+
+	printf("%u unchanged, %u changed, %u added, %u chunks reused, %u chunks stored\n",
+		stats.m_Unchanged, stats.m_Changed, stats.m_Added, stats.m_ReusedChunks, stats.m_NewChunks);
+	printf("Patch data %.1f KB vs %.1f KB for the full archive\n", stats.m_PatchBytes / 1024.0, stats.m_FullBytes / 1024.0);
+
+	// Every file in the new archive has too read back identically through base + patch
+	PakArchive base(basePath);
+	PakArchive next(newPath);
+	PakArchive patch(patchPath);
+	patch.SetBase(&base);
+	if (base.Mount() == false || next.Mount() == false || patch.Mount() == false || patch.Verify() == false ||
+		patch.FileCount() != next.FileCount())
+	{
+		printf("Patch failed to mount or verify\n");
+		return 1;
+	}
+
+	std::vector<u32> ids;
+	next.GetFileIDs(ids);
+
+	std::vector<u8> buffer;
+	u32 expected = 0;
+	u32 actual = 0;
+	for (u32 id : ids)
+	{
+		if (patch.HasFile(id) == false || ReadEntry(next, id, buffer, expected) == false || ReadEntry(patch, id, buffer, actual) == false || expected != actual)
+		{
+			printf("Patched read of %s doesnt match\n", next.EntryPath(*next.FindEntry(id)));
+			return 1;
+		}
+	}
+
+	printf("Patch verified.\n");
+	return 0;
+}
+
+static int RunCookMesh(const std::string& inputPath, const std::string& outputPath)
+{
+	CookedMesh mesh;
+	Clock::time_point start = Clock::now();
+	if (MeshCooker::ImportObj(inputPath, mesh) == false || MeshCooker::Save(outputPath, mesh) == false)
+	{
+		printf("Failed to cook %s\n", inputPath.c_str());
+		return 1;
+	}
+
+	VertexCacheStats stats = MeshOptimizer::AnalyzeVertexCache(mesh.m_Indices.data(), mesh.m_Indices.size(), (u32)mesh.m_Vertices.size());
+	printf("%s: %zu vertices, %zu indices, %zu parts in %.2f ms, ACMR %.3f ATVR %.3f\n", outputPath.c_str(), mesh.m_Vertices.size(),
+		mesh.m_Indices.size(), mesh.m_Parts.size(), Seconds(start) * 1000.0, stats.m_Acmr, stats.m_Atvr);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 4 && std::string(argv[1]) == "-cookmesh")
+	{
+		return RunCookMesh(argv[2], argv[3]);
+	}
+
+	if (argc == 5 && std::string(argv[1]) == "-patch")
+	{
+		return RunPatch(argv[2], argv[3], argv[4]);
+	}
+
+	if ((argc == 3 || argc == 4) && std::string(argv[1]) == "-check")
+	{
+		return RunCheck(argv[2], (argc == 4) ? (u32)atoi(argv[3]) : 0);
+	}
+
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::string contentFolder = argv[1];
+	std::string outputPath = argv[2];
+	std::string orderPath = "";
+	bool verify = false;
+	PakBuildSettings settings;
+
+	for (int i = 3; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "-threads" && i + 1 < argc)
+		{
+			settings.m_ThreadCount = (u32)atoi(argv[++i]);
+		}
+		else if (arg == "-codec" && i + 1 < argc)
+		{
+			if (PakCompression::FromName(argv[++i], settings.m_Codec) == false || PakCompression::IsSupported(settings.m_Codec) == false)
+			{
+				printf("Codec %s is unknown or not compiled in.\n", argv[i]);
+				return 1;
+			}
+		}
+		else if (arg == "-level" && i + 1 < argc)
+		{
+			settings.m_Level = atoi(argv[++i]);
+		}
+		else if (arg == "-order" && i + 1 < argc)
+		{
+			orderPath = argv[++i];
+		}
+		else if (arg == "-nodedup")
+		{
+			settings.m_Deduplicate = false;
+		}
+		else if (arg == "-verify")
+		{
+			verify = true;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	PakBuilder builder(settings);
+	if (builder.AddDirectory(contentFolder) == false)
+	{
+		printf("Failed to gather files from %s\n", contentFolder.c_str());
+		return 1;
+	}
+
+	if (orderPath.empty() == false && builder.ApplyOrder(orderPath) == false)
+	{
+		printf("Failed to read trace %s\n", orderPath.c_str());
+		return 1;
+	}
+
+	printf("Packing %u files into %s\n", builder.FileCount(), outputPath.c_str());
+	if (builder.Build(outputPath, contentFolder) == false)
+	{
+		printf("Failed to build %s\n", outputPath.c_str());
+		return 1;
+	}
+
+	if (builder.DuplicateCount() > 0)
+	{
+		printf("Deduplicated %u files, saved %.1f KB\n", builder.DuplicateCount(), builder.SavedBytes() / 1024.0);
+	}
+
+	if (verify)
+	{
+		if (PakBuilder::Verify(outputPath, contentFolder) == false)
+		{
+			printf("Verify failed, archive does not match %s\n", contentFolder.c_str());
+			return 1;
+		}
+
+		printf("Verify passed.\n");
+	}
+
+	return 0;
+}
@@ -1,6 +1,8 @@
 #include "Game.h"
 #include <Graphics/Common/CommonStates.h>
 #include "Input/Input.h"
+#include "FileSystem/Path.h"
+#include "System/Logger.h"
 
 void Game::Initialize()
 {
@@ -12,8 +14,19 @@ void Game::Initialize()
 	// Get command list for copying data
 	CommandList cmd = m_GraphicsDevice->BeginCommandList(QueueType::Direct);
 
-	// Load Mesh
-	m_Mesh = Mesh::LoadFromFile("Content\\MaterialBall\\MaterialBall.obj");
+	// Load Mesh, the build cooks the .mesh with PakBuilder -cookmesh so this just maps it.
+	// The obj is only a fallback for a tree that hasnt been built, nothing is written here.
+	const std::string meshSource = "Content\\MaterialBall\\MaterialBall.obj";
+	const std::string meshCooked = "Content\\MaterialBall\\MaterialBall.mesh";
+	if (Path::FileExists(meshCooked))
+	{
+		m_Mesh = Mesh::LoadFromFile(meshCooked);
+	}
+	else
+	{
+		LogWarning("No cooked mesh, importing " + meshSource);
+		m_Mesh = Mesh::LoadFromFile(meshSource);
+	}
 	m_Mesh.Upload(true, m_GraphicsDevice, cmd);
 
 	// Load Texture
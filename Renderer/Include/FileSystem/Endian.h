@@ -1,4 +1,5 @@
 #pragma once
+#include "System/Types.h"
 
 enum class Endian
 {
@@ -21,4 +22,34 @@ inline bool IsLittleEndian()
 inline Endian GetSystemEndian()
 {
 	return (*((int*)"AB")) != 0x4142 ? Endian::Little : Endian::Big;
-}
\ No newline at end of file
+}
+
+inline u16 ByteSwap16(u16 value)
+{
+	return (u16)((value >> 8) | (value << 8));
+}
+
+inline u32 ByteSwap32(u32 value)
+{
+	return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+inline u64 ByteSwap64(u64 value)
+{
+	return ((u64)ByteSwap32((u32)value) << 32) | ByteSwap32((u32)(value >> 32));
+}
+
+// Scalar always works, the others are x86 only and picked at runtime by Best.
+enum class SwapKernel { Scalar, SSSE3, AVX2, Best };
+
+// Fastest kernel this cpu supports
+SwapKernel BestSwapKernel();
+const char* SwapKernelName(SwapKernel kernel);
+
+// Flips count words of wordSize bytes (2, 4 or 8) in place, 1 does nothing. A kernel the
+// cpu doesnt support falls back too the best one it does.
+void SwapEndian(void* data, u64 count, u32 wordSize, SwapKernel kernel = SwapKernel::Best);
+
+inline void SwapEndian16(u16* data, u64 count) { SwapEndian(data, count, 2); }
+inline void SwapEndian32(u32* data, u64 count) { SwapEndian(data, count, 4); }
+inline void SwapEndian64(u64* data, u64 count) { SwapEndian(data, count, 8); }
@@ -24,6 +24,7 @@ public:
 		m_Type = type;
 		m_FilePosition = 0;
 	}
+	virtual ~BaseFile() {}
 
 public:
 	FileMode Mode()const;
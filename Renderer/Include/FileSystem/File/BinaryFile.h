@@ -4,26 +4,64 @@
 	All target platforms are x86 based architecture now so can just use fwrite and fread 
 	with no pre-flip? Im leaving the endian waste of time flip in anyways because i may
 	need it in the future.
+
+	Writes go straight too fwrite unless SetWriteBuffer is given a size, then they collect
+	in our own buffer and leave in one write once it fills (or on Flush/Seek/Close). Handy
+	when cooking assets out as millions of WriteDword calls. WriteGather sends several
+	blocks (plus anything pending) with one writev, on windows thats a WriteFile per block
+	since WriteFileGather only takes unbuffered page aligned pages.
+
+	SetEndian says which way round the file's values are, Read/WriteWord, Dword, Float and
+	ReadArray follow it. Arrays are read raw then flipped in bulk with SwapEndian, so only
+	a file cooked on the other endian pays anything. Plain Read/Write are bytes, untouched.
 */
 #pragma once
 #include "BaseFile.h"
 #include "System/Types.h"
+#include "FileSystem/Endian.h"
+#include <vector>
+
+struct FileSpan
+{
+	const Byte* m_Data = nullptr;
+	u32			m_Size = 0;
+};
 
 class BinaryFile : public BaseFile
 {
 protected:
-	FILE* m_File;
+	FILE* m_File = nullptr;
+	std::vector<Byte> m_WriteBuffer;	// Empty = unbuffered
+	u32 m_WriteUsed = 0;				// Bytes waiting in m_WriteBuffer
+	Endian m_Endian = Endian::Little;	// Byte order of the values in the file
 
 public:
 	BinaryFile(const std::string& path, FileMode mode);
-
+	// Flushes anything still in the write buffer and closes, early returns cant lose data
+	~BinaryFile() { Close(); }
 
 public:
+	// Closes (and flushes) whatever was open before
 	bool  Open(const std::string& path, FileMode mode);
+	// Safe too call more than once
 	void  Close();
 	bool  Read(Byte* data, u32 count);
 	bool  ReadFrom(Byte* data, u32 origin, u32 count);
+	// Positional read (pread), doesnt touch or depend on the file cursor so any
+	// number of threads can call it at once on the same file.
+	bool  ReadAt(Byte* data, u64 offset, u32 count)const;
 	bool  Write(const Byte* data, u32 count);
+	// 0 goes back too unbuffered writes, flushes whatever is pending first
+	bool  SetWriteBuffer(u32 size);
+	bool  WriteGather(const FileSpan* spans, u32 count);
+	bool  Flush();
+	void  SetEndian(Endian endian) { m_Endian = endian; }
+	Endian GetEndian()const { return m_Endian; }
+	// count values in the file's endian, flipped too the host's if they differ
+	bool  ReadArray(u16* data, u32 count);
+	bool  ReadArray(u32* data, u32 count);
+	bool  ReadArray(u64* data, u32 count);
+	bool  ReadArray(float* data, u32 count);
 	bool  WriteByte(const Byte& value);
 	bool  WriteWord(const Word& value);
 	bool  WriteDword(const Dword& value);
@@ -39,4 +77,7 @@ public:
 	void SeekEnd(); 
 	int  FilePosition()const;
 	bool IsEndOfFile();
+
+private:
+	bool ReadWords(void* data, u32 count, u32 wordSize);
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+//NOTE:
+/*
+	Read only view of an entire file mapped into the address space. The OS pages
+	data in on first touch and the page cache is shared with any other process
+	that maps the same file, so there is no seek, no syscall and no copy per read.
+*/
+#pragma once
+#include <string>
+#include "System/Types.h"
+
+class MappedFile
+{
+private:
+	std::string m_Path			= "";
+	const Byte* m_Data			= nullptr;
+	u64			m_Size			= 0;
+	void*		m_FileHandle	= nullptr;
+	void*		m_MapHandle		= nullptr;
+
+public:
+	MappedFile() {}
+	MappedFile(const std::string& path);
+	MappedFile(const MappedFile& file) = delete;
+	~MappedFile();
+
+	void operator=(const MappedFile& file) = delete;
+
+public:
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen()const { return m_Data != nullptr; }
+	const Byte* Data()const { return m_Data; }
+	u64 Size()const { return m_Size; }
+	const std::string& GetPath()const { return m_Path; }
+};
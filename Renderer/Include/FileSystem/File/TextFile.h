@@ -17,7 +17,7 @@ public:
 
 	bool Read(char* buffer, u32 bufferSize);
 	bool ReadLine(char* buffer, u32 bufferSize);
-	// Max Length 1024
+	// Any length, TextReader is much quicker for parsing a whole file
 	bool ReadLine(std::string& line, bool removeTralingSpace);
 	std::string ReadLine(bool removeTralingSpace);
 	bool Write(const char* buffer, u32 bufferSize);
@@ -0,0 +1,42 @@
+//NOTE:
+/*
+	Whole file text reader for parsing, the file is mapped (or read in one go where mapping
+	isnt available) and ReadLine hands back string_views into it. No fgets, no line length
+	cap and no allocation per line, copy a view into a std::string only if it has too
+	outlive the reader. Handles \n and \r\n endings.
+*/
+#pragma once
+#include "FileSystem/File/MappedFile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TextReader
+{
+private:
+	MappedFile			m_Mapping;
+	std::vector<char>	m_Buffer;		// Only when the file couldnt be mapped
+	const char*			m_Data		= nullptr;
+	size_t				m_Size		= 0;
+	size_t				m_Position	= 0;
+
+public:
+	TextReader() {}
+	TextReader(const std::string& path);
+	// Reads text already in memory, e.g. a PakSpan, data has too outlive the reader
+	TextReader(const char* data, size_t size);
+	TextReader(const TextReader& reader) = delete;
+
+	void operator=(const TextReader& reader) = delete;
+
+public:
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen()const { return m_Data != nullptr; }
+
+	// Next line without its ending, false once there are none left
+	bool ReadLine(std::string_view& line);
+	void Rewind() { m_Position = 0; }
+	bool IsEndOfFile()const { return m_Position >= m_Size; }
+	std::string_view Text()const { return std::string_view(m_Data, m_Size); }
+};
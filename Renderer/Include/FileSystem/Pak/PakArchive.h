@@ -6,51 +6,198 @@
 
 #pragma once
 #include "System/Types.h"
-#include <unordered_map>
+#include "FileSystem/Pak/PakCodec.h"
+#include <functional>
 #include <memory>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
+#include <unordered_map>
+
+// 1: Compressed entries are a chunk offset table followed by independently compressed chunks
+// 2: Compact directory, [data][string table][PakEntry table sorted by hash][PakHeader]
+// 3: xxHash64 per entry, chunk tables gain a 32bit checksum per chunk after the offsets
+// 4: Header flags + base id for delta patch archives, see PakBuilder::BuildPatch
+#define PAK_VERSION 4
+#define PAK_CHUNK_SIZE (64 * 1024)
+
+// PakHeader::m_Flags
+#define PAK_HEADER_PATCH		0x1		// Delta against the archive whose DirectoryID is m_BaseID
+
+// PakEntry::m_Flags, only found in patch archives
+#define PAK_ENTRY_UNCHANGED		0x1		// Same as the base entry, nothing stored
+#define PAK_ENTRY_DELTA			0x2		// Stored blob is a PakDeltaChunk table, see below
 
 class PakFile;
 class BinaryFile;
+class MappedFile;
+class PakIOQueue;
+class ThreadPool;
+class PakBatch;
+struct PakRequest;
 
 struct PakHeader
 {
 	char m_ID[4] = { "PAK" };
-	int  m_Version = 0;
-	char m_FolderPath[256]; // Windows max path is basically this, not since win10/11 though
-	char m_PakName[50];
+	int  m_Version = PAK_VERSION;
 	u32  m_Entries = 0;
+	u32  m_EntryOffset = 0;	 // PakEntry[m_Entries], sorted by m_HashID
+	u32  m_StringOffset = 0; // Packed null terminated paths
+	u32  m_StringSize = 0;
+	u32  m_FolderPath = 0;	 // String table offset of the source folder
+	u32  m_PakName = 0;		 // String table offset of the archive name
+	u32  m_Flags = 0;
+	u32  m_Reserved = 0;
+	u64  m_BaseID = 0;		 // Patches only, DirectoryID of the base they were diffed against
 };
 
+static_assert(sizeof(PakHeader) == 48, "PakHeader is read straight from disk, keep it packed");
+
+// Fixed 32 bytes, paths live in the string table so the table can be binary searched in place
 struct PakEntry
 {
-	char m_FilePath[256];
-	bool m_Compressed;
 	u32	 m_HashID;			 // Hash of the filepath, saves string dictionary lookup
-	u32  m_UncompressedSize;
-	u32  m_CompressedSize;
+	u32  m_PathOffset;		 // Offset into the string table
 	u32  m_Offset;
+	u32  m_CompressedSize;
+	u32  m_UncompressedSize;
+	PakCodec m_Codec;		 // None = stored
+	u8	 m_Flags;
+	u16	 m_Reserved;
+	u64  m_Checksum;		 // xxHash64 of the m_CompressedSize bytes stored at m_Offset
+};
+
+static_assert(sizeof(PakEntry) == 32, "PakEntry is read straight from disk, keep it packed");
+
+// A PAK_ENTRY_DELTA blob is u32 chunkCount, PakDeltaChunk[chunkCount] then the changed chunks.
+// Chunks are the usual PAK_CHUNK_SIZE pieces of the file, packed with the entries codec (or raw).
+struct PakDeltaChunk
+{
+	u32 m_Offset;			 // Relative too the entry when in the patch, absolute in the base
+	u32 m_Size;				 // Packed size, equal too the chunk size means raw
+	u32 m_Checksum;			 // Low 32bits of the xxHash64 of the packed bytes
+	u32 m_FromBase;			 // 1 = unchanged chunk read from the base archive
 };
 
+static_assert(sizeof(PakDeltaChunk) == 16, "PakDeltaChunk is read straight from disk, keep it packed");
+
+// Read only view of archive bytes, only valid while the archive that handed it out is alive
+struct PakSpan
+{
+	const Byte* m_Data = nullptr;
+	u32			m_Size = 0;
+
+	bool IsValid()const { return m_Data != nullptr; }
+	const Byte* begin()const { return m_Data; }
+	const Byte* end()const { return m_Data + m_Size; }
+};
+
+// Threading: Mount once on one thread, after that the entry table is read only and every
+// archive read is positional (mapping or pread), so HasFile, GetFile, GetPakFile and ReadFrom
+// are safe to call from any number of loader threads at once. A PakFile keeps its own
+// cursor and chunk cache, so each one should only be used by one thread at a time.
+// ReadAsync and CancelAsync are also safe from any thread.
 class PakArchive
 {
 private:
 	std::unique_ptr<BinaryFile> m_File;			 // So i dont have to self delete
-	std::unordered_map<u32, PakEntry> m_Entries;
+	std::unique_ptr<MappedFile> m_Mapping;		 // Null when mapping is disabled or failed
+	const PakEntry* m_Entries = nullptr;		 // Into the mapping, or m_DirectoryData when unmapped
+	const char* m_Strings = nullptr;
+	std::vector<u8> m_DirectoryData;			 // Only used by the stdio fallback
 	PakHeader m_Header;
 	std::string m_Path = "";
-
-	typedef std::unordered_map<u32, PakEntry>::iterator EntryIterator;
+	bool m_UseMapping = true;
+	std::once_flag m_IOStarted;
+	std::atomic<bool> m_Tracing{ false };
+	std::mutex m_TraceLock;
+	std::vector<u32> m_Trace;					 // First access order while tracing
+	std::unordered_set<u32> m_TraceSeen;
+	std::mutex m_BlobLock;
+	std::unordered_map<u64, std::weak_ptr<const std::vector<u8>>> m_Blobs; // Keyed by offset and size
+	std::unique_ptr<ThreadPool> m_DecodePool;	 // Null = decode on the reading thread
+	std::unique_ptr<std::atomic<bool>[]> m_Verified; // Per entry, set once lazily checked
+	PakArchive* m_Base = nullptr;				 // Patches only, not owned
+	bool m_LazyVerify = false;
+	std::unique_ptr<PakIOQueue> m_IOQueue;		 // Last so it's torn down before the file it reads
 
 public:
-	PakArchive(const std::string& path);
+	PakArchive(const std::string& path, bool useMapping = true);
+	~PakArchive();
 
 public:
+	// Finds a mounted archive by DirectoryID, nullptr if there isnt one
+	typedef std::function<PakArchive*(u64 directoryID)> BaseResolver;
+
+	// Maps the whole archive when allowed, falls back to stdio reads if the OS refuses
 	bool Mount();
+	// Same, but a patch without SetBase asks findBase for the archive it was diffed against
+	bool Mount(const BaseResolver& findBase);
+	bool IsMapped()const;
+	// Patch archives read unchanged data from their base, set it before Mount. The base has too
+	// outlive the patch and Mount fails if the patch was built against a different base.
+	void SetBase(PakArchive* base) { m_Base = base; }
+	PakArchive* Base()const { return m_Base; }
+	bool IsPatch()const { return (m_Header.m_Flags & PAK_HEADER_PATCH) != 0; }
+	// Hash of the entry table, changes whenever any file in the archive does
+	u64 DirectoryID()const;
+	const PakHeader& Header()const { return m_Header; }
+	u32 FileCount()const { return m_Header.m_Entries; }
+	void GetFileIDs(std::vector<u32>& ids)const;
+	// Sorted by hash, FileCount() long
+	const PakEntry* Entries()const { return m_Entries; }
+	const char* EntryPath(const PakEntry& entry)const;
 	bool HasFile(const std::string& path)const;
 	bool HasFile(u32 hashID)const;
-	// Expensive use sparingly
+	// Expensive use sparingly, hashes the path every call
 	std::unique_ptr<PakFile> GetFile(const std::string& path);
-	// Much cheaper use this
+	// Much cheaper use this, GetPakFile("Shaders\\VertexColor.shader"_hash) is just a table probe
 	std::unique_ptr<PakFile> GetPakFile(u32 hashID);
-	BinaryFile* ArchiveFile()const { return m_File.get(); }
+	const PakEntry* FindEntry(u32 hashID)const;
+	// Whole decoded file, shared by every path pointing at the same blob (see PakBuilder dedup)
+	// so it's only decoded once while anyone still holds it. nullptr if missing or unreadable.
+	std::shared_ptr<const std::vector<u8>> ReadShared(u32 hashID);
+	// Zero copy, points straight into the mapping for stored entries. Invalid when the archive
+	// isnt mapped or the entry is compressed, Read it instead (or use the overload below).
+	PakSpan GetSpan(u32 hashID)const;
+	// Same but falls back too reading the file into storage, so loaders only need one path
+	PakSpan GetSpan(u32 hashID, std::vector<u8>& storage);
+
+	// Records the first GetFile/GetPakFile of every entry, run it over a level load
+	void StartTrace();
+	// Writes the recorded paths one per line, PakBuilder -order lays the data out in that order
+	bool StopTrace(const std::string& tracePath);
+
+	// Large compressed reads split their chunks across this many threads, 0 or 1 turns it off.
+	// Call before loader threads start reading.
+	void SetDecodeThreads(u32 threadCount);
+	ThreadPool* DecodePool()const { return m_DecodePool.get(); }
+
+	// Checks every stored blob against its checksum across threadCount threads (0 = all cores).
+	// failedIDs gets every entry that points at a bad blob.
+	bool Verify(u32 threadCount = 0, std::vector<u32>* failedIDs = nullptr);
+	// When on, stored entries are checked whole on their first read and compressed chunks
+	// every time they're decoded, a bad entry then fails Read instead of handing back garbage.
+	void SetLazyVerify(bool enabled) { m_LazyVerify = enabled; }
+	bool LazyVerify()const { return m_LazyVerify; }
+	// Lazy check for stored entries, only hashes the entry the first time
+	bool VerifyOnce(const PakEntry& entry);
+
+	// Starts the I/O threads, optional, ReadAsync starts them with the default count
+	void StartAsync(u32 threadCount = 2);
+	// Queues a batch of whole file reads, they complete on the I/O threads
+	std::shared_ptr<PakBatch> ReadAsync(const std::vector<PakRequest>& requests);
+	// Drops any queued request with a priority lower than belowPriority, returns how many
+	u32 CancelAsync(u32 belowPriority);
+	// Reads raw archive bytes, straight from the mapping when we have one
+	bool ReadFrom(Byte* data, u32 offset, u32 count);
+	// Pointer into the mapping, nullptr when not mapped so the caller has too ReadFrom
+	const Byte* MappedData(u32 offset, u32 count)const;
+
+private:
+	void RecordAccess(const PakEntry* entry);
+	std::unique_ptr<PakFile> OpenEntry(const std::string& path, const PakEntry* entry);
+	bool VerifyEntry(const PakEntry& entry);
 };
\ No newline at end of file
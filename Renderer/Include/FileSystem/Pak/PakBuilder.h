@@ -0,0 +1,78 @@
+//NOTE:
+/*
+	Offline side of PakArchive, walks a content folder and writes the exact layout
+	Mount expects: [file data][string table][PakEntry * n][PakHeader]. Paths are stored
+	relative too the content root so GetFile("Shaders\\VertexColor.shader") just works.
+*/
+#pragma once
+#include "FileSystem/Pak/PakArchive.h"
+#include <string>
+#include <vector>
+
+struct PakBuildSettings
+{
+	u32 m_ThreadCount	= 0;				// 0 = one worker per hardware thread
+	u64 m_BatchBytes	= 256 * 1024 * 1024;	// Max source bytes held in memory at once
+	PakCodec m_Codec	= PakCodec::None;		// Entries that dont shrink are stored instead
+	int m_Level			= 0;					// Codec compression level, 0 = default
+	bool m_Deduplicate	= true;					// Byte identical files share one blob
+};
+
+struct PakPatchStats
+{
+	u32 m_Unchanged		= 0;	// Entries read straight from the base
+	u32 m_Changed		= 0;
+	u32 m_Added			= 0;
+	u32 m_ReusedChunks	= 0;	// Chunks of changed/added entries found in the base
+	u32 m_NewChunks		= 0;
+	u64 m_PatchBytes	= 0;	// Data stored in the patch
+	u64 m_FullBytes		= 0;	// Data stored in the new archive
+};
+
+class PakBuilder
+{
+private:
+	struct BuildItem
+	{
+		std::string		m_SourcePath;
+		std::string		m_PakPath;
+		PakEntry		m_Entry;
+		std::vector<u8> m_Data;
+		u64				m_ContentHash = 0;	// xxHash64 of the source bytes
+		bool			m_Failed = false;
+	};
+
+	PakBuildSettings		m_Settings;
+	std::vector<BuildItem>	m_Items;
+	u32						m_DuplicateCount = 0;
+	u64						m_SavedBytes = 0;
+
+public:
+	PakBuilder(const PakBuildSettings& settings = PakBuildSettings());
+
+public:
+	// Adds every file under directory, pak paths are relative too directory
+	bool AddDirectory(const std::string& directory);
+	bool AddFile(const std::string& sourcePath, const std::string& pakPath);
+	// Moves files listed in a PakArchive::StopTrace file to the front in first access order,
+	// so a traced load reads the archive mostly front too back. Call after adding files.
+	bool ApplyOrder(const std::string& tracePath);
+	bool Build(const std::string& outputPath, const std::string& folderPath = "");
+	u32 FileCount()const;
+	// Stats from the last Build, files that reused another blob and the archive bytes that saved
+	u32 DuplicateCount()const { return m_DuplicateCount; }
+	u64 SavedBytes()const { return m_SavedBytes; }
+
+	// Mounts a built archive and byte compares every entry against the source folder
+	static bool Verify(const std::string& pakPath, const std::string& directory);
+
+	// Diffs two builds at chunk granularity, the patch holds only chunks the base doesnt have
+	// plus a remap table for each changed entry. Mount it with PakArchive::SetBase(base),
+	// files missing from newPath are gone from the patched view too.
+	static bool BuildPatch(const std::string& basePath, const std::string& newPath, const std::string& patchPath, PakPatchStats* stats = nullptr);
+
+private:
+	void PackItem(BuildItem& item);
+	void PackChunks(BuildItem& item);
+	void PackBatch(size_t start, size_t end);
+};
@@ -0,0 +1,33 @@
+//NOTE:
+/*
+	Codecs are picked per PakEntry. zstd is the lib vendored in External/zstd and is compiled
+	in with PAK_ZSTD, which every project defines. LZ4 is upstream lz4 in External/lz4 through
+	PakLZ4, compiled in with PAK_LZ4 which projects define when lz4.c is there. Archives using
+	a codec that wasnt compiled in fail to read rather than returning garbage.
+
+	LZ4 is the fast one for decode on the loading thread, zstd trades decode speed for ratio.
+*/
+#pragma once
+#include "System/Types.h"
+
+enum class PakCodec : u8
+{
+	None = 0,	// Stored
+	LZ4,
+	Zstd,
+	Count
+};
+
+namespace PakCompression
+{
+	bool IsSupported(PakCodec codec);
+	const char* Name(PakCodec codec);
+	// Parses "none", "lz4" or "zstd", returns false for anything else
+	bool FromName(const char* name, PakCodec& codec);
+	// Worst case size of compressing size bytes
+	u32 CompressBound(PakCodec codec, u32 size);
+	// Returns the compressed size or 0 on failure, level 0 means codec default
+	u32 Compress(PakCodec codec, const Byte* source, u32 sourceSize, Byte* dest, u32 destCapacity, int level = 0);
+	// Decodes exactly destSize bytes into dest, no intermediate buffer
+	bool Decompress(PakCodec codec, const Byte* source, u32 sourceSize, Byte* dest, u32 destSize);
+};
@@ -3,32 +3,43 @@
 #include <vector>
 
 struct PakEntry;
+struct PakDeltaChunk;
 class PakArchive;
 class PakFile : public BaseFile
 {
 protected:
-	PakEntry*			m_Entry		= nullptr;
+	const PakEntry*		m_Entry		= nullptr;
 	PakArchive*			m_Archive	= nullptr;
-	std::vector<u8>		m_UncompressedData;
+	std::vector<u32>	m_ChunkTable;				// Offsets of each compressed chunk + end relative too m_Offset, then chunk checksums
+	std::vector<PakDeltaChunk> m_DeltaChunks;		// Patch entries only, replaces m_ChunkTable
+	std::vector<u8>		m_Window;					// Last few decoded chunks, only used for partial chunk reads
+	std::vector<int>	m_WindowChunks;				// Which chunk each window slot holds, -1 = empty
+	std::vector<u32>	m_WindowUse;				// Last use of each slot, oldest gets replaced
+	u32					m_UseCount = 0;
+	std::vector<u8>		m_CompressedChunk;			// Staging for unmapped archives
 
 public:
-	PakFile(const std::string& path, PakArchive* archive, PakEntry* entry);
+	PakFile(const std::string& path, PakArchive* archive, const PakEntry* entry);
 
 public:
 	void  Close();
 	bool  Read(u8* data, u32 count);
-	bool  ReadFrom(u8* data, u32 origin, u32 count) { return true; }
-	u8  ReadByte() {return 0;}
-	u16  ReadWord() {return 0;}
-	u32 ReadDword() {return 0;}
-	float ReadFloat() {return 0;}
-	std::string ReadString() { return ""; }
-	void Seek(u32 origin, u32 offset) {}
-	void SeekStart() {}
-	void SeekEnd() {}
+	bool  ReadFrom(u8* data, u32 origin, u32 count);
+	u8  ReadByte();
+	u16  ReadWord();
+	u32 ReadDword();
+	float ReadFloat();
+	std::string ReadString();
+	void Seek(u32 origin, u32 offset);
+	void SeekStart();
+	void SeekEnd();
 	int  FilePosition()const;
 	bool IsEndOfFile();
 
 private:
-	bool CacheUncompressedData();
-};
\ No newline at end of file
+	bool LoadChunkTable();
+	bool LoadDeltaTable(u32 chunkCount);
+	bool DecodeChunk(u32 chunk, Byte* destination, std::vector<u8>& staging)const;
+	bool DecodeChunks(u32 firstChunk, u32 count, Byte* destination)const;
+	const Byte* WindowChunk(u32 chunk);
+};
@@ -0,0 +1,92 @@
+//NOTE:
+/*
+	Sits above PakArchive so the base pak, DLC and patches look like one archive. Every
+	mounted archive feeds one merged hash -> (archive, entry) index, so a lookup is a single
+	hash probe no matter how many paks are mounted. Higher priority wins, on a tie the
+	archive mounted last wins so patches can just be mounted after the base.
+
+	Mount/Unmount only touch the ids the archive being added or removed contains, a 2MB
+	patch doesnt cost a rebuild of the 100k entry base index. A patch also walks its base
+	once for files it deleted, that only rewrites the ids it finds missing.
+
+	Delta patches (PakBuilder::BuildPatch) mount like any other pak once their base is
+	mounted, the base is found by its DirectoryID among the mounted archives. Mount with a
+	basePath names it instead. A patch lists every file of the new version, so base files
+	it leaves out were deleted and are hidden while it outranks the base. A base cant be unmounted or remounted while a patch built
+	on it is still mounted, unmount the patch first.
+
+	Development builds can point at the loose content folder, paths missing from every
+	pak are then read straight off disk through Path::FileExists.
+
+	Threading: Mount, Unmount and Remount must not run while other threads are looking
+	files up, do them between loads. Lookups and reads are then safe from any thread.
+*/
+#pragma once
+#include "FileSystem/Pak/PakArchive.h"
+#include <unordered_map>
+
+class PakFileSystem
+{
+private:
+	struct MountedArchive
+	{
+		std::unique_ptr<PakArchive> m_Archive;
+		std::string m_Path		= "";
+		int			m_Priority	= 0;
+		u32			m_Order		= 0;	// Mount order, breaks priority ties
+		bool		m_UseMapping	= true;	// What Mount was asked for, Remount reuses it
+	};
+
+	struct IndexEntry
+	{
+		MountedArchive* m_Mount = nullptr;
+		const PakEntry* m_Entry = nullptr;
+	};
+
+	std::vector<std::unique_ptr<MountedArchive>> m_Archives;
+	std::unordered_map<u32, IndexEntry> m_Index;
+	std::string m_LooseRoot = "";
+	u32 m_NextOrder = 0;
+
+public:
+	PakFileSystem() {}
+
+public:
+	bool Mount(const std::string& path, int priority = 0, bool useMapping = true);
+	// Patch on top of an archive that is already mounted from basePath
+	bool Mount(const std::string& path, const std::string& basePath, int priority = 0, bool useMapping = true);
+	bool Unmount(const std::string& path);
+	// Reloads an archive that changed on disk, keeps its priority
+	bool Remount(const std::string& path);
+	bool IsMounted(const std::string& path)const;
+	u32 ArchiveCount()const { return (u32)m_Archives.size(); }
+	u32 FileCount()const { return (u32)m_Index.size(); }
+
+	// Paths relative too root are read from disk when no pak has them, empty disables it
+	void SetLooseRoot(const std::string& root);
+
+	bool HasFile(const std::string& path)const;
+	bool HasFile(u32 hashID)const;
+	// Archive that currently owns hashID, entry is optional
+	PakArchive* FindArchive(u32 hashID, const PakEntry** entry = nullptr)const;
+	// Only pak files, loose files need a path so use ReadFile for those
+	std::unique_ptr<PakFile> GetPakFile(u32 hashID);
+	// Whole file into data, tries the paks then the loose folder
+	bool ReadFile(const std::string& path, std::vector<u8>& data);
+	bool ReadFile(u32 hashID, std::vector<u8>& data);
+
+private:
+	bool MountArchive(const std::string& path, int priority, bool useMapping, PakArchive* base);
+	MountedArchive* FindMount(const std::string& path)const;
+	MountedArchive* FindMount(const PakArchive* archive)const;
+	// Mounted non patch archive with this DirectoryID
+	PakArchive* FindBase(u64 directoryID)const;
+	bool HasPatchOn(const PakArchive* base)const;
+	bool Outranks(const MountedArchive* a, const MountedArchive* b)const;
+	// True when a patch on mount outranks it and doesnt list hashID, skip is ignored
+	bool IsHidden(const MountedArchive* mount, u32 hashID, const MountedArchive* skip)const;
+	// Points hashID at the best archive that still shows it, or drops it
+	void Reindex(u32 hashID, const MountedArchive* skip);
+	void AddToIndex(MountedArchive* mount);
+	void RemoveFromIndex(MountedArchive* mount);
+};
@@ -0,0 +1,92 @@
+//NOTE:
+/*
+	Async side of PakArchive. Requests come in as batches, get sorted by priority then
+	archive offset so scattered reads turn into mostly forward reads, and are completed on
+	a small pool of I/O threads using the archives positional reads.
+
+	io_uring is Linux only and the Win11 IoRing api isnt on Win10, so this sticks to a pread
+	style pool which works everywhere. Decompression happens on the I/O thread as part of
+	PakFile::Read, the caller is free to decode meshes/textures meanwhile.
+*/
+#pragma once
+#include "System/Types.h"
+#include <functional>
+#include <future>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class PakArchive;
+
+struct PakRequest
+{
+	u32		m_HashID		= 0;
+	Byte*	m_Destination	= nullptr;	// Must hold the entries full uncompressed size
+	u32		m_Priority		= 0;		// Higher goes first, lower ones can be cancelled
+	// Called on an I/O thread, success is false for failed or cancelled requests
+	std::function<void(const PakRequest& request, bool success)> m_OnComplete;
+};
+
+// Handle for one submitted batch, completes once every request has finished or been cancelled
+class PakBatch
+{
+	friend class PakIOQueue;
+
+private:
+	std::atomic<u32>		m_Remaining;
+	std::atomic<u32>		m_Failed;
+	std::promise<bool>		m_Promise;
+	std::shared_future<bool> m_Future;
+
+public:
+	PakBatch(u32 count);
+
+public:
+	bool IsComplete()const;
+	// Blocks until the batch is done, true when every request succeeded
+	bool Wait()const;
+	u32 FailedCount()const;
+	std::shared_future<bool> Future()const { return m_Future; }
+
+private:
+	void Complete(bool success);
+};
+
+class PakIOQueue
+{
+private:
+	struct Job
+	{
+		PakRequest					m_Request;
+		u32							m_Offset = 0;
+		std::shared_ptr<PakBatch>	m_Batch;
+	};
+
+	PakArchive*					m_Archive = nullptr;
+	std::vector<Job>			m_Jobs;				// Sorted so back() is the next job
+	std::vector<std::thread>	m_Threads;
+	std::mutex					m_Lock;
+	std::condition_variable		m_Signal;
+	bool						m_Running = false;
+
+public:
+	PakIOQueue(PakArchive* archive, u32 threadCount);
+	~PakIOQueue();
+
+public:
+	std::shared_ptr<PakBatch> Submit(const std::vector<PakRequest>& requests);
+	// Drops queued requests below priority, in flight requests still finish
+	u32 Cancel(u32 belowPriority);
+	void Shutdown();
+
+private:
+	void WorkerThread();
+	void Execute(Job& job);
+	// Drops every queued request whatever its priority, Shutdown uses it so nobody waits forever
+	u32 CancelAll();
+	// Reports each job as failed, call it outside the lock
+	static void FailJobs(std::vector<Job>& jobs);
+};
@@ -0,0 +1,25 @@
+//NOTE:
+/*
+	Thin wrapper over upstream lz4 (External/lz4, lz4.c + lz4hc.c from the 1.9.4 release next
+	too the headers). Blocks are the raw LZ4_compress_default/LZ4_decompress_safe format, no
+	frame header. Projects compile the lib and define PAK_LZ4 when the sources are there,
+	without them every call fails and PakCompression::IsSupported reports LZ4 as missing.
+
+	Level 0 is LZ4_compress_default, anything higher is LZ4_compress_HC at that level (capped
+	at LZ4HC_CLEVEL_MAX). Decode speed doesnt depend on the level.
+
+	Decompress is LZ4_decompress_safe, a corrupt or truncated block fails instead of reading
+	or writing out of bounds.
+*/
+#pragma once
+#include "System/Types.h"
+
+namespace PakLZ4
+{
+	// Worst case size of compressing size bytes, LZ4_compressBound
+	u32 CompressBound(u32 size);
+	// Returns the compressed size or 0 if it doesnt fit in destCapacity
+	u32 Compress(const Byte* source, u32 sourceSize, Byte* dest, u32 destCapacity, int level = 0);
+	// Decodes a whole block, fails unless it produces exactly destSize bytes
+	bool Decompress(const Byte* source, u32 sourceSize, Byte* dest, u32 destSize);
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 
 namespace Path
 {
@@ -9,6 +10,8 @@ namespace Path
 	std::string DirectoryPath(const std::string& path);
 	bool FileExists(const std::string& path);
 	bool DirectoryExists(const std::string& path);
+	// Full paths of every file under directory, walks sub folders when recursive
+	std::vector<std::string> GetFiles(const std::string& directory, bool recursive = true);
 	std::string GameDirectory();
 	// Append the game name too the end of this
 	std::string SaveDirectory();
@@ -0,0 +1,235 @@
+//NOTE:
+/*
+	One Serialize(Archive&, T&) per type does both directions, the archive knows if its
+	loading or saving so the field list only gets written once and cant drift out of sync.
+
+		bool Serialize(Archive& archive, MaterialSlot& slot)
+		{
+			return Serialize(archive, slot.m_Name) && Serialize(archive, slot.m_Parts);
+		}
+
+	Anything IsBitwise goes through as raw bytes and a std::vector of it is a single copy,
+	so a million Vector3s is one read not three million. Other types recurse into their own
+	Serialize, found by ADL so it just has too be declared next too the type.
+
+	Versioning: SerializeHeader writes magic + the latest version, on load it rejects a
+	different magic or anything newer and leaves the file's version in archive.Version().
+	New fields go on the end behind "if (archive.Version() >= 2)" so old assets still load.
+
+	Endian: saving is always host order. A magic that reads back byte swapped means the
+	file came from the other endian, the archive is marked swapped and every IsBitwise
+	value/array after it is flipped with SwapEndian using the type's WordSize.
+
+	Failures stick, once a read comes up short every later call fails too, so a chain of
+	&& or one check of Failed() at the end is enough.
+*/
+#pragma once
+#include "System/Types.h"
+#include "FileSystem/Endian.h"
+#include <string>
+#include <vector>
+#include <type_traits>
+
+class BinaryFile;
+class PakFile;
+class Vector2;
+class Vector3;
+class Vector4;
+class Color;
+class Quaternion;
+class Matrix4;
+struct Vertex;
+struct VertexTexture;
+struct VertexColor;
+struct VertexColorTexture;
+struct VertexNormal;
+struct VertexMesh;
+
+// Types whose bytes can go straight too disk. Trivially copyable covers plain structs, the
+// math and vertex types have hand written copy operators so they're listed by hand, their
+// layouts are checked in Serialize.cpp.
+// WordSize is what an endian swap flips in, 1 = bytes. 0 = mixed sizes, cant be swapped so
+// loading one from a swapped file fails, list it with SERIALIZE_BITWISE if it matters.
+template<typename T>
+struct IsBitwise
+{
+	static const bool value = std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value;
+	static const u32 WordSize = (std::is_arithmetic<T>::value || std::is_enum<T>::value) ? (u32)sizeof(T) : 0;
+};
+
+#define SERIALIZE_BITWISE(Type, Word) template<> struct IsBitwise<Type> { static const bool value = true; static const u32 WordSize = Word; };
+
+SERIALIZE_BITWISE(Vector2, 4)
+SERIALIZE_BITWISE(Vector3, 4)
+SERIALIZE_BITWISE(Vector4, 4)
+SERIALIZE_BITWISE(Color, 4)
+SERIALIZE_BITWISE(Quaternion, 4)
+SERIALIZE_BITWISE(Matrix4, 4)
+SERIALIZE_BITWISE(Vertex, 4)
+SERIALIZE_BITWISE(VertexTexture, 4)
+SERIALIZE_BITWISE(VertexColor, 4)
+SERIALIZE_BITWISE(VertexColorTexture, 4)
+SERIALIZE_BITWISE(VertexNormal, 4)
+SERIALIZE_BITWISE(VertexMesh, 4)
+
+class Archive
+{
+protected:
+	bool m_Loading	= false;
+	bool m_Failed	= false;
+	bool m_Swapped	= false;	// File is the other endian, set by SerializeHeader
+	u32	 m_Version	= 0;		// Set by SerializeHeader
+
+public:
+	Archive(bool loading) : m_Loading(loading) {}
+	virtual ~Archive() {}
+
+public:
+	bool IsLoading()const { return m_Loading; }
+	bool IsSaving()const { return m_Loading == false; }
+	bool Failed()const { return m_Failed; }
+	u32  Version()const { return m_Version; }
+	void SetVersion(u32 version) { m_Version = version; }
+	bool IsSwapped()const { return m_Swapped; }
+	void SetSwapped(bool swapped) { m_Swapped = swapped; }
+	// Marks the archive bad, returns false so it can end a Serialize
+	bool Fail() { m_Failed = true; return false; }
+
+	// Raw bytes in or out
+	bool SerializeBytes(void* data, u32 size);
+	// Bytes left too load, lets a bad count fail instead of allocating gigabytes
+	virtual u64 Remaining()const { return UINT64_MAX; }
+
+protected:
+	virtual bool Transfer(void* data, u32 size) = 0;
+};
+
+// Loads or saves depending on the file's mode
+class BinaryFileArchive : public Archive
+{
+private:
+	BinaryFile& m_File;
+	u64			m_Size = 0;
+
+public:
+	BinaryFileArchive(BinaryFile& file);
+
+public:
+	u64 Remaining()const override;
+
+protected:
+	bool Transfer(void* data, u32 size) override;
+};
+
+// Load only, pak entries cant be written too
+class PakFileArchive : public Archive
+{
+private:
+	PakFile& m_File;
+	u64		 m_Size = 0;
+
+public:
+	PakFileArchive(PakFile& file, u32 size);
+
+public:
+	u64 Remaining()const override;
+
+protected:
+	bool Transfer(void* data, u32 size) override;
+};
+
+class MemoryArchive : public Archive
+{
+private:
+	const Byte*		  m_Data	 = nullptr;
+	u64				  m_Size	 = 0;
+	u64				  m_Position = 0;
+	std::vector<u8>*  m_Output	 = nullptr;
+
+public:
+	// Loads from data, which has too outlive the archive (e.g. a PakSpan)
+	MemoryArchive(const Byte* data, u64 size);
+	// Saves by appending too output
+	MemoryArchive(std::vector<u8>& output);
+
+public:
+	u64 Remaining()const override;
+	// Load only, points at the next size bytes instead of copying them out. nullptr and
+	// Failed() when there arent that many left.
+	const Byte* View(u64 size);
+
+protected:
+	bool Transfer(void* data, u32 size) override;
+};
+
+bool SerializeHeader(Archive& archive, u32 magic, u32 latestVersion);
+bool Serialize(Archive& archive, std::string& value);
+template<typename T> bool Serialize(Archive& archive, std::vector<T>& values);
+
+// count elements already allocated on load
+template<typename T>
+typename std::enable_if<IsBitwise<T>::value, bool>::type SerializeArray(Archive& archive, T* values, u32 count)
+{
+	u64 bytes = (u64)count * sizeof(T);
+	if (bytes > UINT32_MAX)
+	{
+		return archive.Fail();
+	}
+
+	if (bytes == 0 || archive.SerializeBytes(values, (u32)bytes) == false)
+	{
+		return bytes == 0 && archive.Failed() == false;
+	}
+
+	if (archive.IsLoading() && archive.IsSwapped() && IsBitwise<T>::WordSize != 1)
+	{
+		if (IsBitwise<T>::WordSize == 0)
+		{
+			return archive.Fail();
+		}
+		SwapEndian(values, bytes / IsBitwise<T>::WordSize, IsBitwise<T>::WordSize);
+	}
+	return true;
+}
+
+template<typename T>
+typename std::enable_if<IsBitwise<T>::value, bool>::type Serialize(Archive& archive, T& value)
+{
+	return SerializeArray(archive, &value, 1);
+}
+
+template<typename T>
+typename std::enable_if<IsBitwise<T>::value == false, bool>::type SerializeArray(Archive& archive, T* values, u32 count)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (Serialize(archive, values[i]) == false)
+		{
+			return false;
+		}
+	}
+	return archive.Failed() == false;
+}
+
+template<typename T>
+bool Serialize(Archive& archive, std::vector<T>& values)
+{
+	u32 count = (u32)values.size();
+	if (Serialize(archive, count) == false)
+	{
+		return false;
+	}
+
+	if (archive.IsLoading())
+	{
+		// Every element is at least a byte, more than whats left means a bad file.
+		u64 minimum = IsBitwise<T>::value ? (u64)count * sizeof(T) : count;
+		if (minimum > archive.Remaining())
+		{
+			return archive.Fail();
+		}
+		values.resize(count);
+	}
+
+	return SerializeArray(archive, values.data(), count);
+}
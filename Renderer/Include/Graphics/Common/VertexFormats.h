@@ -94,16 +94,6 @@ struct VertexMesh
 	Color   m_Color;
 	Vector2 m_Texture;
 
-	VertexMesh& operator=(const VertexMesh& mesh)
-	{
-		m_Position = mesh.m_Position;
-		m_Normal = mesh.m_Normal;
-		m_Tangent = mesh.m_Tangent;
-		m_Color = mesh.m_Color;
-		m_Texture = mesh.m_Texture;
-		return *this;
-	}
-
 	bool operator==(const VertexMesh& vertex)const
 	{
 		return m_Position == vertex.m_Position && m_Normal == vertex.m_Normal &&
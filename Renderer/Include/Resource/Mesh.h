@@ -1,20 +1,9 @@
 #pragma once
 #include "Resource.h"
 #include "Graphics/GraphicsDevice.h"
+#include "Resource/MeshCooker.h"
 
-#define MESH_MAGIC 2646
-
-// Part of a mesh, i.e submesh should go it's own material
-// in the renderer component
-struct MeshPart
-{
-	u64 m_Start = 0;
-	u64 m_Count = 0;
-
-	MeshPart(u64 start = 0, u64 count = 0) :
-		m_Start(start), m_Count(count)
-	{}
-};
+class MappedFile;
 
 class Mesh : Resource
 {
@@ -30,6 +19,14 @@ protected:
 	std::vector<u32>					m_Indicies;
 	std::vector<Byte>					m_PackedMesh;
 
+	// Cooked meshes upload straight out of the file, these point into m_Mapping (or memory
+	// handed too LoadFromMemory) instead of the vectors above
+	std::shared_ptr<MappedFile>			m_Mapping;
+	const Byte*							m_VertexView = nullptr;
+	const Byte*							m_IndexView = nullptr;
+	Vector3								m_BoundsMin;
+	Vector3								m_BoundsMax;
+
 	u32									m_VertexCount = 0;
 	u32									m_IndexCount = 0;
 	IndexFormat							m_IndexFormat;
@@ -73,12 +70,18 @@ public:
 	void PackMesh();
 	void RecalculateNormals();
 	void RecalculateTangents();
+	void RecalculateBounds();
+	void OptimizeVertexCache();
+	void OptimizeOverdraw(float threshold = 1.05f);
+	void OptimizeVertexFetch();
 	void Upload(bool markNoLongerReadable, GraphicsDevice* device, CommandList cmd = 0);
 
 	//--Counts--
 	u32 VertexCount()const;
 	u32 IndexCount()const;
 	u32 MeshPartCount()const;
+	Vector3 BoundsMin()const;
+	Vector3 BoundsMax()const;
 
 	//--Internal--
 	std::shared_ptr<GraphicsResource> VertexBuffer();
@@ -86,8 +89,16 @@ public:
 
 	void Dispose();
 
+	// .obj is parsed, welded and has tangents generated. .mesh is cooked, it's mapped and
+	// uploads straight from the file, theres no cpu copy so its not readable.
 	static Mesh LoadFromFile(const std::string& filePath);
+	// A cooked .mesh already in memory e.g. a PakSpan, data has too outlive Upload
+	static Mesh LoadFromMemory(const Byte* data, u64 byteCount, const std::string& fileName);
+	// Packs and writes a cooked .mesh, LoadFromFile reads it back without the source
+	bool SaveToFile(const std::string& filePath);
 
 private:
 	static Mesh LoadFromObj(const std::string& filePath);
+	static Mesh LoadFromBinary(const std::string& filePath);
+	void SetCooked(CookedMesh& cooked);
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+//NOTE:
+/*
+	Device free half of Mesh, the cooked .mesh format and the obj import that feeds it. No
+	GraphicsDevice in here so PakBuilder can cook meshes offline and Mesh just maps the result.
+
+	Cooked .mesh (MESH_VERSION 2), written through Serialize so its host endian:
+		magic, version, vertex stride, index stride, bounds min, bounds max,
+		MeshPart[], VertexMesh[] exactly as the vertex buffer wants it, u32 indices[]
+
+	MeshView::Open checks the header and points straight at the two big arrays, so loading
+	is a mapping plus a few dozen bytes of parsing, nothing gets welded, packed or recomputed.
+	Version 1 kept Mesh's separate streams, those are refused and need recooking.
+*/
+#pragma once
+#include "System/Types.h"
+#include "Graphics/Common/VertexFormats.h"
+#include <string>
+#include <vector>
+
+#define MESH_MAGIC 2646
+#define MESH_VERSION 2
+
+class Archive;
+
+// Part of a mesh, i.e submesh should go it's own material
+// in the renderer component
+struct MeshPart
+{
+	u64 m_Start = 0;
+	u64 m_Count = 0;
+
+	MeshPart(u64 start = 0, u64 count = 0) :
+		m_Start(start), m_Count(count)
+	{}
+};
+
+// Cpu mesh already in the gpu layout, what a cooked .mesh holds
+struct CookedMesh
+{
+	std::vector<VertexMesh>	m_Vertices;
+	std::vector<u32>		m_Indices;
+	std::vector<MeshPart>	m_Parts;
+	Vector3					m_BoundsMin;
+	Vector3					m_BoundsMax;
+
+	void RecalculateBounds();
+};
+
+// Copies, and swaps a file cooked on the other endian. MeshView is the fast path.
+bool Serialize(Archive& archive, CookedMesh& mesh);
+
+// Zero copy view of a cooked .mesh, only valid while the memory it was opened on is
+struct MeshView
+{
+	const Byte*				m_Vertices		= nullptr;	// VertexMesh[], not aligned
+	const Byte*				m_Indices		= nullptr;	// u32[], not aligned
+	u32						m_VertexCount	= 0;
+	u32						m_IndexCount	= 0;
+	std::vector<MeshPart>	m_Parts;
+	Vector3					m_BoundsMin;
+	Vector3					m_BoundsMax;
+
+	// False if it isnt a cooked mesh, or was cooked on the other endian and has too be
+	// copied through Serialize instead
+	bool Open(const Byte* data, u64 size);
+};
+
+// One attribute out of an array of structs (or its own stream), stride in bytes
+template<typename T>
+struct StridedArray
+{
+	Byte*	m_Data		= nullptr;
+	u32		m_Stride	= sizeof(T);
+
+	StridedArray(T* data, u32 stride = sizeof(T)) : m_Data((Byte*)data), m_Stride(stride) {}
+	T& operator[](u64 index)const { return *(T*)(m_Data + index * m_Stride); }
+};
+
+namespace MeshCooker
+{
+	// Reads an obj, welds identical vertices, orders triangles for the vertex cache and
+	// overdraw then vertices for fetch, and generates tangents
+	bool ImportObj(const std::string& filePath, CookedMesh& mesh);
+	// Writes a cooked .mesh, bounds are recalculated first
+	bool Save(const std::string& filePath, CookedMesh& mesh);
+
+	// Per vertex tangents with handedness in w, smoothed over shared vertices. Strided so it
+	// runs on Mesh's separate streams and packed VertexMesh arrays alike.
+	void ComputeTangents(StridedArray<Vector3> positions, StridedArray<Vector3> normals, StridedArray<Vector2> uvs,
+		StridedArray<Vector4> tangents, u32 vertexCount, const u32* indices, const std::vector<MeshPart>& parts);
+};
@@ -0,0 +1,94 @@
+//NOTE:
+/*
+	Index buffer passes for the gpu's post transform vertex cache, all cpu only so the cook
+	can run them and PakBuilder can measure them without a device.
+
+	OptimizeVertexCache is Tom Forsyth's linear speed optimizer: triangles are emitted greedily
+	by a score that favours vertices already in a simulated LRU cache and vertices with few
+	triangles left (so no lonely triangles get stranded). It only reorders triangles, each
+	keeps its winding and the vertices are untouched.
+
+	AnalyzeVertexCache replays an index buffer through a FIFO or LRU cache and reports
+	ACMR (transforms per triangle, 0.5 is the best a big regular grid can do, 3 the worst)
+	and ATVR (transforms per vertex used, 1 is perfect).
+
+	OptimizeOverdraw (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+	Locality and Reducing Overdraw") cuts the cache ordered triangles into clusters wherever
+	the cache would be cold anyway, or where a cluster's ACMR is already within threshold of
+	its whole run's, then draws the clusters facing out from the middle of the mesh first.
+	Those tend too occlude the rest from any view. Run it after OptimizeVertexCache, ACMR
+	gets at most threshold times worse.
+
+	OptimizeVertexFetchRemap renumbers vertices in the order the indices first use them, so
+	the vertex fetch walks memory forwards. Unused vertices keep their order at the end. Run
+	it last, anything reordering triangles after it undoes it.
+
+	AnalyzeOverdraw rasterizes the mesh from the 6 axis directions with a depth test and back
+	face culling, overdraw is fragments that passed depth over pixels covered (1 is perfect).
+	Both overdraw functions take the winding that gives the mesh a positive volume as front
+	facing, so counter clockwise objs and clockwise d3d meshes both work.
+	AnalyzeVertexFetch feeds each transform (FIFO 16 miss) through a small LRU of 64 byte
+	lines, overfetch is bytes read over the bytes of every used vertex (1 is perfect).
+*/
+#pragma once
+#include "System/Types.h"
+#include "Resource/MeshCooker.h"
+
+enum class CacheModel
+{
+	Fifo,	// What most real hardware does
+	Lru		// What the optimizer scores against
+};
+
+struct VertexCacheStats
+{
+	u64		m_Transforms	= 0;	// Cache misses, i.e vertex shader runs
+	float	m_Acmr			= 0.0f;
+	float	m_Atvr			= 0.0f;
+};
+
+struct VertexFetchStats
+{
+	u64		m_BytesFetched	= 0;
+	float	m_Overfetch		= 0.0f;
+};
+
+struct OverdrawStats
+{
+	u64		m_Covered		= 0;	// Pixels, summed over every view
+	u64		m_Shaded		= 0;	// Fragments that passed the depth test
+	float	m_Overdraw		= 0.0f;
+};
+
+namespace MeshOptimizer
+{
+	// Reorders the triangles of indices[0 .. indexCount), destination can be indices. Any
+	// trailing indices that dont make a whole triangle are copied as is.
+	void OptimizeVertexCache(u32* destination, const u32* indices, u64 indexCount, u32 vertexCount);
+	// Same again for each part on its own, so parts keep their ranges
+	void OptimizeVertexCache(u32* indices, u32 vertexCount, const std::vector<MeshPart>& parts);
+
+	VertexCacheStats AnalyzeVertexCache(const u32* indices, u64 indexCount, u32 vertexCount, u32 cacheSize = 16, CacheModel model = CacheModel::Fifo);
+
+	// Reorders clusters of triangles, destination can be indices
+	void OptimizeOverdraw(u32* destination, const u32* indices, u64 indexCount, StridedArray<Vector3> positions, u32 vertexCount, float threshold = 1.05f);
+	void OptimizeOverdraw(u32* indices, StridedArray<Vector3> positions, u32 vertexCount, const std::vector<MeshPart>& parts, float threshold = 1.05f);
+	OverdrawStats AnalyzeOverdraw(const u32* indices, u64 indexCount, StridedArray<Vector3> positions, u32 vertexCount);
+
+	// remap[old] = new for every vertex, returns how many the indices use
+	u32 OptimizeVertexFetchRemap(u32* remap, const u32* indices, u64 indexCount, u32 vertexCount);
+	void RemapIndices(u32* indices, u64 indexCount, const u32* remap);
+	VertexFetchStats AnalyzeVertexFetch(const u32* indices, u64 indexCount, u32 vertexCount, u32 vertexSize);
+
+	// One stream (or array of structs) into the remap's order, vertices.size() entries in remap
+	template<typename T>
+	void RemapVertices(std::vector<T>& vertices, const u32* remap)
+	{
+		std::vector<T> remapped(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			remapped[remap[i]] = vertices[i];
+		}
+		vertices.swap(remapped);
+	}
+};
@@ -0,0 +1,55 @@
+//NOTE:
+/*
+	Multi threaded obj reader, gives back exactly what tinyobj::LoadObj would for the parts
+	MeshCooker uses (attributes, triangulated corners per shape) so cooked meshes dont change.
+	Tests/TestObj.cpp holds it too that on MaterialBall and a generated multi MB obj.
+
+	The text is cut into line aligned chunks and every chunk is parsed on its own thread
+	into local arrays, relative (negative) indices are resolved against the chunk's own
+	counts and patched later. Prefix sums of each chunk's v/vt/vn/corner counts then give
+	every chunk its place in the merged arrays, which are filled in parallel again.
+
+	Anything whose tinyobj result depends on more than one line isnt copied here, faces
+	over 4 corners (ear clipping), degenerate faces, lines/points and forward references.
+	A file using any of them is handed too tinyobj instead, slower but still identical.
+*/
+#pragma once
+#include "System/Types.h"
+#include "Resource/MeshCooker.h"
+#include <string>
+#include <vector>
+
+// One face corner, -1 where the obj didnt give a texcoord or normal
+struct ObjIndex
+{
+	int m_Vertex	= -1;
+	int m_TexCoord	= -1;
+	int m_Normal	= -1;
+};
+
+struct ObjData
+{
+	std::vector<float>		m_Positions;	// xyz
+	std::vector<float>		m_TexCoords;	// uv
+	std::vector<float>		m_Normals;		// xyz
+	std::vector<float>		m_Colors;		// rgb, white for any v without a colour
+	std::vector<ObjIndex>	m_Indices;		// Triangles, shapes back too back
+	std::vector<MeshPart>	m_Shapes;		// Ranges of m_Indices, one per o/g with faces
+};
+
+enum class ObjResult
+{
+	Ok,
+	Unsupported,	// Valid obj that needs tinyobj, see above
+	Error			// Bad index, tinyobj fails these too
+};
+
+namespace ObjParser
+{
+	// threadCount 0 = one per hardware thread, this thread always helps
+	ObjResult Parse(const char* text, size_t size, ObjData& obj, u32 threadCount = 0);
+	// Maps the file and parses it, falls back too tinyobj for Unsupported files
+	bool Load(const std::string& filePath, ObjData& obj, u32 threadCount = 0);
+	// The old single threaded path, kept as the reference and the fallback
+	bool LoadTinyObj(const std::string& filePath, ObjData& obj);
+};
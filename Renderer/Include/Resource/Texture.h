@@ -11,8 +11,11 @@
 #pragma once
 #include "Graphics/GraphicsDevice.h"
 #include "Resource.h"
+#include "Resource/TextureCooker.h"
 #include <vector>
 
+class Archive;
+
 // Meta data for mips
 struct TextureLevel
 {
@@ -76,6 +79,12 @@ public:
 	// Submits data to low-level GPU interface if required.
 	void Upload(CommandList cmd, bool clearCPU = true);
 	static std::shared_ptr<Texture> LoadFromFile(const std::string& fileName);
+	// Decodes a jpg/png/bmp/tga already in memory, e.g. a PakSpan straight out of a mapped
+	// archive so the file is never copied. fileName is only used for the path and _Normal etc.
+	static std::shared_ptr<Texture> LoadFromMemory(const Byte* data, u32 byteCount, const std::string& fileName);
+	// Cooked .texture, the desc and every mip as is so loading is just a read
+	bool SaveToFile(const std::string& fileName);
+	friend bool Serialize(Archive& archive, Texture& texture);
 	void Release();
 
 	std::shared_ptr<TextureResource>	GetTextureResource()const;
@@ -83,6 +92,10 @@ public:
 
 protected:
 	static  std::shared_ptr<Texture> LoadFromSource(std::string fileName);
+	static  std::shared_ptr<Texture> LoadFromBinary(const std::string& fileName);
+	static  std::shared_ptr<Texture> CreateFromPixels(Byte* pixels, int width, int height, const std::string& fileName);
 	void GenerateLookUpTable();
 
-};
\ No newline at end of file
+};
+
+bool Serialize(Archive& archive, Texture& texture);
\ No newline at end of file
@@ -0,0 +1,29 @@
+//NOTE:
+/*
+	Device free half of the cooked .texture, so PakBuilder and the tests can read and write
+	one without a GraphicsDevice. Texture's own Serialize shares the header and then reads
+	the pixels straight into the memory CreateTexture gave it.
+
+	Cooked .texture (TEXTURE_VERSION 1), written through Serialize so its host endian:
+		magic, version, the ResourceDesc fields CreateTexture needs, byte count, every mip as is
+*/
+#pragma once
+#include "System/Types.h"
+#include "Graphics/Common/ResourceDesc.h"
+#include <vector>
+
+#define TEXTURE_MAGIC 0x58455454 // "TTEX"
+#define TEXTURE_VERSION 1
+
+class Archive;
+
+// Cpu copy of a cooked .texture
+struct CookedTexture
+{
+	ResourceDesc		m_Desc;
+	std::vector<Byte>	m_Data;
+};
+
+// Magic, version, desc and byte count, everything before the pixels
+bool SerializeTextureHeader(Archive& archive, ResourceDesc& desc, u32& byteCount);
+bool Serialize(Archive& archive, CookedTexture& texture);
@@ -0,0 +1,57 @@
+//NOTE:
+/*
+	Merges identical vertices while an importer builds its index buffer. Vertices are plain
+	bytes of any fixed size, so obj, gltf or procedural meshes can all share it.
+
+	Flat open addressing table (linear probing, kept at most half full) of indices into the
+	welded vertices, with each vertex's xxHash64 kept alongside. A matching hash is only a
+	hint, the bytes are always compared before two vertices merge.
+
+	With an epsilon every float is snapped too the nearest multiple of it before hashing and
+	comparing, so values that round the same way merge (the first one seen is kept). Two
+	values either side of a rounding edge can still stay apart, its a grid not a distance.
+*/
+#pragma once
+#include "System/Types.h"
+#include <vector>
+
+class VertexWelder
+{
+public:
+	// Hashes a key of size bytes, xxHash64 unless a test swaps in a weak one too force collisions
+	typedef u64 (*HashFunction)(const Byte* key, u32 size);
+
+private:
+	HashFunction		m_Hash			= nullptr;
+	u32					m_VertexSize	= 0;
+	float				m_Epsilon		= 0.0f;
+	u32					m_Count			= 0;
+	u64					m_Mask			= 0;
+	std::vector<u32>	m_Table;		// Vertex index + 1, 0 is empty
+	std::vector<u64>	m_Hashes;		// Per welded vertex, so growing doesnt rehash the bytes
+	std::vector<Byte>	m_Vertices;		// Welded vertices, as first added
+	std::vector<Byte>	m_Keys;			// Snapped copies of m_Vertices, epsilon only
+	std::vector<Byte>	m_Scratch;		// Key of the vertex being added, epsilon only
+
+public:
+	// vertexSize in bytes, a multiple of 4 when welding with an epsilon. expectedCount
+	// reserves room for that many unique vertices up front.
+	VertexWelder(u32 vertexSize, u64 expectedCount = 0, float epsilon = 0.0f);
+
+public:
+	// Index of the welded vertex equal too this one, adding it if its new
+	u32 Add(const void* vertex);
+	void Reserve(u64 count);
+	void Clear();
+	// Only before the first Add
+	void SetHashFunction(HashFunction hash);
+
+	u32 Count()const { return m_Count; }
+	u32 VertexSize()const { return m_VertexSize; }
+	const Byte* Vertices()const { return m_Vertices.data(); }
+
+private:
+	const Byte* Key(const void* vertex);
+	const Byte* KeyAt(u32 index)const;
+	void Rehash(u64 capacity);
+};
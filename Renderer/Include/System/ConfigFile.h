@@ -2,17 +2,22 @@
 /*
 	Common implementation, in this case its
 	a modified ogre style system. Seen it in unity a few times though...
+
+	Open parses through TextReader so lines are views into the file, only the keys and
+	values that end up in the maps are ever copied. The maps use std::less<> so they can
+	be searched with a string_view too.
 */
 #pragma once
 #include <string>
+#include <string_view>
 #include <map>
 
-typedef std::map<std::string, std::string> Settings;
-typedef std::map<std::string, std::string>::iterator SettingsIterator;
-typedef std::map<std::string, std::string>::const_iterator SettingsIteratorConst;
-typedef std::map<std::string, Settings> Section;
-typedef std::map<std::string, Settings>::iterator SectionIterator;
-typedef std::map<std::string, Settings>::const_iterator SectionIteratorConst;
+typedef std::map<std::string, std::string, std::less<>> Settings;
+typedef Settings::iterator SettingsIterator;
+typedef Settings::const_iterator SettingsIteratorConst;
+typedef std::map<std::string, Settings, std::less<>> Section;
+typedef Section::iterator SectionIterator;
+typedef Section::const_iterator SectionIteratorConst;
 
 class ConfigFile
 {
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include "System/Types.h"
 
 //Ref: https://github.com/microsoft/DirectXTK12/blob/master/Src/EffectPipelineStateDescription.cpp
@@ -7,7 +8,8 @@
 namespace Hash32
 {
 	// 0x04C11DB7 is the official polynomial used by PKZip, WinZip and Ethernet
-	static const unsigned int s_crc32[] =
+	// constexpr so the compile time hash below can use the same table
+	constexpr unsigned int s_crc32[] =
 	{
 		0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
 		0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
@@ -56,4 +58,35 @@ namespace Hash32
 
 
 	unsigned int ComputeHash(const Byte* data, unsigned int size);
-};
\ No newline at end of file
+
+	// Same CRC32 as ComputeHash, usable at compile time for literal asset paths
+	constexpr unsigned int ComputeHashConst(const char* data, size_t size)
+	{
+		unsigned int crc = 0xFFFFFFFF;
+		for (size_t j = 0; j < size; ++j)
+		{
+			crc = (crc >> 8) ^ s_crc32[(crc & 0xff) ^ (uint8_t)data[j]];
+		}
+
+		return crc ^ 0xFFFFFFFF;
+	}
+
+	// Forces evaluation at compile time, a constexpr call on its own only might be
+	template<unsigned int Hash>
+	struct Constant
+	{
+		static constexpr unsigned int Value = Hash;
+	};
+};
+
+// "Shaders\\VertexColor.shader"_hash, pak paths hashed by the compiler instead of per lookup.
+// Use in a constexpr variable or HASH32() when it has to be guaranteed compile time.
+constexpr unsigned int operator"" _hash(const char* data, size_t size)
+{
+	return Hash32::ComputeHashConst(data, size);
+}
+
+#define HASH32(path) (Hash32::Constant<Hash32::ComputeHashConst(path, sizeof(path) - 1)>::Value)
+
+// Standard CRC32 check value, catches the table or the loop drifting from ComputeHash.
+static_assert("123456789"_hash == 0xCBF43926, "Compile time CRC32 doesnt match the runtime one");
\ No newline at end of file
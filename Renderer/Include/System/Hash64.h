@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+#include "System/Types.h"
+
+//Ref: https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+
+namespace Hash64
+{
+	// xxHash64, used where 32bits would collide, e.g. content hashes over a whole content folder
+	u64 ComputeHash(const Byte* data, u64 size, u64 seed = 0);
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace StringUtil
@@ -12,4 +13,7 @@ namespace StringUtil
 
 	// Creates buffer on heap, your responsible for deleting it!
 	std::vector<std::string> Split(const std::string& text, const char* deliminater);
+
+	// View into text, nothing is copied
+	std::string_view TrimEnd(std::string_view text);
 };
\ No newline at end of file
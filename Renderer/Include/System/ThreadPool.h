@@ -0,0 +1,39 @@
+//NOTE:
+/*
+	Plain fixed size worker pool. ParallelFor is the main use, the calling thread works
+	through the indices alongside the workers so it never sits idle waiting for them and
+	nested/concurrent ParallelFor calls from several loader threads cant deadlock.
+*/
+#pragma once
+#include "System/Types.h"
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class ThreadPool
+{
+private:
+	std::vector<std::thread>			m_Threads;
+	std::deque<std::function<void()>>	m_Tasks;
+	std::mutex							m_Lock;
+	std::condition_variable				m_Signal;
+	bool								m_Running = false;
+
+public:
+	// 0 = one per hardware thread
+	ThreadPool(u32 threadCount = 0);
+	~ThreadPool();
+
+public:
+	u32 ThreadCount()const { return (u32)m_Threads.size(); }
+	void Submit(std::function<void()> task);
+	// Runs task(0 .. count - 1) across the pool and this thread, returns once every index has
+	// run. False if any task returned false, the rest still run.
+	bool ParallelFor(u32 count, const std::function<bool(u32 index)>& task);
+
+private:
+	void WorkerThread();
+};
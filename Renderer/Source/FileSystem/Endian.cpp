@@ -0,0 +1,187 @@
+#include "FileSystem/Endian.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define ENDIAN_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		// msvc lets any function use any intrinsic
+		#define ENDIAN_TARGET(isa)
+	#else
+		#define ENDIAN_TARGET(isa) __attribute__((target(isa)))
+	#endif
+#endif
+
+template<typename T, T (*Swap)(T)>
+static void SwapScalar(Byte* data, u64 count)
+{
+	// memcpy in and out, the arrays come straight off disk so may not be aligned
+	for (u64 i = 0; i < count; ++i)
+	{
+		T value;
+		memcpy(&value, data + i * sizeof(T), sizeof(T));
+		value = Swap(value);
+		memcpy(data + i * sizeof(T), &value, sizeof(T));
+	}
+}
+
+static void SwapScalar(Byte* data, u64 count, u32 wordSize)
+{
+	switch (wordSize)
+	{
+		case 2: SwapScalar<u16, ByteSwap16>(data, count); break;
+		case 4: SwapScalar<u32, ByteSwap32>(data, count); break;
+		case 8: SwapScalar<u64, ByteSwap64>(data, count); break;
+		default: break;
+	}
+}
+
+#ifdef ENDIAN_X86
+
+// pshufb masks, each lane picks its bytes back too front within a word
+static const char s_Shuffle16[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+static const char s_Shuffle32[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+static const char s_Shuffle64[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+
+static const char* ShuffleMask(u32 wordSize)
+{
+	return wordSize == 2 ? s_Shuffle16 : (wordSize == 4 ? s_Shuffle32 : s_Shuffle64);
+}
+
+ENDIAN_TARGET("ssse3")
+static void SwapSSSE3(Byte* data, u64 count, u32 wordSize)
+{
+	const __m128i mask = _mm_loadu_si128((const __m128i*)ShuffleMask(wordSize));
+	u64 bytes = count * wordSize;
+	u64 i = 0;
+
+	// 4 registers a loop so the loads run ahead of the shuffles
+	for (; i + 64 <= bytes; i += 64)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(data + i + 16));
+		__m128i c = _mm_loadu_si128((const __m128i*)(data + i + 32));
+		__m128i d = _mm_loadu_si128((const __m128i*)(data + i + 48));
+		_mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi8(a, mask));
+		_mm_storeu_si128((__m128i*)(data + i + 16), _mm_shuffle_epi8(b, mask));
+		_mm_storeu_si128((__m128i*)(data + i + 32), _mm_shuffle_epi8(c, mask));
+		_mm_storeu_si128((__m128i*)(data + i + 48), _mm_shuffle_epi8(d, mask));
+	}
+
+	for (; i + 16 <= bytes; i += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(data + i));
+		_mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi8(a, mask));
+	}
+
+	SwapScalar(data + i, (bytes - i) / wordSize, wordSize);
+}
+
+ENDIAN_TARGET("avx2")
+static void SwapAVX2(Byte* data, u64 count, u32 wordSize)
+{
+	// vpshufb works per 128 bit lane, so the same mask goes in both halves
+	const __m128i half = _mm_loadu_si128((const __m128i*)ShuffleMask(wordSize));
+	const __m256i mask = _mm256_broadcastsi128_si256(half);
+	u64 bytes = count * wordSize;
+	u64 i = 0;
+
+	for (; i + 128 <= bytes; i += 128)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(data + i + 32));
+		__m256i c = _mm256_loadu_si256((const __m256i*)(data + i + 64));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(data + i + 96));
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_shuffle_epi8(a, mask));
+		_mm256_storeu_si256((__m256i*)(data + i + 32), _mm256_shuffle_epi8(b, mask));
+		_mm256_storeu_si256((__m256i*)(data + i + 64), _mm256_shuffle_epi8(c, mask));
+		_mm256_storeu_si256((__m256i*)(data + i + 96), _mm256_shuffle_epi8(d, mask));
+	}
+
+	for (; i + 32 <= bytes; i += 32)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(data + i));
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_shuffle_epi8(a, mask));
+	}
+
+	// Avoid the AVX/SSE transition penalty before whatever runs next
+	_mm256_zeroupper();
+	SwapScalar(data + i, (bytes - i) / wordSize, wordSize);
+}
+
+static SwapKernel DetectSwapKernel()
+{
+#ifdef _MSC_VER
+	int info[4] = {};
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool ssse3 = (info[2] & (1 << 9)) != 0;
+	bool osAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+	bool avx2 = false;
+	if (maxLeaf >= 7 && osAVX)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = (info[1] & (1 << 5)) != 0;
+	}
+#else
+	__builtin_cpu_init();
+	bool ssse3 = __builtin_cpu_supports("ssse3");
+	bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+	if (avx2)
+	{
+		return SwapKernel::AVX2;
+	}
+	return ssse3 ? SwapKernel::SSSE3 : SwapKernel::Scalar;
+}
+
+#endif // ENDIAN_X86
+
+SwapKernel BestSwapKernel()
+{
+#ifdef ENDIAN_X86
+	static const SwapKernel s_Best = DetectSwapKernel();
+	return s_Best;
+#else
+	return SwapKernel::Scalar;
+#endif
+}
+
+const char* SwapKernelName(SwapKernel kernel)
+{
+	switch (kernel)
+	{
+		case SwapKernel::Scalar: return "Scalar";
+		case SwapKernel::SSSE3: return "SSSE3";
+		case SwapKernel::AVX2: return "AVX2";
+		default: return SwapKernelName(BestSwapKernel());
+	}
+}
+
+void SwapEndian(void* data, u64 count, u32 wordSize, SwapKernel kernel)
+{
+	if (data == nullptr || count == 0 || (wordSize != 2 && wordSize != 4 && wordSize != 8))
+	{
+		return;
+	}
+
+	SwapKernel best = BestSwapKernel();
+	if (kernel == SwapKernel::Best || (u32)kernel > (u32)best)
+	{
+		kernel = best;
+	}
+
+	switch (kernel)
+	{
+#ifdef ENDIAN_X86
+		case SwapKernel::AVX2: SwapAVX2((Byte*)data, count, wordSize); break;
+		case SwapKernel::SSSE3: SwapSSSE3((Byte*)data, count, wordSize); break;
+#endif
+		default: SwapScalar((Byte*)data, count, wordSize); break;
+	}
+}
@@ -1,4 +1,17 @@
 #include "FileSystem/File/BinaryFile.h"
+#include <cstring>
+#include <algorithm>
+
+#ifdef WIN32
+	// Just get core stuff no bloat please.
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+	#include <io.h>
+#else
+	#include <unistd.h>
+	#include <limits.h>
+	#include <sys/uio.h>
+#endif
 
 BinaryFile::BinaryFile(const std::string& path, FileMode mode) : BaseFile(path, mode, FileType::Binary)
 {
@@ -7,6 +20,8 @@ BinaryFile::BinaryFile(const std::string& path, FileMode mode) : BaseFile(path,
 
 bool BinaryFile::Open(const std::string& path, FileMode mode)
 {
+	Close();
+
 	m_Path = path;
 	m_Mode = mode;
 
@@ -36,10 +51,14 @@ void BinaryFile::Close()
 {
 	if (m_File)
 	{
+		Flush();
 		fclose(m_File);
+		m_File = nullptr;
 		m_FilePosition = 0;
 	}
 
+	// Dropped if the flush failed, theres no file left too write it too
+	m_WriteUsed = 0;
 	m_Open = false;
 }
 
@@ -62,8 +81,8 @@ bool BinaryFile::ReadFrom(Byte* data, u32 origin, u32 count)
 {
 	if (m_File && m_Mode == FileMode::Read)
 	{
-		Seek(count, origin);
-		bool result = fread(data, sizeof(Byte), count, m_File);
+		Seek(SEEK_SET, origin);
+		bool result = fread(data, sizeof(Byte), count, m_File) >= count;
 		if (result)
 		{
 			m_FilePosition = ftell(m_File);
@@ -73,10 +92,70 @@ bool BinaryFile::ReadFrom(Byte* data, u32 origin, u32 count)
 	return false;
 }
 
+bool BinaryFile::ReadAt(Byte* data, u64 offset, u32 count) const
+{
+	if (m_File == nullptr || m_Mode != FileMode::Read)
+	{
+		return false;
+	}
+
+#ifdef WIN32
+	// An explicit offset makes ReadFile positional, the CRT's FILE cursor is never used.
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(m_File));
+	while (count > 0)
+	{
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+		DWORD read = 0;
+		if (ReadFile(handle, data, count, &read, &overlapped) == FALSE || read == 0)
+		{
+			return false;
+		}
+
+		data += read;
+		offset += read;
+		count -= read;
+	}
+	return true;
+#else
+	int descriptor = fileno(m_File);
+	while (count > 0)
+	{
+		ssize_t read = pread(descriptor, data, count, (off_t)offset);
+		if (read <= 0)
+		{
+			return false;
+		}
+
+		data += read;
+		offset += (u64)read;
+		count -= (u32)read;
+	}
+	return true;
+#endif
+}
+
 bool BinaryFile::Write(const Byte* data, u32 count)
 {
 	if (m_File && m_Mode == FileMode::Write)
 	{
+		if (m_WriteBuffer.empty() == false)
+		{
+			if ((u64)m_WriteUsed + count <= m_WriteBuffer.size())
+			{
+				memcpy(m_WriteBuffer.data() + m_WriteUsed, data, count);
+				m_WriteUsed += count;
+				m_FilePosition += count;
+				return true;
+			}
+
+			// Doesnt fit, send the pending bytes and this together rather than copy it through.
+			FileSpan span = { data, count };
+			return WriteGather(&span, 1);
+		}
+
 		bool result = fwrite(data, sizeof(Byte), count, m_File) >= count;
 		if (result)
 		{
@@ -88,13 +167,131 @@ bool BinaryFile::Write(const Byte* data, u32 count)
 	return false;
 }
 
+bool BinaryFile::SetWriteBuffer(u32 size)
+{
+	if (Flush() == false)
+	{
+		return false;
+	}
+
+	m_WriteBuffer.resize(size);
+	m_WriteBuffer.shrink_to_fit();
+	return true;
+}
+
+bool BinaryFile::WriteGather(const FileSpan* spans, u32 count)
+{
+	if (m_File == nullptr || m_Mode != FileMode::Write)
+	{
+		return false;
+	}
+
+	// Anything fwrite is holding has too land first, the rest goes straight too the OS.
+	if (fflush(m_File) != 0)
+	{
+		return false;
+	}
+
+	u64 total = 0;
+	for (u32 i = 0; i < count; ++i)
+	{
+		total += spans[i].m_Size;
+	}
+
+#ifdef WIN32
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(m_File));
+	auto writeAll = [handle](const Byte* data, u32 size)
+	{
+		while (size > 0)
+		{
+			DWORD written = 0;
+			if (WriteFile(handle, data, size, &written, nullptr) == FALSE || written == 0)
+			{
+				return false;
+			}
+			data += written;
+			size -= written;
+		}
+		return true;
+	};
+
+	if (writeAll(m_WriteBuffer.data(), m_WriteUsed) == false)
+	{
+		return false;
+	}
+	m_WriteUsed = 0;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (writeAll(spans[i].m_Data, spans[i].m_Size) == false)
+		{
+			return false;
+		}
+	}
+#else
+	std::vector<iovec> vectors;
+	vectors.reserve(count + 1);
+	if (m_WriteUsed > 0)
+	{
+		vectors.push_back({ m_WriteBuffer.data(), m_WriteUsed });
+	}
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (spans[i].m_Size > 0)
+		{
+			vectors.push_back({ (void*)spans[i].m_Data, spans[i].m_Size });
+		}
+	}
+
+	// writev can stop short, skip whatever made it and go again
+	int descriptor = fileno(m_File);
+	size_t next = 0;
+	while (next < vectors.size())
+	{
+		int batch = (int)std::min(vectors.size() - next, (size_t)IOV_MAX);
+		ssize_t written = writev(descriptor, &vectors[next], batch);
+		if (written <= 0)
+		{
+			return false;
+		}
+
+		while (next < vectors.size() && (size_t)written >= vectors[next].iov_len)
+		{
+			written -= vectors[next].iov_len;
+			++next;
+		}
+		if (written > 0)
+		{
+			vectors[next].iov_base = (Byte*)vectors[next].iov_base + written;
+			vectors[next].iov_len -= written;
+		}
+	}
+	m_WriteUsed = 0;
+#endif
+
+	m_FilePosition += (int)total;
+	return true;
+}
+
+bool BinaryFile::Flush()
+{
+	if (m_File == nullptr || m_Mode != FileMode::Write)
+	{
+		return m_File != nullptr;
+	}
+
+	if (m_WriteUsed > 0 && WriteGather(nullptr, 0) == false)
+	{
+		return false;
+	}
+	return fflush(m_File) == 0;
+}
+
 bool BinaryFile::WriteByte(const Byte& value)
 {
 	if (m_Mode != FileMode::Read)
 	{
-		fwrite(&value, 1, sizeof(Byte), m_File);
-		m_FilePosition += 1;
-		return true;
+		return Write(&value, sizeof(Byte));
 	}
 
 	return false;
@@ -105,13 +302,11 @@ bool BinaryFile::WriteWord(const Word& value)
 {
 	if (m_Mode != FileMode::Read)
 	{
+		Word flipped = m_Endian == Endian::Big ? ByteSwap16(value) : value;
 		Byte bytes[2];
-		bytes[0] = value & 0xFF;
-		bytes[1] = (value >> 8) & 0xFF;
-
-		fwrite(bytes, 1, sizeof(bytes), m_File);
-		m_FilePosition += 2;
-		return true;
+		bytes[0] = flipped & 0xFF;
+		bytes[1] = (flipped >> 8) & 0xFF;
+		return Write(bytes, sizeof(bytes));
 	}
 
 	return false;
@@ -121,14 +316,13 @@ bool BinaryFile::WriteDword(const Dword& value)
 {
 	if (m_Mode != FileMode::Read)
 	{
+		Dword flipped = m_Endian == Endian::Big ? ByteSwap32(value) : value;
 		Byte bytes[4];
-		bytes[0] = value & 0xFF;
-		bytes[1] = (value >> 8) & 0xFF;
-		bytes[2] = (value >> 16) & 0xFF;
-		bytes[3] = (value >> 24) & 0xFF;
-		fwrite(bytes, 1, sizeof(bytes), m_File);
-		m_FilePosition += 4;
-		return true;
+		bytes[0] = flipped & 0xFF;
+		bytes[1] = (flipped >> 8) & 0xFF;
+		bytes[2] = (flipped >> 16) & 0xFF;
+		bytes[3] = (flipped >> 24) & 0xFF;
+		return Write(bytes, sizeof(bytes));
 	}
 
 	return false;
@@ -136,22 +330,15 @@ bool BinaryFile::WriteDword(const Dword& value)
 
 //-----------------------------------------------------------------------------
 // I had issues writing floats for some reason, so this hack was invented.
+// Goes through WriteDword now so it lands in the file's endian like the rest.
 //-----------------------------------------------------------------------------
 bool BinaryFile::WriteFloat(const float& value)
 {
-	if (m_File && m_Mode != FileMode::Write)
+	if (m_File && m_Mode != FileMode::Read)
 	{
-		//Type pruning hack?
-		union u
-		{
-			float f;
-			Byte data[4];
-		}bytes;
-		bytes.f = value;
-
-		fwrite(&bytes, sizeof(u), sizeof(bytes), m_File);
-		m_FilePosition += 4;
-		return true;
+		Dword bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return WriteDword(bits);
 	}
 
 	return false;
@@ -177,7 +364,8 @@ Word BinaryFile::ReadWord()
 		Byte byte[2];
 		fread(byte, 1, sizeof(byte), m_File);
 		m_FilePosition += 2;
-		return (byte[0] | byte[1] << 8);
+		Word value = (Word)(byte[0] | byte[1] << 8);
+		return m_Endian == Endian::Big ? ByteSwap16(value) : value;
 	}
 
 	return Byte();
@@ -190,7 +378,8 @@ Dword BinaryFile::ReadDword()
 		Byte byte[4];
 		fread(byte, 1, sizeof(byte), m_File);
 		m_FilePosition += 4;
-		return (byte[0] | byte[1] << 8 | byte[2] << 16 | byte[3] << 24);
+		Dword value = (Dword)(byte[0] | byte[1] << 8 | byte[2] << 16 | byte[3] << 24);
+		return m_Endian == Endian::Big ? ByteSwap32(value) : value;
 	}
 
 	return Byte();
@@ -203,12 +392,51 @@ float BinaryFile::ReadFloat()
 		float value;
 		fread(&value, 1, sizeof(value), m_File);
 		m_FilePosition += 4;
+		if (m_Endian != GetSystemEndian())
+		{
+			SwapEndian(&value, 1, sizeof(value));
+		}
 		return value;
 	}
 
 	return float();
 }
 
+bool BinaryFile::ReadArray(u16* data, u32 count)
+{
+	return ReadWords(data, count, sizeof(u16));
+}
+
+bool BinaryFile::ReadArray(u32* data, u32 count)
+{
+	return ReadWords(data, count, sizeof(u32));
+}
+
+bool BinaryFile::ReadArray(u64* data, u32 count)
+{
+	return ReadWords(data, count, sizeof(u64));
+}
+
+bool BinaryFile::ReadArray(float* data, u32 count)
+{
+	return ReadWords(data, count, sizeof(float));
+}
+
+bool BinaryFile::ReadWords(void* data, u32 count, u32 wordSize)
+{
+	u64 bytes = (u64)count * wordSize;
+	if (bytes > UINT32_MAX || Read((Byte*)data, (u32)bytes) == false)
+	{
+		return false;
+	}
+
+	if (m_Endian != GetSystemEndian())
+	{
+		SwapEndian(data, count, wordSize);
+	}
+	return true;
+}
+
 bool BinaryFile::WriteString(const std::string& string)
 {
 	if (!string.empty())
@@ -234,20 +462,23 @@ std::string BinaryFile::ReadString()
 	return string;
 }
 
-void BinaryFile::Seek(u32 offset, u32 origin)
+void BinaryFile::Seek(u32 origin, u32 offset)
 {
+	Flush();
 	fseek(m_File, offset, origin);
 	m_FilePosition = ftell(m_File);
 }
 
 void BinaryFile::SeekStart()
 {
+	Flush();
 	fseek(m_File, 0, SEEK_SET);
 	m_FilePosition = ftell(m_File);
 }
 
 void BinaryFile::SeekEnd()
 {
+	Flush();
 	fseek(m_File, 0, SEEK_END);
 	m_FilePosition = ftell(m_File);
 }
@@ -0,0 +1,89 @@
+#include "FileSystem/File/MappedFile.h"
+#include "System/StringUtil.h"
+
+#ifdef WIN32
+	// Just get core stuff no bloat please.
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+{
+	Open(path);
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+	m_Path = path;
+
+#ifdef WIN32
+	HANDLE file = CreateFile(StringUtil::Widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (GetFileSizeEx(file, &size) == FALSE || size.QuadPart == 0)
+	{
+		// Cant map an empty file, let the caller fallback.
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_FileHandle	= file;
+	m_MapHandle		= mapping;
+	m_Data			= (const Byte*)view;
+	m_Size			= (u64)size.QuadPart;
+	return true;
+#endif // WIN32
+	// Do Switch, Xbox, Psx so on...
+
+	return false;
+}
+
+void MappedFile::Close()
+{
+#ifdef WIN32
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+
+	if (m_MapHandle)
+	{
+		CloseHandle((HANDLE)m_MapHandle);
+	}
+
+	if (m_FileHandle)
+	{
+		CloseHandle((HANDLE)m_FileHandle);
+	}
+#endif // WIN32
+
+	m_Data			= nullptr;
+	m_Size			= 0;
+	m_MapHandle		= nullptr;
+	m_FileHandle	= nullptr;
+}
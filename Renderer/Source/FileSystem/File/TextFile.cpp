@@ -82,21 +82,33 @@ bool TextFile::ReadLine(std::string& line, bool removeTralingSpace)
 {
 	if (m_Mode == FileMode::Read)
 	{
+		// fgets stops when the buffer fills, keep going till the newline so long lines stay whole
 		char buffer[1024];
-		if (fgets(buffer, 1024, m_File) != NULL)
+		line.clear();
+		while (fgets(buffer, 1024, m_File) != NULL)
 		{
-			line = std::string(buffer);
-			if (removeTralingSpace)
+			line += buffer;
+			if (line.back() == '\n')
 			{
-				while (line.length() > 0 && isspace(line.back()))
-				{
-					line.pop_back();
-				}
+				break;
 			}
+		}
 
-			m_FilePosition += (int)line.length();
-			return true;
+		if (line.empty())
+		{
+			return false;
+		}
+
+		if (removeTralingSpace)
+		{
+			while (line.length() > 0 && isspace(line.back()))
+			{
+				line.pop_back();
+			}
 		}
+
+		m_FilePosition += (int)line.length();
+		return true;
 	}
 	return false;
 }
@@ -104,23 +116,7 @@ bool TextFile::ReadLine(std::string& line, bool removeTralingSpace)
 std::string TextFile::ReadLine(bool removeTralingSpace)
 {
 	std::string line = "";
-	if (m_Mode == FileMode::Read)
-	{
-		char buffer[1024];
-		if (fgets(buffer, 1024, m_File) != NULL)
-		{
-			line = std::string(buffer);
-			if (removeTralingSpace)
-			{
-				while (line.length() > 0 && isspace(line.back()))
-				{
-					line.pop_back();
-				}
-			}
-
-			m_FilePosition += (int)line.length();
-		}
-	}
+	ReadLine(line, removeTralingSpace);
 	return line;
 }
 
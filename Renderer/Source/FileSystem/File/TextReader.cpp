@@ -0,0 +1,78 @@
+#include "FileSystem/File/TextReader.h"
+#include "FileSystem/File/BinaryFile.h"
+#include <cstring>
+
+TextReader::TextReader(const std::string& path)
+{
+	Open(path);
+}
+
+TextReader::TextReader(const char* data, size_t size)
+{
+	// Never null so an empty buffer still counts as open
+	m_Data = data ? data : "";
+	m_Size = data ? size : 0;
+}
+
+bool TextReader::Open(const std::string& path)
+{
+	Close();
+
+	if (m_Mapping.Open(path))
+	{
+		m_Data = (const char*)m_Mapping.Data();
+		m_Size = (size_t)m_Mapping.Size();
+		return true;
+	}
+
+	// Empty files cant be mapped either, so this is the path for those too
+	BinaryFile file(path, FileMode::Read);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	m_Buffer.resize((size_t)file.FileSize());
+	if (m_Buffer.empty() == false && file.Read((Byte*)m_Buffer.data(), (u32)m_Buffer.size()) == false)
+	{
+		m_Buffer.clear();
+		return false;
+	}
+
+	m_Data = m_Buffer.empty() ? "" : m_Buffer.data();
+	m_Size = m_Buffer.size();
+	return true;
+}
+
+void TextReader::Close()
+{
+	m_Mapping.Close();
+	m_Buffer.clear();
+	m_Buffer.shrink_to_fit();
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Position = 0;
+}
+
+bool TextReader::ReadLine(std::string_view& line)
+{
+	if (m_Position >= m_Size)
+	{
+		return false;
+	}
+
+	const char* start = m_Data + m_Position;
+	size_t left = m_Size - m_Position;
+	const char* end = (const char*)memchr(start, '\n', left);
+
+	size_t length = end ? (size_t)(end - start) : left;
+	m_Position += end ? length + 1 : length;
+
+	if (length > 0 && start[length - 1] == '\r')
+	{
+		--length;
+	}
+
+	line = std::string_view(start, length);
+	return true;
+}
@@ -1,72 +1,481 @@
 #include "FileSystem/Pak/PakArchive.h"
 #include "FileSystem/Pak/PakFile.h"
+#include "FileSystem/Pak/PakIOQueue.h"
 #include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/File/MappedFile.h"
+#include "FileSystem/File/TextFile.h"
 #include "System/Hash32.h"
+#include "System/Hash64.h"
+#include "System/ThreadPool.h"
 #include "System/Assert.h"
+#include <algorithm>
+#include <cstring>
 
-PakArchive::PakArchive(const std::string& path)
+PakArchive::PakArchive(const std::string& path, bool useMapping)
 {
 	m_Path = path;
+	m_UseMapping = useMapping;
+}
+
+PakArchive::~PakArchive()
+{
+	// Stop the I/O threads before the file they read from goes away
+	m_IOQueue.reset();
 }
 
 bool PakArchive::Mount()
 {
-	m_File = std::make_unique<BinaryFile>(m_Path, FileMode::Read);
-	if (m_File->Open(m_Path, FileMode::Read) == false)
+	return Mount(nullptr);
+}
+
+bool PakArchive::Mount(const BaseResolver& findBase)
+{
+	if (m_UseMapping)
 	{
-		return false;
+		m_Mapping = std::make_unique<MappedFile>();
+		if (m_Mapping->Open(m_Path) == false || m_Mapping->Size() < sizeof(PakHeader))
+		{
+			// Mapping can fail on 32bit address space or odd file systems, stdio still works.
+			m_Mapping.reset();
+		}
+	}
+
+	u32 size = 0;
+	if (m_Mapping == nullptr)
+	{
+		m_File = std::make_unique<BinaryFile>(m_Path, FileMode::Read);
+		if (m_File->IsOpen() == false)
+		{
+			return false;
+		}
+
+		size = (u32)m_File->FileSize(); // Check this is supported on all platforms!!!!
+	}
+	else
+	{
+		size = (u32)m_Mapping->Size();
 	}
 
 	// Header is stored at the end, so we need to read from the end :/
-	int size = m_File->FileSize(); // Check this is supported on all platforms!!!!
-	if (m_File->ReadFrom((Byte*)&m_Header, size - sizeof(PakHeader), sizeof(PakHeader)) == false)
+	if (size < sizeof(PakHeader) || ReadFrom((Byte*)&m_Header, size - sizeof(PakHeader), sizeof(PakHeader)) == false)
 	{
 		return false;
 	}
 
-	if (strcmp("PAK", m_Header.m_ID) != 0)
+	if (strcmp("PAK", m_Header.m_ID) != 0 || m_Header.m_Version != PAK_VERSION)
 	{
 		return false;
 	}
 
-	// Load entries into hash map, slightly slower than a bulk read too vector,
-	// but means the load of each individual file is best case O(1), so front load the work
-	// in a loading screen!!!!
-	m_File->SeekStart();
-	for (size_t i = 0; i < m_Header.m_Entries; ++i)
+	u64 entryBytes = (u64)m_Header.m_Entries * sizeof(PakEntry);
+	if ((u64)m_Header.m_StringOffset + m_Header.m_StringSize > size || m_Header.m_EntryOffset + entryBytes > size ||
+		m_Header.m_StringSize == 0 || m_Header.m_EntryOffset % alignof(PakEntry) != 0)
 	{
-		PakEntry entry;
-		if (m_File->Read((Byte*)&entry, sizeof(PakEntry)) == false)
+		return false;
+	}
+
+	// The directory is already sorted by hash, so it's used in place. Mapped archives dont
+	// copy anything and the OS only pages in the parts of the table lookups actually touch.
+	if (m_Mapping)
+	{
+		m_Entries = (const PakEntry*)(m_Mapping->Data() + m_Header.m_EntryOffset);
+		m_Strings = (const char*)(m_Mapping->Data() + m_Header.m_StringOffset);
+	}
+	else
+	{
+		// Entries first so they stay aligned, one read for each block.
+		m_DirectoryData.resize((size_t)entryBytes + m_Header.m_StringSize);
+		if (ReadFrom(m_DirectoryData.data(), m_Header.m_EntryOffset, (u32)entryBytes) == false ||
+			ReadFrom(m_DirectoryData.data() + entryBytes, m_Header.m_StringOffset, m_Header.m_StringSize) == false)
 		{
 			return false;
 		}
 
-		m_Entries.insert(std::make_pair(entry.m_HashID, entry));
+		m_Entries = (const PakEntry*)m_DirectoryData.data();
+		m_Strings = (const char*)(m_DirectoryData.data() + entryBytes);
 	}
 
+	// Paths must stay inside the table, which must end with a terminator
+	if (m_Strings[m_Header.m_StringSize - 1] != '\0')
+	{
+		return false;
+	}
+
+	for (u32 i = 0; i < m_Header.m_Entries; ++i)
+	{
+		if (m_Entries[i].m_PathOffset >= m_Header.m_StringSize || (i > 0 && m_Entries[i - 1].m_HashID >= m_Entries[i].m_HashID))
+		{
+			return false;
+		}
+	}
+
+	// A patch is only any use on top of the exact base it was diffed against
+	if (IsPatch() && m_Base == nullptr && findBase)
+	{
+		m_Base = findBase(m_Header.m_BaseID);
+	}
+
+	if (IsPatch() && (m_Base == nullptr || m_Base->DirectoryID() != m_Header.m_BaseID))
+	{
+		return false;
+	}
+
+	m_Verified.reset(new std::atomic<bool>[m_Header.m_Entries]());
 	return true;
 }
 
+u64 PakArchive::DirectoryID() const
+{
+	return Hash64::ComputeHash((const Byte*)m_Entries, (u64)m_Header.m_Entries * sizeof(PakEntry));
+}
+
+void PakArchive::GetFileIDs(std::vector<u32>& ids) const
+{
+	ids.resize(m_Header.m_Entries);
+	for (u32 i = 0; i < m_Header.m_Entries; ++i)
+	{
+		ids[i] = m_Entries[i].m_HashID;
+	}
+}
+
+const char* PakArchive::EntryPath(const PakEntry& entry) const
+{
+	return m_Strings + entry.m_PathOffset;
+}
+
+bool PakArchive::IsMapped() const
+{
+	return m_Mapping != nullptr;
+}
+
 bool PakArchive::HasFile(const std::string& path) const
 {
-	return m_Entries.find(Hash32::ComputeHash((Byte*)path.c_str(), (unsigned int)path.length())) != m_Entries.end();
+	return FindEntry(Hash32::ComputeHash((Byte*)path.c_str(), (unsigned int)path.length())) != nullptr;
 }
 
 bool PakArchive::HasFile(u32 hashID) const
 {
-	return m_Entries.find(hashID) != m_Entries.end();
+	return FindEntry(hashID) != nullptr;
 }
 
 std::unique_ptr<PakFile> PakArchive::GetFile(const std::string& path)
 {
-	EntryIterator itr = m_Entries.find(Hash32::ComputeHash((Byte*)path.c_str(), (unsigned int)path.length()));
-	assert(itr != m_Entries.end());
-	return std::make_unique<PakFile>(path, this, &itr->second);
+	const PakEntry* entry = FindEntry(Hash32::ComputeHash((Byte*)path.c_str(), (unsigned int)path.length()));
+	assert(entry != nullptr);
+	return OpenEntry(path, entry);
 }
 
 std::unique_ptr<PakFile> PakArchive::GetPakFile(u32 hashID)
 {
-	EntryIterator itr = m_Entries.find(hashID);
-	assert(itr != m_Entries.end());
-	return std::make_unique<PakFile>(itr->second.m_FilePath, this, &itr->second);
-}
\ No newline at end of file
+	const PakEntry* entry = FindEntry(hashID);
+	assert(entry != nullptr);
+	return entry ? OpenEntry(EntryPath(*entry), entry) : nullptr;
+}
+
+std::unique_ptr<PakFile> PakArchive::OpenEntry(const std::string& path, const PakEntry* entry)
+{
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+
+	RecordAccess(entry);
+
+	// Patch didnt store it, the base has the exact same file
+	if (entry->m_Flags & PAK_ENTRY_UNCHANGED)
+	{
+		return m_Base->GetPakFile(entry->m_HashID);
+	}
+
+	return std::make_unique<PakFile>(path, this, entry);
+}
+
+const PakEntry* PakArchive::FindEntry(u32 hashID) const
+{
+	// Plain binary search, 100k entries is ~17 probes over a table that's already resident.
+	const PakEntry* end = m_Entries + m_Header.m_Entries;
+	const PakEntry* entry = std::lower_bound(m_Entries, end, hashID, [](const PakEntry& a, u32 id) { return a.m_HashID < id; });
+	return (entry != end && entry->m_HashID == hashID) ? entry : nullptr;
+}
+
+std::shared_ptr<const std::vector<u8>> PakArchive::ReadShared(u32 hashID)
+{
+	const PakEntry* entry = FindEntry(hashID);
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (entry->m_Flags & PAK_ENTRY_UNCHANGED)
+	{
+		RecordAccess(entry);
+		return m_Base->ReadShared(hashID);
+	}
+
+	// Size as well, an empty file can sit on the same offset as the one after it
+	u64 key = ((u64)entry->m_Offset << 32) | entry->m_UncompressedSize;
+	{
+		std::lock_guard<std::mutex> lock(m_BlobLock);
+		auto itr = m_Blobs.find(key);
+		if (itr != m_Blobs.end())
+		{
+			if (std::shared_ptr<const std::vector<u8>> blob = itr->second.lock())
+			{
+				RecordAccess(entry);
+				return blob;
+			}
+		}
+	}
+
+	// Decode outside the lock, two threads racing on the same blob just keep the first one.
+	std::unique_ptr<PakFile> file = GetPakFile(hashID);
+	std::shared_ptr<std::vector<u8>> data = std::make_shared<std::vector<u8>>(entry->m_UncompressedSize);
+	if (data->empty() == false && file->Read(data->data(), (u32)data->size()) == false)
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_BlobLock);
+	std::weak_ptr<const std::vector<u8>>& slot = m_Blobs[key];
+	if (std::shared_ptr<const std::vector<u8>> existing = slot.lock())
+	{
+		return existing;
+	}
+
+	slot = data;
+	return data;
+}
+
+PakSpan PakArchive::GetSpan(u32 hashID) const
+{
+	PakSpan span;
+	const PakEntry* entry = FindEntry(hashID);
+	if (entry != nullptr && (entry->m_Flags & PAK_ENTRY_UNCHANGED))
+	{
+		return m_Base->GetSpan(hashID);
+	}
+
+	// Delta entries are spread over two archives, no single span for those
+	if (entry != nullptr && entry->m_Codec == PakCodec::None && entry->m_Flags == 0)
+	{
+		span.m_Data = MappedData(entry->m_Offset, entry->m_UncompressedSize);
+		span.m_Size = span.m_Data ? entry->m_UncompressedSize : 0;
+	}
+
+	return span;
+}
+
+PakSpan PakArchive::GetSpan(u32 hashID, std::vector<u8>& storage)
+{
+	const PakEntry* entry = FindEntry(hashID);
+	PakSpan span = GetSpan(hashID);
+	if (entry == nullptr || span.IsValid())
+	{
+		if (span.IsValid())
+		{
+			RecordAccess(entry);
+		}
+		return span;
+	}
+
+	std::unique_ptr<PakFile> file = GetPakFile(hashID);
+	storage.resize(entry->m_UncompressedSize);
+	if (storage.empty() == false && file->Read(storage.data(), (u32)storage.size()) == false)
+	{
+		return PakSpan();
+	}
+
+	span.m_Data = storage.data();
+	span.m_Size = (u32)storage.size();
+	return span;
+}
+
+void PakArchive::StartTrace()
+{
+	std::lock_guard<std::mutex> lock(m_TraceLock);
+	m_Trace.clear();
+	m_TraceSeen.clear();
+	m_Tracing = true;
+}
+
+bool PakArchive::StopTrace(const std::string& tracePath)
+{
+	std::vector<u32> trace;
+	{
+		std::lock_guard<std::mutex> lock(m_TraceLock);
+		m_Tracing = false;
+		trace.swap(m_Trace);
+		m_TraceSeen.clear();
+	}
+
+	TextFile file(tracePath, FileMode::Write);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	// Paths rather than ids so the trace still applies after files are added or renamed
+	bool result = true;
+	for (u32 hashID : trace)
+	{
+		std::string line = std::string(EntryPath(*FindEntry(hashID))) + "\n";
+		result = result && file.Write(line.c_str(), (u32)line.length());
+	}
+
+	file.Close();
+	return result;
+}
+
+void PakArchive::RecordAccess(const PakEntry* entry)
+{
+	// Just an atomic load when not tracing, GetPakFile is hot
+	if (entry == nullptr || m_Tracing == false)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_TraceLock);
+	if (m_Tracing && m_TraceSeen.insert(entry->m_HashID).second)
+	{
+		m_Trace.push_back(entry->m_HashID);
+	}
+}
+
+void PakArchive::SetDecodeThreads(u32 threadCount)
+{
+	m_DecodePool.reset();
+	if (threadCount > 1)
+	{
+		// The reading thread helps out, so the pool itself is one short
+		m_DecodePool = std::make_unique<ThreadPool>(threadCount - 1);
+	}
+}
+
+bool PakArchive::Verify(u32 threadCount, std::vector<u32>* failedIDs)
+{
+	// Deduplicated entries share a blob, only hash each blob once
+	std::vector<const PakEntry*> blobs;
+	std::unordered_set<u64> seen;
+	for (u32 i = 0; i < m_Header.m_Entries; ++i)
+	{
+		if (seen.insert(((u64)m_Entries[i].m_Offset << 32) | m_Entries[i].m_CompressedSize).second)
+		{
+			blobs.push_back(&m_Entries[i]);
+		}
+	}
+
+	// Biggest first so one huge entry doesnt end up last on a single thread
+	std::sort(blobs.begin(), blobs.end(), [](const PakEntry* a, const PakEntry* b) { return a->m_CompressedSize > b->m_CompressedSize; });
+
+	std::vector<u8> failed(blobs.size(), 0);
+	ThreadPool pool(threadCount);
+	bool result = pool.ParallelFor((u32)blobs.size(), [this, &blobs, &failed](u32 index)
+	{
+		failed[index] = VerifyEntry(*blobs[index]) ? 0 : 1;
+		return failed[index] == 0;
+	});
+
+	if (failedIDs != nullptr)
+	{
+		std::unordered_set<u64> bad;
+		for (size_t i = 0; i < blobs.size(); ++i)
+		{
+			if (failed[i])
+			{
+				bad.insert(((u64)blobs[i]->m_Offset << 32) | blobs[i]->m_CompressedSize);
+			}
+		}
+
+		failedIDs->clear();
+		for (u32 i = 0; i < m_Header.m_Entries && bad.empty() == false; ++i)
+		{
+			if (bad.count(((u64)m_Entries[i].m_Offset << 32) | m_Entries[i].m_CompressedSize))
+			{
+				failedIDs->push_back(m_Entries[i].m_HashID);
+			}
+		}
+	}
+
+	return result;
+}
+
+bool PakArchive::VerifyOnce(const PakEntry& entry)
+{
+	std::atomic<bool>& verified = m_Verified[&entry - m_Entries];
+	if (verified)
+	{
+		return true;
+	}
+
+	// Two threads can both hash it the first time, harmless.
+	if (VerifyEntry(entry) == false)
+	{
+		return false;
+	}
+
+	verified = true;
+	return true;
+}
+
+bool PakArchive::VerifyEntry(const PakEntry& entry)
+{
+	const Byte* data = MappedData(entry.m_Offset, entry.m_CompressedSize);
+	if (data == nullptr)
+	{
+		static thread_local std::vector<u8> staging;
+		staging.resize(entry.m_CompressedSize);
+		if (staging.empty() == false && ReadFrom(staging.data(), entry.m_Offset, entry.m_CompressedSize) == false)
+		{
+			return false;
+		}
+		data = staging.data();
+	}
+
+	return Hash64::ComputeHash(data, entry.m_CompressedSize) == entry.m_Checksum;
+}
+
+void PakArchive::StartAsync(u32 threadCount)
+{
+	std::call_once(m_IOStarted, [this, threadCount]()
+	{
+		m_IOQueue = std::make_unique<PakIOQueue>(this, threadCount);
+	});
+}
+
+std::shared_ptr<PakBatch> PakArchive::ReadAsync(const std::vector<PakRequest>& requests)
+{
+	StartAsync();
+	return m_IOQueue->Submit(requests);
+}
+
+u32 PakArchive::CancelAsync(u32 belowPriority)
+{
+	StartAsync();
+	return m_IOQueue->Cancel(belowPriority);
+}
+
+bool PakArchive::ReadFrom(Byte* data, u32 offset, u32 count)
+{
+	if (m_Mapping)
+	{
+		if ((u64)offset + count > m_Mapping->Size())
+		{
+			return false;
+		}
+
+		memcpy(data, m_Mapping->Data() + offset, count);
+		return true;
+	}
+
+	return m_File && m_File->ReadAt(data, offset, count);
+}
+
+const Byte* PakArchive::MappedData(u32 offset, u32 count) const
+{
+	if (m_Mapping == nullptr || (u64)offset + count > m_Mapping->Size())
+	{
+		return nullptr;
+	}
+
+	return m_Mapping->Data() + offset;
+}
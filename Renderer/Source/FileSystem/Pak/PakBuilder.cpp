@@ -0,0 +1,701 @@
+#include "FileSystem/Pak/PakBuilder.h"
+#include "FileSystem/Pak/PakFile.h"
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/File/TextFile.h"
+#include "FileSystem/Path.h"
+#include "System/Hash32.h"
+#include "System/Hash64.h"
+#include <sys/stat.h>
+#include <unordered_set>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace
+{
+	std::string NormalizeDirectory(const std::string& directory)
+	{
+		std::string folder = directory;
+		if (folder.empty() == false && folder.back() != '\\')
+		{
+			folder += "\\";
+		}
+		return folder;
+	}
+
+	bool ReadWholeFile(const std::string& path, std::vector<u8>& data)
+	{
+		BinaryFile file(path, FileMode::Read);
+		if (file.IsOpen() == false)
+		{
+			return false;
+		}
+
+		data.resize((size_t)file.FileSize());
+		bool result = data.empty() || file.Read(data.data(), (u32)data.size());
+		file.Close();
+		return result;
+	}
+
+	// Packed data is freed once written, so a dedup candidate is checked against the sources
+	bool SameFileBytes(const std::string& a, const std::string& b, std::vector<u8>& aBytes, std::vector<u8>& bBytes)
+	{
+		return ReadWholeFile(a, aBytes) && ReadWholeFile(b, bBytes) && aBytes == bBytes;
+	}
+
+	// Writes [string table][entries sorted by hash][header] after offset bytes of data
+	bool WriteDirectory(BinaryFile& file, u64 offset, PakHeader& header, const std::string& folderPath, const std::string& name,
+		std::vector<PakEntry>& entries, const std::vector<std::string>& paths)
+	{
+		// String table, folder and name first then every path, all null terminated
+		std::vector<char> strings;
+		auto addString = [&strings](const std::string& string)
+		{
+			u32 stringOffset = (u32)strings.size();
+			strings.insert(strings.end(), string.begin(), string.end());
+			strings.push_back('\0');
+			return stringOffset;
+		};
+
+		header.m_FolderPath = addString(folderPath);
+		header.m_PakName = addString(name);
+		for (size_t i = 0; i < entries.size(); ++i)
+		{
+			entries[i].m_PathOffset = addString(paths[i]);
+		}
+
+		// Sorted so the runtime can binary search the table in place
+		std::sort(entries.begin(), entries.end(), [](const PakEntry& a, const PakEntry& b) { return a.m_HashID < b.m_HashID; });
+
+		// Pad so the entry table is aligned when mapped
+		while ((offset + strings.size()) % alignof(PakEntry) != 0)
+		{
+			strings.push_back('\0');
+		}
+
+		header.m_StringOffset = (u32)offset;
+		header.m_StringSize = (u32)strings.size();
+		header.m_EntryOffset = (u32)(offset + strings.size());
+		header.m_Entries = (u32)entries.size();
+
+		u64 directoryEnd = (u64)header.m_EntryOffset + entries.size() * sizeof(PakEntry) + sizeof(PakHeader);
+		if (directoryEnd > UINT32_MAX)
+		{
+			return false;
+		}
+
+		FileSpan spans[3] =
+		{
+			{ (const Byte*)strings.data(), (u32)strings.size() },
+			{ (const Byte*)entries.data(), (u32)(entries.size() * sizeof(PakEntry)) },
+			{ (const Byte*)&header, sizeof(PakHeader) }
+		};
+		return file.WriteGather(spans, 3);
+	}
+
+	struct ChunkRef
+	{
+		u32 m_Offset	= 0;	// Absolute in the archive
+		u32 m_Size		= 0;	// Packed
+		u32 m_RawSize	= 0;
+		PakCodec m_Codec = PakCodec::None;	// None when the chunk is stored raw
+	};
+
+	// Where every chunk of a (non patch) entry lives, stored entries are cut into plain chunks
+	bool GetChunks(PakArchive& archive, const PakEntry& entry, std::vector<ChunkRef>& chunks)
+	{
+		u32 chunkCount = (entry.m_UncompressedSize + PAK_CHUNK_SIZE - 1) / PAK_CHUNK_SIZE;
+		chunks.resize(chunkCount);
+
+		std::vector<u32> table;
+		if (entry.m_Codec != PakCodec::None)
+		{
+			table.resize(chunkCount * 2 + 1);
+			if (chunkCount > 0 && archive.ReadFrom((Byte*)table.data(), entry.m_Offset, (u32)(table.size() * sizeof(u32))) == false)
+			{
+				return false;
+			}
+		}
+
+		for (u32 i = 0; i < chunkCount; ++i)
+		{
+			chunks[i].m_RawSize = std::min((u32)PAK_CHUNK_SIZE, entry.m_UncompressedSize - i * PAK_CHUNK_SIZE);
+			chunks[i].m_Offset	= entry.m_Offset + ((entry.m_Codec == PakCodec::None) ? i * PAK_CHUNK_SIZE : table[i]);
+			chunks[i].m_Size	= (entry.m_Codec == PakCodec::None) ? chunks[i].m_RawSize : table[i + 1] - table[i];
+			chunks[i].m_Codec	= (chunks[i].m_Size == chunks[i].m_RawSize) ? PakCodec::None : entry.m_Codec;
+		}
+
+		return true;
+	}
+
+	// Compares the stored bytes of two entries a chunk at a time, so a big file isnt held twice
+	bool SameStoredBytes(PakArchive& a, const PakEntry& aEntry, PakArchive& b, const PakEntry& bEntry, std::vector<u8>& aBytes, std::vector<u8>& bBytes)
+	{
+		if (aEntry.m_CompressedSize != bEntry.m_CompressedSize)
+		{
+			return false;
+		}
+
+		for (u32 done = 0; done < aEntry.m_CompressedSize; done += PAK_CHUNK_SIZE)
+		{
+			u32 count = std::min((u32)PAK_CHUNK_SIZE, aEntry.m_CompressedSize - done);
+			aBytes.resize(count);
+			bBytes.resize(count);
+			if (a.ReadFrom(aBytes.data(), aEntry.m_Offset + done, count) == false || b.ReadFrom(bBytes.data(), bEntry.m_Offset + done, count) == false ||
+				aBytes != bBytes)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Raw chunks match whatever codec either side used, packed ones only match the same codec
+	u64 ChunkKey(const ChunkRef& chunk, const std::vector<u8>& bytes)
+	{
+		return Hash64::ComputeHash(bytes.data(), bytes.size(), ((u64)chunk.m_RawSize << 8) | (u64)chunk.m_Codec);
+	}
+}
+
+PakBuilder::PakBuilder(const PakBuildSettings& settings)
+{
+	m_Settings = settings;
+	if (m_Settings.m_ThreadCount == 0)
+	{
+		m_Settings.m_ThreadCount = std::thread::hardware_concurrency();
+	}
+
+	if (m_Settings.m_ThreadCount == 0)
+	{
+		m_Settings.m_ThreadCount = 1;
+	}
+}
+
+bool PakBuilder::AddDirectory(const std::string& directory)
+{
+	std::string root = NormalizeDirectory(directory);
+	std::vector<std::string> files = Path::GetFiles(root, true);
+	for (const std::string& file : files)
+	{
+		if (AddFile(file, file.substr(root.length())) == false)
+		{
+			return false;
+		}
+	}
+
+	return files.empty() == false;
+}
+
+bool PakBuilder::AddFile(const std::string& sourcePath, const std::string& pakPath)
+{
+	if (pakPath.empty())
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (stat(sourcePath.c_str(), &st) != 0)
+	{
+		return false;
+	}
+
+	BuildItem item;
+	std::memset(&item.m_Entry, 0, sizeof(PakEntry));
+	item.m_Entry.m_HashID			= Hash32::ComputeHash((const Byte*)pakPath.c_str(), (u32)pakPath.length());
+	item.m_Entry.m_UncompressedSize = (u32)st.st_size;
+	item.m_SourcePath				= sourcePath;
+	item.m_PakPath					= pakPath;
+	m_Items.push_back(std::move(item));
+	return true;
+}
+
+bool PakBuilder::ApplyOrder(const std::string& tracePath)
+{
+	TextFile file(tracePath, FileMode::Read);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	std::unordered_map<std::string, size_t> rank;
+	std::string line;
+	while (file.ReadLine(line, true))
+	{
+		if (line.empty() == false)
+		{
+			rank.emplace(line, rank.size());
+		}
+	}
+	file.Close();
+
+	// Traced files first in trace order, the rest keep their current order behind them.
+	std::stable_sort(m_Items.begin(), m_Items.end(), [&rank](const BuildItem& a, const BuildItem& b)
+	{
+		auto itrA = rank.find(a.m_PakPath);
+		auto itrB = rank.find(b.m_PakPath);
+		size_t rankA = (itrA != rank.end()) ? itrA->second : SIZE_MAX;
+		size_t rankB = (itrB != rank.end()) ? itrB->second : SIZE_MAX;
+		return rankA < rankB;
+	});
+
+	return true;
+}
+
+u32 PakBuilder::FileCount() const
+{
+	return (u32)m_Items.size();
+}
+
+bool PakBuilder::Build(const std::string& outputPath, const std::string& folderPath)
+{
+	if (m_Items.empty() || PakCompression::IsSupported(m_Settings.m_Codec) == false)
+	{
+		return false;
+	}
+
+	// Lookups are by hash only, two paths on the same id would shadow each other.
+	std::unordered_set<u32> hashes;
+	for (const BuildItem& item : m_Items)
+	{
+		if (hashes.insert(item.m_Entry.m_HashID).second == false)
+		{
+			return false;
+		}
+	}
+
+	BinaryFile file(outputPath, FileMode::Write);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	// Small files would otherwise be a syscall each
+	file.SetWriteBuffer(4 * 1024 * 1024);
+
+	// Data goes first, the directory is written after it once every offset is known.
+	bool result = true;
+	u64 offset = 0;
+
+	// Content hash -> first item with those bytes, later copies just point at it
+	std::unordered_map<u64, std::vector<const BuildItem*>> blobs;
+	std::vector<u8> originalBytes;
+	std::vector<u8> itemBytes;
+	m_DuplicateCount = 0;
+	m_SavedBytes = 0;
+
+	size_t start = 0;
+	while (result && start < m_Items.size())
+	{
+		// Batch by source size so a huge content folder doesnt sit in memory all at once
+		size_t end = start;
+		u64 batchBytes = 0;
+		while (end < m_Items.size() && (end == start || batchBytes + m_Items[end].m_Entry.m_UncompressedSize <= m_Settings.m_BatchBytes))
+		{
+			batchBytes += m_Items[end].m_Entry.m_UncompressedSize;
+			++end;
+		}
+
+		PackBatch(start, end);
+
+		// Write out in order so the layout is deterministic regardless of thread timing.
+		for (size_t i = start; i < end && result; ++i)
+		{
+			BuildItem& item = m_Items[i];
+			if (item.m_Failed || offset + item.m_Data.size() > UINT32_MAX)
+			{
+				result = false;
+				break;
+			}
+
+			const PakEntry* original = nullptr;
+			if (m_Settings.m_Deduplicate && item.m_Data.empty() == false)
+			{
+				// The hash and size only find a candidate, the bytes have too match too
+				std::vector<const BuildItem*>& matches = blobs[item.m_ContentHash];
+				for (const BuildItem* match : matches)
+				{
+					if (match->m_Entry.m_UncompressedSize == item.m_Entry.m_UncompressedSize &&
+						SameFileBytes(match->m_SourcePath, item.m_SourcePath, originalBytes, itemBytes))
+					{
+						original = &match->m_Entry;
+						break;
+					}
+				}
+
+				if (original == nullptr)
+				{
+					matches.push_back(&item);
+				}
+			}
+
+			if (original != nullptr)
+			{
+				// Same bytes already written, share the blob instead of storing it again
+				item.m_Entry.m_Offset = original->m_Offset;
+				item.m_Entry.m_CompressedSize = original->m_CompressedSize;
+				item.m_Entry.m_Codec = original->m_Codec;
+				item.m_Entry.m_Checksum = original->m_Checksum;
+				++m_DuplicateCount;
+				m_SavedBytes += original->m_CompressedSize;
+			}
+			else
+			{
+				item.m_Entry.m_Offset = (u32)offset;
+				item.m_Entry.m_CompressedSize = (u32)item.m_Data.size();
+				result = item.m_Data.empty() || file.Write(item.m_Data.data(), (u32)item.m_Data.size());
+				offset += item.m_Data.size();
+			}
+
+			std::vector<u8>().swap(item.m_Data);
+		}
+
+		start = end;
+	}
+
+	if (result)
+	{
+		std::vector<PakEntry> entries(m_Items.size());
+		std::vector<std::string> paths(m_Items.size());
+		for (size_t i = 0; i < m_Items.size(); ++i)
+		{
+			entries[i] = m_Items[i].m_Entry;
+			paths[i] = m_Items[i].m_PakPath;
+		}
+
+		PakHeader header;
+		result = WriteDirectory(file, offset, header, folderPath, Path::FileNameWithoutExt(outputPath), entries, paths);
+	}
+
+	file.Close();
+	return result;
+}
+
+bool PakBuilder::BuildPatch(const std::string& basePath, const std::string& newPath, const std::string& patchPath, PakPatchStats* stats)
+{
+	PakArchive base(basePath);
+	PakArchive next(newPath);
+	if (base.Mount() == false || next.Mount() == false || base.IsPatch() || next.IsPatch())
+	{
+		return false;
+	}
+
+	PakPatchStats patchStats;
+	std::vector<ChunkRef> chunks;
+	std::vector<u8> bytes;
+	std::vector<u8> baseBytes;
+
+	// Every chunk in the base by content, so moved and renamed data is found too
+	std::unordered_map<u64, ChunkRef> baseChunks;
+	for (u32 i = 0; i < base.FileCount(); ++i)
+	{
+		const PakEntry& entry = base.Entries()[i];
+		if (GetChunks(base, entry, chunks) == false)
+		{
+			return false;
+		}
+
+		for (const ChunkRef& chunk : chunks)
+		{
+			bytes.resize(chunk.m_Size);
+			if (base.ReadFrom(bytes.data(), chunk.m_Offset, chunk.m_Size) == false)
+			{
+				return false;
+			}
+			baseChunks.emplace(ChunkKey(chunk, bytes), chunk);
+		}
+	}
+
+	BinaryFile file(patchPath, FileMode::Write);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	file.SetWriteBuffer(4 * 1024 * 1024);
+
+	std::vector<PakEntry> entries(next.FileCount());
+	std::vector<std::string> paths(next.FileCount());
+	std::unordered_map<u64, PakEntry> written;	// Dedup'd blobs in the new archive only go in once
+	u64 offset = 0;
+
+	for (u32 i = 0; i < next.FileCount(); ++i)
+	{
+		const PakEntry& source = next.Entries()[i];
+		PakEntry& entry = entries[i];
+		entry = source;
+		paths[i] = next.EntryPath(source);
+
+		// Checksum only finds a candidate, the stored bytes have too match too like reused chunks
+		const PakEntry* original = base.FindEntry(source.m_HashID);
+		if (original != nullptr && original->m_Codec == source.m_Codec && original->m_UncompressedSize == source.m_UncompressedSize &&
+			original->m_Checksum == source.m_Checksum && SameStoredBytes(base, *original, next, source, baseBytes, bytes))
+		{
+			entry.m_Offset = 0;
+			entry.m_CompressedSize = 0;
+			entry.m_Checksum = Hash64::ComputeHash(nullptr, 0);
+			entry.m_Flags = PAK_ENTRY_UNCHANGED;
+			++patchStats.m_Unchanged;
+			continue;
+		}
+
+		if (original != nullptr)
+		{
+			++patchStats.m_Changed;
+		}
+		else
+		{
+			++patchStats.m_Added;
+		}
+
+		u64 blobKey = ((u64)source.m_Offset << 32) | source.m_CompressedSize;
+		auto done = written.find(blobKey);
+		if (done != written.end())
+		{
+			entry.m_Offset = done->second.m_Offset;
+			entry.m_CompressedSize = done->second.m_CompressedSize;
+			entry.m_Checksum = done->second.m_Checksum;
+			entry.m_Flags = done->second.m_Flags;
+			continue;
+		}
+
+		if (GetChunks(next, source, chunks) == false)
+		{
+			return false;
+		}
+
+		// Chunk table up front, changed chunks appended after it
+		std::vector<PakDeltaChunk> deltas(chunks.size());
+		std::vector<u8> blob(sizeof(u32) + chunks.size() * sizeof(PakDeltaChunk));
+		u32 reused = 0;
+		for (size_t c = 0; c < chunks.size(); ++c)
+		{
+			bytes.resize(chunks[c].m_Size);
+			if (next.ReadFrom(bytes.data(), chunks[c].m_Offset, chunks[c].m_Size) == false)
+			{
+				return false;
+			}
+
+			deltas[c].m_Size = chunks[c].m_Size;
+			deltas[c].m_Checksum = (u32)Hash64::ComputeHash(bytes.data(), bytes.size());
+
+			// The hash only finds a candidate, the base bytes have too match too
+			auto match = baseChunks.find(ChunkKey(chunks[c], bytes));
+			bool same = false;
+			if (match != baseChunks.end() && match->second.m_Size == chunks[c].m_Size &&
+				match->second.m_RawSize == chunks[c].m_RawSize && match->second.m_Codec == chunks[c].m_Codec)
+			{
+				baseBytes.resize(match->second.m_Size);
+				if (base.ReadFrom(baseBytes.data(), match->second.m_Offset, match->second.m_Size) == false)
+				{
+					return false;
+				}
+				same = (baseBytes == bytes);
+			}
+
+			if (same)
+			{
+				deltas[c].m_Offset = match->second.m_Offset;
+				deltas[c].m_FromBase = 1;
+				++reused;
+			}
+			else
+			{
+				deltas[c].m_Offset = (u32)blob.size();
+				deltas[c].m_FromBase = 0;
+				blob.insert(blob.end(), bytes.begin(), bytes.end());
+			}
+		}
+
+		patchStats.m_ReusedChunks += reused;
+		patchStats.m_NewChunks += (u32)chunks.size() - reused;
+
+		if (reused == 0)
+		{
+			// Nothing in common, a plain copy is smaller than a delta table
+			blob.resize(source.m_CompressedSize);
+			if (blob.empty() == false && next.ReadFrom(blob.data(), source.m_Offset, source.m_CompressedSize) == false)
+			{
+				return false;
+			}
+			entry.m_Flags = 0;
+		}
+		else
+		{
+			u32 count = (u32)chunks.size();
+			std::memcpy(blob.data(), &count, sizeof(u32));
+			std::memcpy(blob.data() + sizeof(u32), deltas.data(), deltas.size() * sizeof(PakDeltaChunk));
+			entry.m_Flags = PAK_ENTRY_DELTA;
+		}
+
+		if (offset + blob.size() > UINT32_MAX)
+		{
+			return false;
+		}
+
+		entry.m_Offset = (u32)offset;
+		entry.m_CompressedSize = (u32)blob.size();
+		entry.m_Checksum = Hash64::ComputeHash(blob.data(), blob.size());
+		if (blob.empty() == false && file.Write(blob.data(), (u32)blob.size()) == false)
+		{
+			return false;
+		}
+
+		offset += blob.size();
+		written.emplace(blobKey, entry);
+	}
+
+	PakHeader header;
+	header.m_Flags = PAK_HEADER_PATCH;
+	header.m_BaseID = base.DirectoryID();
+	bool result = WriteDirectory(file, offset, header, "", Path::FileNameWithoutExt(patchPath), entries, paths);
+	file.Close();
+
+	patchStats.m_PatchBytes = offset;
+	patchStats.m_FullBytes = next.Header().m_StringOffset;
+	if (stats != nullptr)
+	{
+		*stats = patchStats;
+	}
+
+	return result;
+}
+
+bool PakBuilder::Verify(const std::string& pakPath, const std::string& directory)
+{
+	PakArchive archive(pakPath);
+	if (archive.Mount() == false || archive.Verify() == false)
+	{
+		return false;
+	}
+
+	std::string root = NormalizeDirectory(directory);
+	std::vector<std::string> files = Path::GetFiles(root, true);
+	if (files.size() != archive.FileCount())
+	{
+		return false;
+	}
+
+	std::vector<u8> source;
+	std::vector<u8> packed;
+	for (const std::string& path : files)
+	{
+		std::string pakPath = path.substr(root.length());
+		if (archive.HasFile(pakPath) == false || ReadWholeFile(path, source) == false)
+		{
+			return false;
+		}
+
+		// Ids baked into code with _hash have to land on the same entry as the runtime hash
+		u32 hashID = Hash32::ComputeHash((const Byte*)pakPath.c_str(), (u32)pakPath.length());
+		if (Hash32::ComputeHashConst(pakPath.c_str(), pakPath.length()) != hashID)
+		{
+			return false;
+		}
+
+		std::unique_ptr<PakFile> file = archive.GetFile(pakPath);
+		packed.resize(source.size());
+		if (packed.empty() == false && file->Read(packed.data(), (u32)packed.size()) == false)
+		{
+			return false;
+		}
+
+		if (file->IsEndOfFile() == false || std::memcmp(packed.data(), source.data(), source.size()) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void PakBuilder::PackItem(BuildItem& item)
+{
+	item.m_Entry.m_Codec = PakCodec::None;
+	item.m_Failed = ReadWholeFile(item.m_SourcePath, item.m_Data) == false || item.m_Data.size() != item.m_Entry.m_UncompressedSize;
+	if (item.m_Failed)
+	{
+		return;
+	}
+
+	item.m_ContentHash = Hash64::ComputeHash(item.m_Data.data(), item.m_Data.size());
+	if (item.m_Data.empty() == false && m_Settings.m_Codec != PakCodec::None)
+	{
+		PackChunks(item);
+	}
+
+	// Over the bytes actually stored, so Verify never has too decompress
+	item.m_Entry.m_Checksum = Hash64::ComputeHash(item.m_Data.data(), item.m_Data.size());
+}
+
+void PakBuilder::PackChunks(BuildItem& item)
+{
+	// Every chunk is compressed on its own so readers can decode just the chunks they touch.
+	// Table is (chunks + 1) offsets then a checksum per chunk for lazy verification.
+	u32 sourceSize = (u32)item.m_Data.size();
+	u32 chunkCount = (sourceSize + PAK_CHUNK_SIZE - 1) / PAK_CHUNK_SIZE;
+	u32 tableSize = (chunkCount * 2 + 1) * sizeof(u32);
+
+	std::vector<u32> table(chunkCount * 2 + 1);
+	std::vector<u8> packed(tableSize);
+	std::vector<u8> chunkBuffer(PakCompression::CompressBound(m_Settings.m_Codec, PAK_CHUNK_SIZE));
+	for (u32 i = 0; i < chunkCount; ++i)
+	{
+		const u8* chunk = item.m_Data.data() + (size_t)i * PAK_CHUNK_SIZE;
+		u32 chunkSize = std::min((u32)PAK_CHUNK_SIZE, sourceSize - i * PAK_CHUNK_SIZE);
+		u32 size = PakCompression::Compress(m_Settings.m_Codec, chunk, chunkSize, chunkBuffer.data(), (u32)chunkBuffer.size(), m_Settings.m_Level);
+
+		// A chunk that doesnt shrink is stored raw, readers spot it by size alone.
+		table[i] = (u32)packed.size();
+		if (size > 0 && size < chunkSize)
+		{
+			packed.insert(packed.end(), chunkBuffer.begin(), chunkBuffer.begin() + size);
+		}
+		else
+		{
+			packed.insert(packed.end(), chunk, chunk + chunkSize);
+		}
+
+		table[chunkCount + 1 + i] = (u32)Hash64::ComputeHash(packed.data() + table[i], packed.size() - table[i]);
+	}
+
+	table[chunkCount] = (u32)packed.size();
+	std::memcpy(packed.data(), table.data(), tableSize);
+
+	// Already compressed formats (png, jpg) usually grow, just store those.
+	if (packed.size() < item.m_Data.size())
+	{
+		item.m_Data.swap(packed);
+		item.m_Entry.m_Codec = m_Settings.m_Codec;
+	}
+}
+
+void PakBuilder::PackBatch(size_t start, size_t end)
+{
+	std::atomic<size_t> next(start);
+	auto worker = [&]()
+	{
+		for (size_t i = next++; i < end; i = next++)
+		{
+			PackItem(m_Items[i]);
+		}
+	};
+
+	size_t threadCount = std::min((size_t)m_Settings.m_ThreadCount, end - start);
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(worker);
+	}
+
+	// Calling thread does its share too
+	worker();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
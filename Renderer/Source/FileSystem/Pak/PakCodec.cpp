@@ -0,0 +1,136 @@
+#include "FileSystem/Pak/PakCodec.h"
+#include "FileSystem/Pak/PakLZ4.h"
+#include <cstring>
+
+#if defined(PAK_ZSTD)
+	#include "zstd/zstd.h"
+#endif
+
+static const char* s_CodecNames[(u32)PakCodec::Count] = { "none", "lz4", "zstd" };
+
+#if defined(PAK_ZSTD)
+// One of each per thread, made on first use and freed when the thread exits. ZSTD_compress
+// and ZSTD_decompress build and free a whole context every call, which is every 64KB chunk.
+struct ZstdContexts
+{
+	ZSTD_CCtx* m_Compress = nullptr;
+	ZSTD_DCtx* m_Decompress = nullptr;
+
+	~ZstdContexts()
+	{
+		ZSTD_freeCCtx(m_Compress);
+		ZSTD_freeDCtx(m_Decompress);
+	}
+};
+
+static thread_local ZstdContexts s_ZstdContexts;
+#endif
+
+bool PakCompression::IsSupported(PakCodec codec)
+{
+	switch (codec)
+	{
+		case PakCodec::None: return true;
+#if defined(PAK_LZ4)
+		case PakCodec::LZ4: return true;
+#endif
+#if defined(PAK_ZSTD)
+		case PakCodec::Zstd: return true;
+#endif
+		default: return false;
+	}
+}
+
+const char* PakCompression::Name(PakCodec codec)
+{
+	return (codec < PakCodec::Count) ? s_CodecNames[(u32)codec] : "unknown";
+}
+
+bool PakCompression::FromName(const char* name, PakCodec& codec)
+{
+	for (u32 i = 0; i < (u32)PakCodec::Count; ++i)
+	{
+		if (strcmp(name, s_CodecNames[i]) == 0)
+		{
+			codec = (PakCodec)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+u32 PakCompression::CompressBound(PakCodec codec, u32 size)
+{
+	switch (codec)
+	{
+		case PakCodec::LZ4: return PakLZ4::CompressBound(size);
+#if defined(PAK_ZSTD)
+		case PakCodec::Zstd: return (u32)ZSTD_compressBound(size);
+#endif
+		default: return size;
+	}
+}
+
+u32 PakCompression::Compress(PakCodec codec, const Byte* source, u32 sourceSize, Byte* dest, u32 destCapacity, int level)
+{
+	switch (codec)
+	{
+		case PakCodec::None:
+		{
+			if (destCapacity < sourceSize) { return 0; }
+			memcpy(dest, source, sourceSize);
+			return sourceSize;
+		}
+		case PakCodec::LZ4:
+		{
+			// Any level asks for lz4hc, decode speed is the same either way.
+			return PakLZ4::Compress(source, sourceSize, dest, destCapacity, level);
+		}
+#if defined(PAK_ZSTD)
+		case PakCodec::Zstd:
+		{
+			ZstdContexts& contexts = s_ZstdContexts;
+			if (contexts.m_Compress == nullptr && (contexts.m_Compress = ZSTD_createCCtx()) == nullptr)
+			{
+				return 0;
+			}
+
+			size_t result = ZSTD_compressCCtx(contexts.m_Compress, dest, destCapacity, source, sourceSize, (level > 0) ? level : ZSTD_CLEVEL_DEFAULT);
+			return ZSTD_isError(result) ? 0 : (u32)result;
+		}
+#endif
+		default: return 0;
+	}
+}
+
+bool PakCompression::Decompress(PakCodec codec, const Byte* source, u32 sourceSize, Byte* dest, u32 destSize)
+{
+	switch (codec)
+	{
+		case PakCodec::None:
+		{
+			if (sourceSize != destSize) { return false; }
+			memcpy(dest, source, destSize);
+			return true;
+		}
+		case PakCodec::LZ4:
+		{
+			return PakLZ4::Decompress(source, sourceSize, dest, destSize);
+		}
+#if defined(PAK_ZSTD)
+		case PakCodec::Zstd:
+		{
+			ZstdContexts& contexts = s_ZstdContexts;
+			if (contexts.m_Decompress == nullptr && (contexts.m_Decompress = ZSTD_createDCtx()) == nullptr)
+			{
+				return false;
+			}
+
+			size_t result = ZSTD_decompressDCtx(contexts.m_Decompress, dest, destSize, source, sourceSize);
+			return ZSTD_isError(result) == false && result == destSize;
+		}
+#endif
+		default: return false;
+	}
+}
@@ -1,10 +1,20 @@
 #include "FileSystem/Pak/PakFile.h"
 #include "FileSystem/Pak/PakArchive.h"
-#include "FileSystem/File/BinaryFile.h"
 #include "System/Assert.h"
-//#include "Zlib/Include/zlib.h"
+#include "System/ThreadPool.h"
+#include "System/Hash64.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
-PakFile::PakFile(const std::string& path, PakArchive* archive, PakEntry* entry) : BaseFile(path, FileMode::Read, FileType::Binary)
+// Runs shorter than this decode on the reading thread, waking the pool costs more than it saves
+static const u32 s_ParallelChunks = 4;
+
+// Decoded chunks kept for small/partial reads, 256KB per open compressed file however big the
+// entry is. Seeking back within the window is free, further back just re-decodes that chunk.
+static const u32 s_WindowChunks = 4;
+
+PakFile::PakFile(const std::string& path, PakArchive* archive, const PakEntry* entry) : BaseFile(path, FileMode::Read, FileType::Binary)
 {
 	m_Archive	= archive;
 	m_Entry		= entry;
@@ -12,7 +22,12 @@ PakFile::PakFile(const std::string& path, PakArchive* archive, PakEntry* entry)
 
 void PakFile::Close()
 {
-	m_UncompressedData.clear();
+	m_ChunkTable.clear();
+	m_DeltaChunks.clear();
+	m_Window.clear();
+	m_WindowChunks.clear();
+	m_WindowUse.clear();
+	m_CompressedChunk.clear();
 	m_Open = false;
 }
 
@@ -30,26 +45,173 @@ bool PakFile::Read(u8* data, u32 count)
 		return false;
 	}
 
-	// I think by default i may just read the entire binary blob into memory to prevent multi-threaded seeks
-	// in the archieve?
-	if (m_Entry->m_Compressed)
+	// Stored delta entries still go through the chunks, half of them live in the base
+	if (m_Entry->m_Codec == PakCodec::None && (m_Entry->m_Flags & PAK_ENTRY_DELTA) == 0)
 	{
-		if (CacheUncompressedData() == false)
+		if (m_Archive->LazyVerify() && m_Archive->VerifyOnce(*m_Entry) == false)
+		{
+			return false;
+		}
+
+		if (m_Archive->ReadFrom(data, m_Entry->m_Offset + m_FilePosition, size) == false)
 		{
 			return false;
 		}
 
-		memcpy(data, m_UncompressedData.data() + m_FilePosition, size);
+		m_FilePosition += size;
+		return true;
 	}
-	else
+
+	if (LoadChunkTable() == false)
 	{
-		assert(m_Archive->ArchiveFile()->ReadFrom(data, m_Entry->m_Offset + m_FilePosition, count));
+		return false;
+	}
+
+	// Only decode the chunks the read touches, whole chunks go straight into the callers
+	// buffer and only the partial ones at either end go through the window.
+	u32 position = (u32)m_FilePosition;
+	u32 remaining = (u32)size;
+	while (remaining > 0)
+	{
+		u32 chunk		= position / PAK_CHUNK_SIZE;
+		u32 chunkStart	= chunk * PAK_CHUNK_SIZE;
+		u32 chunkSize	= std::min((u32)PAK_CHUNK_SIZE, m_Entry->m_UncompressedSize - chunkStart);
+		u32 offset		= position - chunkStart;
+		u32 bytes		= std::min(remaining, chunkSize - offset);
+
+		// Whole chunks from here on, the last one counts if the read runs too the end of the file
+		u32 end			= position + remaining;
+		u32 endChunk	= (end == m_Entry->m_UncompressedSize) ? (end + PAK_CHUNK_SIZE - 1) / PAK_CHUNK_SIZE : end / PAK_CHUNK_SIZE;
+		u32 wholeChunks = (offset == 0 && endChunk > chunk) ? endChunk - chunk : 0;
+
+		if (wholeChunks >= s_ParallelChunks && m_Archive->DecodePool() != nullptr)
+		{
+			// Every chunk lands in its own slot of data, so they can all decode at once
+			bytes = std::min(endChunk * PAK_CHUNK_SIZE, m_Entry->m_UncompressedSize) - position;
+			if (DecodeChunks(chunk, wholeChunks, data) == false)
+			{
+				return false;
+			}
+		}
+		else if (offset == 0 && bytes == chunkSize)
+		{
+			if (DecodeChunk(chunk, data, m_CompressedChunk) == false)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			const Byte* decoded = WindowChunk(chunk);
+			if (decoded == nullptr)
+			{
+				return false;
+			}
+
+			memcpy(data, decoded + offset, bytes);
+		}
+
+		data		+= bytes;
+		position	+= bytes;
+		remaining	-= bytes;
 	}
 
-	m_FilePosition += count;
+	m_FilePosition = (int)position;
 	return true;
 }
 
+bool PakFile::ReadFrom(u8* data, u32 origin, u32 count)
+{
+	if (origin > m_Entry->m_UncompressedSize)
+	{
+		return false;
+	}
+
+	m_FilePosition = (int)origin;
+	return Read(data, count);
+}
+
+u8 PakFile::ReadByte()
+{
+	u8 byte = 0;
+	Read(&byte, sizeof(byte));
+	return byte;
+}
+
+u16 PakFile::ReadWord()
+{
+	Byte byte[2] = {};
+	Read(byte, sizeof(byte));
+	return (byte[0] | byte[1] << 8);
+}
+
+u32 PakFile::ReadDword()
+{
+	Byte byte[4] = {};
+	Read(byte, sizeof(byte));
+	return (byte[0] | byte[1] << 8 | byte[2] << 16 | byte[3] << 24);
+}
+
+float PakFile::ReadFloat()
+{
+	float value = 0;
+	Read((Byte*)&value, sizeof(value));
+	return value;
+}
+
+std::string PakFile::ReadString()
+{
+	// Matches BinaryFile::WriteString, length includes the null terminator
+	std::string string;
+	u32 n = ReadDword();
+	if (n > 0 && (u32)m_FilePosition + n <= m_Entry->m_UncompressedSize)
+	{
+		string.resize(n);
+		Read((Byte*)&string[0], n);
+		if (string.back() == '\0')
+		{
+			string.pop_back();
+		}
+	}
+	return string;
+}
+
+void PakFile::Seek(u32 origin, u32 offset)
+{
+	int base = 0;
+	if (origin == SEEK_CUR)
+	{
+		base = m_FilePosition;
+	}
+	else if (origin == SEEK_END)
+	{
+		base = (int)m_Entry->m_UncompressedSize;
+	}
+
+	// Offset is really signed for SEEK_CUR/SEEK_END
+	int position = base + (int)offset;
+	if (position < 0)
+	{
+		position = 0;
+	}
+	else if (position > (int)m_Entry->m_UncompressedSize)
+	{
+		position = (int)m_Entry->m_UncompressedSize;
+	}
+
+	m_FilePosition = position;
+}
+
+void PakFile::SeekStart()
+{
+	m_FilePosition = 0;
+}
+
+void PakFile::SeekEnd()
+{
+	m_FilePosition = (int)m_Entry->m_UncompressedSize;
+}
+
 int PakFile::FilePosition() const
 {
 	return m_FilePosition;
@@ -60,32 +222,149 @@ bool PakFile::IsEndOfFile()
 	return (m_FilePosition >= (int)m_Entry->m_UncompressedSize);
 }
 
-bool PakFile::CacheUncompressedData()
+bool PakFile::LoadChunkTable()
+{
+	if (m_ChunkTable.empty() == false || m_DeltaChunks.empty() == false)
+	{
+		return true;
+	}
+
+	u32 chunkCount = (m_Entry->m_UncompressedSize + PAK_CHUNK_SIZE - 1) / PAK_CHUNK_SIZE;
+	if (m_Entry->m_Flags & PAK_ENTRY_DELTA)
+	{
+		return LoadDeltaTable(chunkCount);
+	}
+
+	// Table is (chunks + 1) offsets so the last chunk knows where it ends, then the chunk checksums.
+	m_ChunkTable.resize(chunkCount * 2 + 1);
+	if (m_Archive->ReadFrom((Byte*)m_ChunkTable.data(), m_Entry->m_Offset, (u32)(m_ChunkTable.size() * sizeof(u32))) == false ||
+		m_ChunkTable[chunkCount] != m_Entry->m_CompressedSize)
+	{
+		m_ChunkTable.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool PakFile::LoadDeltaTable(u32 chunkCount)
 {
-	if (m_UncompressedData.size() == 0 && m_Archive)
+	u32 count = 0;
+	if (m_Archive->ReadFrom((Byte*)&count, m_Entry->m_Offset, sizeof(u32)) == false || count != chunkCount)
+	{
+		return false;
+	}
+
+	m_DeltaChunks.resize(chunkCount);
+	if (m_Archive->ReadFrom((Byte*)m_DeltaChunks.data(), m_Entry->m_Offset + sizeof(u32), (u32)(chunkCount * sizeof(PakDeltaChunk))) == false)
 	{
-		std::vector<u8> tempBuffer;
-		tempBuffer.resize(m_Entry->m_CompressedSize);
+		m_DeltaChunks.clear();
+		return false;
+	}
 
-		if (m_Archive->ArchiveFile()->ReadFrom(tempBuffer.data(), m_Entry->m_Offset, m_Entry->m_CompressedSize) == false)
+	// Chunks in the patch have too stay inside the entry, base ones are range checked on read
+	for (const PakDeltaChunk& chunk : m_DeltaChunks)
+	{
+		if (chunk.m_FromBase == 0 && (u64)chunk.m_Offset + chunk.m_Size > m_Entry->m_CompressedSize)
 		{
+			m_DeltaChunks.clear();
 			return false;
 		}
+	}
+
+	return chunkCount > 0;
+}
 
-		// We shouldnt need this?
-		if (m_Entry->m_Compressed == false)
+bool PakFile::DecodeChunk(u32 chunk, Byte* destination, std::vector<u8>& staging) const
+{
+	u32 chunkSize	= std::min((u32)PAK_CHUNK_SIZE, m_Entry->m_UncompressedSize - chunk * PAK_CHUNK_SIZE);
+	PakArchive* archive = m_Archive;
+	u32 offset		= 0;
+	u32 packedSize	= 0;
+	u32 checksum	= 0;
+
+	if (m_DeltaChunks.empty() == false)
+	{
+		const PakDeltaChunk& delta = m_DeltaChunks[chunk];
+		archive		= delta.m_FromBase ? m_Archive->Base() : m_Archive;
+		offset		= delta.m_FromBase ? delta.m_Offset : m_Entry->m_Offset + delta.m_Offset;
+		packedSize	= delta.m_Size;
+		checksum	= delta.m_Checksum;
+	}
+	else
+	{
+		// Checksum sits after the (chunks + 1) offsets
+		u32 chunkCount = (u32)m_ChunkTable.size() / 2;
+		offset		= m_Entry->m_Offset + m_ChunkTable[chunk];
+		packedSize	= m_ChunkTable[(size_t)chunk + 1] - m_ChunkTable[chunk];
+		checksum	= m_ChunkTable[(size_t)chunkCount + 1 + chunk];
+	}
+
+	// Mapped archives decode straight out of the page cache, otherwise stage the compressed bytes.
+	const Byte* source = archive->MappedData(offset, packedSize);
+	if (source == nullptr)
+	{
+		staging.resize(packedSize);
+		if (archive->ReadFrom(staging.data(), offset, packedSize) == false)
 		{
-			tempBuffer.swap(m_UncompressedData);
+			return false;
 		}
 
-// I need to finish this with ZLib compression libary
-		m_UncompressedData.resize(m_Entry->m_UncompressedSize);
-		if (true)
+		source = staging.data();
+	}
+
+	if (m_Archive->LazyVerify() && (u32)Hash64::ComputeHash(source, packedSize) != checksum)
+	{
+		return false;
+	}
+
+	// Chunks that didnt shrink are stored raw
+	PakCodec codec = (packedSize == chunkSize) ? PakCodec::None : m_Entry->m_Codec;
+	return PakCompression::Decompress(codec, source, packedSize, destination, chunkSize);
+}
+
+bool PakFile::DecodeChunks(u32 firstChunk, u32 count, Byte* destination) const
+{
+	return m_Archive->DecodePool()->ParallelFor(count, [this, firstChunk, destination](u32 index)
+	{
+		// Each thread stages its own compressed bytes when the archive isnt mapped
+		static thread_local std::vector<u8> staging;
+		return DecodeChunk(firstChunk + index, destination + (size_t)index * PAK_CHUNK_SIZE, staging);
+	});
+}
+
+const Byte* PakFile::WindowChunk(u32 chunk)
+{
+	size_t slot = m_WindowChunks.size();
+	for (size_t i = 0; i < m_WindowChunks.size(); ++i)
+	{
+		if (m_WindowChunks[i] == (int)chunk)
 		{
-			//uLongf sizeUncompressed = m_Entry->m_UncompressedSize;
-			//uLongf sizeCompressed	= m_Entry->m_CompressedSize;
-			//assert(uncompress(m_UncompressedData.data(), &sizeUncompressed, tempBuffer.data(), sizeCompressed) == Z_OK);
+			m_WindowUse[i] = ++m_UseCount;
+			return m_Window.data() + i * PAK_CHUNK_SIZE;
 		}
 	}
-	return true;
+
+	// Grow one slot at a time so small files never pay for the whole window
+	if (slot < s_WindowChunks)
+	{
+		m_Window.resize((slot + 1) * PAK_CHUNK_SIZE);
+		m_WindowChunks.push_back(-1);
+		m_WindowUse.push_back(0);
+	}
+	else
+	{
+		slot = std::min_element(m_WindowUse.begin(), m_WindowUse.end()) - m_WindowUse.begin();
+	}
+
+	m_WindowChunks[slot] = -1;
+	Byte* destination = m_Window.data() + slot * PAK_CHUNK_SIZE;
+	if (DecodeChunk(chunk, destination, m_CompressedChunk) == false)
+	{
+		return nullptr;
+	}
+
+	m_WindowChunks[slot] = (int)chunk;
+	m_WindowUse[slot] = ++m_UseCount;
+	return destination;
 }
@@ -0,0 +1,345 @@
+#include "FileSystem/Pak/PakFileSystem.h"
+#include "FileSystem/Pak/PakFile.h"
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/Path.h"
+#include "System/Hash32.h"
+#include <algorithm>
+
+bool PakFileSystem::Mount(const std::string& path, int priority, bool useMapping)
+{
+	return MountArchive(path, priority, useMapping, nullptr);
+}
+
+bool PakFileSystem::Mount(const std::string& path, const std::string& basePath, int priority, bool useMapping)
+{
+	MountedArchive* base = FindMount(basePath);
+	return base != nullptr && MountArchive(path, priority, useMapping, base->m_Archive.get());
+}
+
+bool PakFileSystem::MountArchive(const std::string& path, int priority, bool useMapping, PakArchive* base)
+{
+	if (FindMount(path) != nullptr)
+	{
+		return false;
+	}
+
+	std::unique_ptr<MountedArchive> mount = std::make_unique<MountedArchive>();
+	mount->m_Archive = std::make_unique<PakArchive>(path, useMapping);
+	mount->m_Archive->SetBase(base);
+	mount->m_Path = path;
+	mount->m_Priority = priority;
+	mount->m_Order = m_NextOrder++;
+	mount->m_UseMapping = useMapping;
+	if (mount->m_Archive->Mount([this](u64 directoryID) { return FindBase(directoryID); }) == false)
+	{
+		return false;
+	}
+
+	// In the list first, a patch hides base files through it
+	m_Archives.push_back(std::move(mount));
+	AddToIndex(m_Archives.back().get());
+	return true;
+}
+
+bool PakFileSystem::Unmount(const std::string& path)
+{
+	// Patches read through their base, it has too outlive them
+	MountedArchive* mount = FindMount(path);
+	if (mount == nullptr || HasPatchOn(mount->m_Archive.get()))
+	{
+		return false;
+	}
+
+	// Pull it out of the list first so RemoveFromIndex only falls back onto the others
+	auto itr = std::find_if(m_Archives.begin(), m_Archives.end(), [mount](const std::unique_ptr<MountedArchive>& m) { return m.get() == mount; });
+	std::unique_ptr<MountedArchive> removed = std::move(*itr);
+	m_Archives.erase(itr);
+
+	RemoveFromIndex(removed.get());
+	return true;
+}
+
+bool PakFileSystem::Remount(const std::string& path)
+{
+	MountedArchive* mount = FindMount(path);
+	if (mount == nullptr || HasPatchOn(mount->m_Archive.get()))
+	{
+		return false;
+	}
+
+	// Mount the new copy before dropping the old, a bad patch leaves the old one live.
+	// IsMapped is false when mapping was asked for but failed, so use what Mount was given.
+	std::unique_ptr<PakArchive> archive = std::make_unique<PakArchive>(path, mount->m_UseMapping);
+	archive->SetBase(mount->m_Archive->Base());
+	if (archive->Mount([this](u64 directoryID) { return FindBase(directoryID); }) == false)
+	{
+		return false;
+	}
+
+	RemoveFromIndex(mount);
+	mount->m_Archive = std::move(archive);
+	AddToIndex(mount);
+	return true;
+}
+
+bool PakFileSystem::IsMounted(const std::string& path) const
+{
+	return FindMount(path) != nullptr;
+}
+
+void PakFileSystem::SetLooseRoot(const std::string& root)
+{
+	m_LooseRoot = root;
+	if (m_LooseRoot.empty() == false && m_LooseRoot.back() != '\\')
+	{
+		m_LooseRoot += "\\";
+	}
+}
+
+bool PakFileSystem::HasFile(const std::string& path) const
+{
+	if (HasFile(Hash32::ComputeHash((const Byte*)path.c_str(), (u32)path.length())))
+	{
+		return true;
+	}
+
+	return m_LooseRoot.empty() == false && Path::FileExists(m_LooseRoot + path);
+}
+
+bool PakFileSystem::HasFile(u32 hashID) const
+{
+	return m_Index.find(hashID) != m_Index.end();
+}
+
+PakArchive* PakFileSystem::FindArchive(u32 hashID, const PakEntry** entry) const
+{
+	auto itr = m_Index.find(hashID);
+	if (itr == m_Index.end())
+	{
+		return nullptr;
+	}
+
+	if (entry != nullptr)
+	{
+		*entry = itr->second.m_Entry;
+	}
+	return itr->second.m_Mount->m_Archive.get();
+}
+
+std::unique_ptr<PakFile> PakFileSystem::GetPakFile(u32 hashID)
+{
+	PakArchive* archive = FindArchive(hashID);
+	return archive ? archive->GetPakFile(hashID) : nullptr;
+}
+
+bool PakFileSystem::ReadFile(const std::string& path, std::vector<u8>& data)
+{
+	if (ReadFile(Hash32::ComputeHash((const Byte*)path.c_str(), (u32)path.length()), data))
+	{
+		return true;
+	}
+
+	if (m_LooseRoot.empty() || Path::FileExists(m_LooseRoot + path) == false)
+	{
+		return false;
+	}
+
+	BinaryFile file(m_LooseRoot + path, FileMode::Read);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	data.resize((size_t)file.FileSize());
+	return data.empty() || file.Read(data.data(), (u32)data.size());
+}
+
+bool PakFileSystem::ReadFile(u32 hashID, std::vector<u8>& data)
+{
+	const PakEntry* entry = nullptr;
+	PakArchive* archive = FindArchive(hashID, &entry);
+	if (archive == nullptr)
+	{
+		return false;
+	}
+
+	std::unique_ptr<PakFile> file = archive->GetPakFile(hashID);
+	data.resize(entry->m_UncompressedSize);
+	return data.empty() || file->Read(data.data(), (u32)data.size());
+}
+
+PakFileSystem::MountedArchive* PakFileSystem::FindMount(const std::string& path) const
+{
+	for (const std::unique_ptr<MountedArchive>& mount : m_Archives)
+	{
+		if (mount->m_Path == path)
+		{
+			return mount.get();
+		}
+	}
+
+	return nullptr;
+}
+
+PakFileSystem::MountedArchive* PakFileSystem::FindMount(const PakArchive* archive) const
+{
+	for (const std::unique_ptr<MountedArchive>& mount : m_Archives)
+	{
+		if (archive != nullptr && mount->m_Archive.get() == archive)
+		{
+			return mount.get();
+		}
+	}
+
+	return nullptr;
+}
+
+PakArchive* PakFileSystem::FindBase(u64 directoryID) const
+{
+	for (const std::unique_ptr<MountedArchive>& mount : m_Archives)
+	{
+		if (mount->m_Archive->IsPatch() == false && mount->m_Archive->DirectoryID() == directoryID)
+		{
+			return mount->m_Archive.get();
+		}
+	}
+
+	return nullptr;
+}
+
+bool PakFileSystem::HasPatchOn(const PakArchive* base) const
+{
+	for (const std::unique_ptr<MountedArchive>& mount : m_Archives)
+	{
+		if (mount->m_Archive->Base() == base)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool PakFileSystem::Outranks(const MountedArchive* a, const MountedArchive* b) const
+{
+	if (a->m_Priority != b->m_Priority)
+	{
+		return a->m_Priority > b->m_Priority;
+	}
+	return a->m_Order > b->m_Order;
+}
+
+bool PakFileSystem::IsHidden(const MountedArchive* mount, u32 hashID, const MountedArchive* skip) const
+{
+	// A patch lists every file of the new version, anything of its base it leaves out was deleted
+	for (const std::unique_ptr<MountedArchive>& patch : m_Archives)
+	{
+		if (patch.get() != skip && patch->m_Archive->Base() == mount->m_Archive.get() && Outranks(patch.get(), mount) &&
+			patch->m_Archive->FindEntry(hashID) == nullptr)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PakFileSystem::Reindex(u32 hashID, const MountedArchive* skip)
+{
+	// Best visible archive that has the id (if any), skip is on its way out
+	IndexEntry best;
+	for (const std::unique_ptr<MountedArchive>& other : m_Archives)
+	{
+		const PakEntry* entry = nullptr;
+		if (other.get() == skip || (entry = other->m_Archive->FindEntry(hashID)) == nullptr || IsHidden(other.get(), hashID, skip))
+		{
+			continue;
+		}
+
+		if (best.m_Mount == nullptr || Outranks(other.get(), best.m_Mount))
+		{
+			best.m_Mount = other.get();
+			best.m_Entry = entry;
+		}
+	}
+
+	if (best.m_Mount != nullptr)
+	{
+		m_Index[hashID] = best;
+	}
+	else
+	{
+		m_Index.erase(hashID);
+	}
+}
+
+void PakFileSystem::AddToIndex(MountedArchive* mount)
+{
+	const PakArchive* archive = mount->m_Archive.get();
+	const PakEntry* entries = archive->Entries();
+	m_Index.reserve(m_Index.size() + archive->FileCount());
+
+	for (u32 i = 0; i < archive->FileCount(); ++i)
+	{
+		if (IsHidden(mount, entries[i].m_HashID, nullptr))
+		{
+			continue;
+		}
+
+		IndexEntry& slot = m_Index[entries[i].m_HashID];
+		if (slot.m_Mount == nullptr || Outranks(mount, slot.m_Mount))
+		{
+			slot.m_Mount = mount;
+			slot.m_Entry = &entries[i];
+		}
+	}
+
+	// Files the patch deleted from its base stop resolving too the base
+	MountedArchive* base = FindMount(archive->Base());
+	if (base == nullptr || Outranks(mount, base) == false)
+	{
+		return;
+	}
+
+	const PakEntry* baseEntries = base->m_Archive->Entries();
+	for (u32 i = 0; i < base->m_Archive->FileCount(); ++i)
+	{
+		auto itr = m_Index.find(baseEntries[i].m_HashID);
+		if (itr != m_Index.end() && itr->second.m_Mount == base && archive->FindEntry(baseEntries[i].m_HashID) == nullptr)
+		{
+			Reindex(baseEntries[i].m_HashID, nullptr);
+		}
+	}
+}
+
+void PakFileSystem::RemoveFromIndex(MountedArchive* mount)
+{
+	const PakArchive* archive = mount->m_Archive.get();
+	const PakEntry* entries = archive->Entries();
+
+	for (u32 i = 0; i < archive->FileCount(); ++i)
+	{
+		// This archive owned the id, hand it too the next best one that has it (if any).
+		auto itr = m_Index.find(entries[i].m_HashID);
+		if (itr != m_Index.end() && itr->second.m_Mount == mount)
+		{
+			Reindex(entries[i].m_HashID, mount);
+		}
+	}
+
+	// Base files this patch deleted come back
+	MountedArchive* base = FindMount(archive->Base());
+	if (base == nullptr)
+	{
+		return;
+	}
+
+	const PakEntry* baseEntries = base->m_Archive->Entries();
+	for (u32 i = 0; i < base->m_Archive->FileCount(); ++i)
+	{
+		if (archive->FindEntry(baseEntries[i].m_HashID) == nullptr)
+		{
+			Reindex(baseEntries[i].m_HashID, mount);
+		}
+	}
+}
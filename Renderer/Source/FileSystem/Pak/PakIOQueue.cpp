@@ -0,0 +1,199 @@
+#include "FileSystem/Pak/PakIOQueue.h"
+#include "FileSystem/Pak/PakArchive.h"
+#include "FileSystem/Pak/PakFile.h"
+#include <algorithm>
+
+PakBatch::PakBatch(u32 count) : m_Remaining(count), m_Failed(0)
+{
+	m_Future = m_Promise.get_future().share();
+	if (count == 0)
+	{
+		m_Promise.set_value(true);
+	}
+}
+
+bool PakBatch::IsComplete() const
+{
+	return m_Remaining.load() == 0;
+}
+
+bool PakBatch::Wait() const
+{
+	return m_Future.get();
+}
+
+u32 PakBatch::FailedCount() const
+{
+	return m_Failed.load();
+}
+
+void PakBatch::Complete(bool success)
+{
+	if (success == false)
+	{
+		++m_Failed;
+	}
+
+	// Last one out fulfils the future
+	if (--m_Remaining == 0)
+	{
+		m_Promise.set_value(m_Failed.load() == 0);
+	}
+}
+
+PakIOQueue::PakIOQueue(PakArchive* archive, u32 threadCount)
+{
+	m_Archive = archive;
+	m_Running = true;
+
+	threadCount = std::max(threadCount, 1u);
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		m_Threads.emplace_back(&PakIOQueue::WorkerThread, this);
+	}
+}
+
+PakIOQueue::~PakIOQueue()
+{
+	Shutdown();
+}
+
+std::shared_ptr<PakBatch> PakIOQueue::Submit(const std::vector<PakRequest>& requests)
+{
+	std::shared_ptr<PakBatch> batch = std::make_shared<PakBatch>((u32)requests.size());
+	std::vector<Job> failed;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		for (const PakRequest& request : requests)
+		{
+			Job job;
+			job.m_Request = request;
+			job.m_Batch = batch;
+
+			const PakEntry* entry = m_Archive->FindEntry(request.m_HashID);
+			if (entry == nullptr || request.m_Destination == nullptr || m_Running == false)
+			{
+				failed.push_back(std::move(job));
+				continue;
+			}
+
+			job.m_Offset = entry->m_Offset;
+			m_Jobs.push_back(std::move(job));
+		}
+
+		// Highest priority first, then lowest offset so the disk mostly reads forwards.
+		std::sort(m_Jobs.begin(), m_Jobs.end(), [](const Job& a, const Job& b)
+		{
+			if (a.m_Request.m_Priority != b.m_Request.m_Priority)
+			{
+				return a.m_Request.m_Priority < b.m_Request.m_Priority;
+			}
+			return a.m_Offset > b.m_Offset;
+		});
+	}
+
+	m_Signal.notify_all();
+
+	// Report bad requests outside the lock, callbacks may well submit more work.
+	FailJobs(failed);
+	return batch;
+}
+
+u32 PakIOQueue::Cancel(u32 belowPriority)
+{
+	std::vector<Job> cancelled;
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		auto itr = std::stable_partition(m_Jobs.begin(), m_Jobs.end(), [belowPriority](const Job& job)
+		{
+			return job.m_Request.m_Priority < belowPriority;
+		});
+
+		cancelled.assign(std::make_move_iterator(m_Jobs.begin()), std::make_move_iterator(itr));
+		m_Jobs.erase(m_Jobs.begin(), itr);
+	}
+
+	FailJobs(cancelled);
+	return (u32)cancelled.size();
+}
+
+u32 PakIOQueue::CancelAll()
+{
+	std::vector<Job> cancelled;
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		cancelled.swap(m_Jobs);
+	}
+
+	FailJobs(cancelled);
+	return (u32)cancelled.size();
+}
+
+void PakIOQueue::FailJobs(std::vector<Job>& jobs)
+{
+	for (Job& job : jobs)
+	{
+		if (job.m_Request.m_OnComplete)
+		{
+			job.m_Request.m_OnComplete(job.m_Request, false);
+		}
+		job.m_Batch->Complete(false);
+	}
+}
+
+void PakIOQueue::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		if (m_Running == false)
+		{
+			return;
+		}
+		m_Running = false;
+	}
+
+	m_Signal.notify_all();
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+	m_Threads.clear();
+
+	// Anything left never ran, fail it so nobody waits forever.
+	CancelAll();
+}
+
+void PakIOQueue::WorkerThread()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_Lock);
+			m_Signal.wait(lock, [this]() { return m_Running == false || m_Jobs.empty() == false; });
+			if (m_Running == false)
+			{
+				return;
+			}
+
+			job = std::move(m_Jobs.back());
+			m_Jobs.pop_back();
+		}
+
+		Execute(job);
+	}
+}
+
+void PakIOQueue::Execute(Job& job)
+{
+	std::unique_ptr<PakFile> file = m_Archive->GetPakFile(job.m_Request.m_HashID);
+	const PakEntry* entry = m_Archive->FindEntry(job.m_Request.m_HashID);
+	bool success = entry->m_UncompressedSize == 0 || file->Read(job.m_Request.m_Destination, entry->m_UncompressedSize);
+
+	if (job.m_Request.m_OnComplete)
+	{
+		job.m_Request.m_OnComplete(job.m_Request, success);
+	}
+	job.m_Batch->Complete(success);
+}
@@ -0,0 +1,57 @@
+#include "FileSystem/Pak/PakLZ4.h"
+
+#if defined(PAK_LZ4)
+#include "lz4/lz4.h"
+#include "lz4/lz4hc.h"
+#include <algorithm>
+
+u32 PakLZ4::CompressBound(u32 size)
+{
+	// 0 when size is past LZ4_MAX_INPUT_SIZE
+	return (size <= LZ4_MAX_INPUT_SIZE) ? (u32)LZ4_compressBound((int)size) : 0;
+}
+
+u32 PakLZ4::Compress(const Byte* source, u32 sourceSize, Byte* dest, u32 destCapacity, int level)
+{
+	if (sourceSize > LZ4_MAX_INPUT_SIZE)
+	{
+		return 0;
+	}
+
+	int capacity = (int)std::min(destCapacity, (u32)INT32_MAX);
+	int result = (level > 0) ?
+		LZ4_compress_HC((const char*)source, (char*)dest, (int)sourceSize, capacity, std::min(level, LZ4HC_CLEVEL_MAX)) :
+		LZ4_compress_default((const char*)source, (char*)dest, (int)sourceSize, capacity);
+	return (result > 0) ? (u32)result : 0;
+}
+
+bool PakLZ4::Decompress(const Byte* source, u32 sourceSize, Byte* dest, u32 destSize)
+{
+	if (sourceSize > INT32_MAX || destSize > INT32_MAX)
+	{
+		return false;
+	}
+
+	int result = LZ4_decompress_safe((const char*)source, (char*)dest, (int)sourceSize, (int)destSize);
+	return result >= 0 && (u32)result == destSize;
+}
+
+#else
+
+// Built without the lz4 sources, PakCompression::IsSupported already says so
+u32 PakLZ4::CompressBound(u32 size)
+{
+	return 0;
+}
+
+u32 PakLZ4::Compress(const Byte* source, u32 sourceSize, Byte* dest, u32 destCapacity, int level)
+{
+	return 0;
+}
+
+bool PakLZ4::Decompress(const Byte* source, u32 sourceSize, Byte* dest, u32 destSize)
+{
+	return false;
+}
+
+#endif
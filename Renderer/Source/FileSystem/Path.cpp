@@ -66,6 +66,58 @@ bool Path::DirectoryExists(const std::string& path)
 	return false;
 }
 
+std::vector<std::string> Path::GetFiles(const std::string& directory, bool recursive)
+{
+	std::vector<std::string> files;
+	std::vector<std::string> folders = { directory };
+
+#ifdef WIN32
+	while (folders.empty() == false)
+	{
+		std::string folder = folders.back();
+		folders.pop_back();
+
+		if (folder.empty() == false && folder.back() != '\\')
+		{
+			folder += "\\";
+		}
+
+		WIN32_FIND_DATA data;
+		HANDLE find = FindFirstFile(StringUtil::Widen(folder + "*").c_str(), &data);
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			continue;
+		}
+
+		do
+		{
+			std::string name = StringUtil::Narrow(data.cFileName);
+			if (name == "." || name == "..")
+			{
+				continue;
+			}
+
+			if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				if (recursive)
+				{
+					folders.push_back(folder + name);
+				}
+			}
+			else
+			{
+				files.push_back(folder + name);
+			}
+		} while (FindNextFile(find, &data));
+
+		FindClose(find);
+	}
+#endif // WIN32
+	// Do Switch, Xbox, Psx so on...
+
+	return files;
+}
+
 std::string Path::GameDirectory()
 {
 	return ".\\Game\\";
@@ -0,0 +1,178 @@
+#include "FileSystem/Serialize.h"
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/Pak/PakFile.h"
+#include "Math/Quaternion.h"
+#include "Math/Matrix4.h"
+#include "Graphics/Common/VertexFormats.h"
+#include <cstring>
+
+// The hand listed IsBitwise types go too disk as raw floats and get swapped 4 bytes at a
+// time, so they have too be nothing but floats with no padding. A vertex also has too match
+// the stride its VertexFormat claims. VertexSkimmedMesh isnt listed, nothing cooks skinned
+// vertices yet and its 88 bytes dont match VertexFormat::VertexSkimmedMesh.
+static_assert(sizeof(Vector2) == 2 * sizeof(float), "Vector2 has too be packed floats");
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 has too be packed floats");
+static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 has too be packed floats");
+static_assert(sizeof(Color) == 4 * sizeof(float), "Color has too be packed floats");
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "Quaternion has too be packed floats");
+static_assert(sizeof(Matrix4) == 16 * sizeof(float), "Matrix4 has too be packed floats");
+static_assert(sizeof(Vertex) == sizeof(Vector3) && sizeof(Vertex) == (size_t)VertexFormat::Vertex, "Vertex layout changed");
+static_assert(sizeof(VertexTexture) == sizeof(Vector3) + sizeof(Vector2) && sizeof(VertexTexture) == (size_t)VertexFormat::VertexTexture, "VertexTexture layout changed");
+static_assert(sizeof(VertexColor) == sizeof(Vector3) + sizeof(Color) && sizeof(VertexColor) == (size_t)VertexFormat::VertexColor, "VertexColor layout changed");
+static_assert(sizeof(VertexColorTexture) == sizeof(Vector3) + sizeof(Color) + sizeof(Vector2) && sizeof(VertexColorTexture) == (size_t)VertexFormat::VertexColorTexture, "VertexColorTexture layout changed");
+static_assert(sizeof(VertexNormal) == 2 * sizeof(Vector3) + sizeof(Color) + sizeof(Vector2) && sizeof(VertexNormal) == (size_t)VertexFormat::VertexNormal, "VertexNormal layout changed");
+static_assert(sizeof(VertexMesh) == 2 * sizeof(Vector3) + sizeof(Vector4) + sizeof(Color) + sizeof(Vector2) && sizeof(VertexMesh) == (size_t)VertexFormat::VertexMesh, "VertexMesh layout changed, bump MESH_VERSION");
+
+bool Archive::SerializeBytes(void* data, u32 size)
+{
+	if (m_Failed)
+	{
+		return false;
+	}
+
+	if (Transfer(data, size) == false)
+	{
+		return Fail();
+	}
+	return true;
+}
+
+BinaryFileArchive::BinaryFileArchive(BinaryFile& file) : Archive(file.Mode() == FileMode::Read), m_File(file)
+{
+	m_Failed = file.IsOpen() == false;
+	if (m_Loading && m_Failed == false)
+	{
+		m_Size = (u64)file.FileSize();
+	}
+}
+
+u64 BinaryFileArchive::Remaining() const
+{
+	if (m_Loading == false)
+	{
+		return UINT64_MAX;
+	}
+
+	u64 position = (u64)m_File.FilePosition();
+	return position < m_Size ? m_Size - position : 0;
+}
+
+bool BinaryFileArchive::Transfer(void* data, u32 size)
+{
+	if (m_Loading)
+	{
+		return m_File.Read((Byte*)data, size);
+	}
+	return m_File.Write((const Byte*)data, size);
+}
+
+PakFileArchive::PakFileArchive(PakFile& file, u32 size) : Archive(true), m_File(file), m_Size(size)
+{
+}
+
+u64 PakFileArchive::Remaining() const
+{
+	u64 position = (u64)m_File.FilePosition();
+	return position < m_Size ? m_Size - position : 0;
+}
+
+bool PakFileArchive::Transfer(void* data, u32 size)
+{
+	return m_File.Read((u8*)data, size);
+}
+
+MemoryArchive::MemoryArchive(const Byte* data, u64 size) : Archive(true), m_Data(data), m_Size(size)
+{
+}
+
+MemoryArchive::MemoryArchive(std::vector<u8>& output) : Archive(false), m_Output(&output)
+{
+}
+
+u64 MemoryArchive::Remaining() const
+{
+	return m_Loading ? m_Size - m_Position : UINT64_MAX;
+}
+
+const Byte* MemoryArchive::View(u64 size)
+{
+	if (m_Failed || m_Loading == false || size > m_Size - m_Position)
+	{
+		Fail();
+		return nullptr;
+	}
+
+	const Byte* view = m_Data + m_Position;
+	m_Position += size;
+	return view;
+}
+
+bool MemoryArchive::Transfer(void* data, u32 size)
+{
+	if (m_Loading)
+	{
+		if (size > m_Size - m_Position)
+		{
+			return false;
+		}
+
+		memcpy(data, m_Data + m_Position, size);
+		m_Position += size;
+		return true;
+	}
+
+	const u8* bytes = (const u8*)data;
+	m_Output->insert(m_Output->end(), bytes, bytes + size);
+	return true;
+}
+
+bool SerializeHeader(Archive& archive, u32 magic, u32 latestVersion)
+{
+	u32 fileMagic = magic;
+	u32 version = latestVersion;
+	if (Serialize(archive, fileMagic) == false)
+	{
+		return false;
+	}
+
+	// Our magic backwards means the file was cooked on the other endian
+	if (archive.IsLoading() && fileMagic != magic && fileMagic == ByteSwap32(magic))
+	{
+		archive.SetSwapped(true);
+		fileMagic = magic;
+	}
+
+	if (Serialize(archive, version) == false)
+	{
+		return false;
+	}
+
+	// Cant know what a newer build added, so refuse rather than half load it
+	if (fileMagic != magic || version == 0 || version > latestVersion)
+	{
+		return archive.Fail();
+	}
+
+	archive.SetVersion(version);
+	return true;
+}
+
+bool Serialize(Archive& archive, std::string& value)
+{
+	u32 length = (u32)value.length();
+	if (Serialize(archive, length) == false)
+	{
+		return false;
+	}
+
+	if (archive.IsLoading())
+	{
+		if (length > archive.Remaining())
+		{
+			return archive.Fail();
+		}
+		value.resize(length);
+	}
+
+	return length == 0 || archive.SerializeBytes(&value[0], length);
+}
@@ -1,9 +1,11 @@
 #include "Resource/Mesh.h"
 #include "System/Assert.h"
+#include "Resource/MeshOptimizer.h"
 #include <System/Logger.h>
-#include "tinyobj/tiny_obj_loader.h"
-#include "System/Hash32.h"
-#include <unordered_map>
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/File/MappedFile.h"
+#include "FileSystem/Serialize.h"
+#include <algorithm>
 
 Mesh::Mesh()
 {
@@ -22,10 +24,20 @@ Mesh::Mesh(Mesh&& mesh) noexcept
 	m_Colors = std::move(mesh.m_Colors);
 	m_TexCords = std::move(mesh.m_TexCords);
 	m_PackedMesh = std::move(mesh.m_PackedMesh);
+	m_Mapping = std::move(mesh.m_Mapping);
+	m_VertexView = mesh.m_VertexView;
+	m_IndexView = mesh.m_IndexView;
+	m_BoundsMin = mesh.m_BoundsMin;
+	m_BoundsMax = mesh.m_BoundsMax;
+	mesh.m_VertexView = nullptr;
+	mesh.m_IndexView = nullptr;
 	m_VertexCount = mesh.m_VertexCount;
 	m_IndexCount = mesh.m_IndexCount;
 	m_IsReadable = mesh.m_IsReadable;
 	m_IsDirty = mesh.m_IsDirty;
+	m_IsPacked = mesh.m_IsPacked;
+	m_IndexFormat = mesh.m_IndexFormat;
+	m_VertexFormat = mesh.m_VertexFormat;
 }
 
 Mesh::~Mesh()
@@ -45,10 +57,20 @@ void Mesh::operator=(Mesh&& mesh) noexcept
 	m_Colors = std::move(mesh.m_Colors);
 	m_TexCords = std::move(mesh.m_TexCords);
 	m_PackedMesh = std::move(mesh.m_PackedMesh);
+	m_Mapping = std::move(mesh.m_Mapping);
+	m_VertexView = mesh.m_VertexView;
+	m_IndexView = mesh.m_IndexView;
+	m_BoundsMin = mesh.m_BoundsMin;
+	m_BoundsMax = mesh.m_BoundsMax;
+	mesh.m_VertexView = nullptr;
+	mesh.m_IndexView = nullptr;
 	m_VertexCount = mesh.m_VertexCount;
 	m_IndexCount = mesh.m_IndexCount;
 	m_IsReadable = mesh.m_IsReadable;
 	m_IsDirty = mesh.m_IsDirty;
+	m_IsPacked = mesh.m_IsPacked;
+	m_IndexFormat = mesh.m_IndexFormat;
+	m_VertexFormat = mesh.m_VertexFormat;
 }
 
 void Mesh::SetVertexData(Byte* data, u32 byteCount, u32 dataStart, u32 vertexStart)
@@ -236,6 +258,9 @@ void Mesh::ClearCpuData()
 	m_Colors.clear();
 	m_TexCords.clear();
 	m_PackedMesh.clear();
+	m_Mapping.reset();
+	m_VertexView = nullptr;
+	m_IndexView = nullptr;
 }
 
 // I disagree with how this works, but support it anyway.
@@ -365,73 +390,84 @@ void Mesh::RecalculateTangents()
 		return;
 	}
 
-	std::vector<Vector3> tangents(m_VertexCount, Vector3());
-	std::vector<Vector3> bitangents(m_VertexCount, Vector3());
+	m_Tangent.clear();
+	m_Tangent.resize(m_VertexCount, Vector4());
+	MeshCooker::ComputeTangents(m_Vertices.data(), m_Normals.data(), m_TexCords.data(), m_Tangent.data(), m_VertexCount, m_Indicies.data(), m_MeshParts);
+	m_IsDirty = true;
+}
 
-	// Loop each submesh, and each submehses triangles!
-	for (MeshPart mesh : m_MeshParts)
+void Mesh::OptimizeVertexCache()
+{
+	if (m_Indicies.empty())
 	{
-		for (u32 i = 0; i < mesh.m_Count; i += 3)
-		{
-			u64 index = mesh.m_Start + i;
+		LogError("Cannot Optimize Indices when indices are null.");
+		return;
+	}
 
-			//--Indices--
-			u32 i0 = m_Indicies[index];
-			u32 i1 = m_Indicies[(size_t)index + 1];
-			u32 i2 = m_Indicies[(size_t)index + 2];
+	MeshOptimizer::OptimizeVertexCache(m_Indicies.data(), m_VertexCount, m_MeshParts);
+	m_IsDirty = true;
+}
 
-			// Triangle
-			Vector3& p0 = m_Vertices[i0];
-			Vector3& p1 = m_Vertices[i1];
-			Vector3& p2 = m_Vertices[i2];
+void Mesh::OptimizeOverdraw(float threshold)
+{
+	if (m_Indicies.empty() || m_Vertices.size() < m_VertexCount)
+	{
+		LogError("Cannot Optimize Overdraw when vertices or indices are null.");
+		return;
+	}
 
-			//--Uv Edges--
-			Vector2 uv1 = m_TexCords[i1] - m_TexCords[i0];
-			Vector2 uv2 = m_TexCords[i2] - m_TexCords[i0];
+	MeshOptimizer::OptimizeOverdraw(m_Indicies.data(), m_Vertices.data(), m_VertexCount, m_MeshParts, threshold);
+	m_IsDirty = true;
+}
 
-			//--Triangle Edges--
-			Vector3 E1 = p1 - p0;
-			Vector3 E2 = p2 - p0;
+void Mesh::OptimizeVertexFetch()
+{
+	if (m_Indicies.empty() || m_Vertices.size() != m_VertexCount)
+	{
+		LogError("Cannot Optimize Vertex Fetch when vertices or indices are null.");
+		return;
+	}
 
-			//--Formula--
-			float r = 1.0f / (uv1.x * uv2.y - uv2.x * uv1.y);
-			Vector3 t = (E1 * uv2.y - E2 * uv1.y) * r;
-			Vector3 b = (E2 * uv1.x - E1 * uv2.x) * r;
+	std::vector<u32> remap(m_VertexCount);
+	MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), m_Indicies.data(), m_Indicies.size(), m_VertexCount);
+	MeshOptimizer::RemapIndices(m_Indicies.data(), m_Indicies.size(), remap.data());
 
-			// Accumulate for smoothing between shared vertexs
-			tangents[i0] += t;
-			tangents[i1] += t;
-			tangents[i2] += t;
+	// Streams that arent filled in yet get generated by PackMesh, in the new order anyway
+	MeshOptimizer::RemapVertices(m_Vertices, remap.data());
+	if (m_Normals.size() == m_VertexCount) { MeshOptimizer::RemapVertices(m_Normals, remap.data()); }
+	if (m_Tangent.size() == m_VertexCount) { MeshOptimizer::RemapVertices(m_Tangent, remap.data()); }
+	if (m_Colors.size() == m_VertexCount) { MeshOptimizer::RemapVertices(m_Colors, remap.data()); }
+	if (m_TexCords.size() == m_VertexCount) { MeshOptimizer::RemapVertices(m_TexCords, remap.data()); }
 
-			bitangents[i0] += b;
-			bitangents[i1] += b;
-			bitangents[i2] += b;
-		}
-	}
+	// The packed copy is in the old order
+	m_IsPacked = false;
+	m_IsDirty = true;
+}
 
-	m_Tangent.clear();
-	m_Tangent.resize(m_VertexCount, Vector4());
-	for (u32 i = 0; i < m_VertexCount; i++)
+void Mesh::RecalculateBounds()
+{
+	if (m_Vertices.empty())
 	{
-		Vector3 t = Vector3::Normalize(tangents[i]);
-		Vector3 b = Vector3::Normalize(bitangents[i]);
-		Vector3 n = Vector3::Normalize(m_Normals[i]);
-
-		// Ortho-normalize tangent
-		m_Tangent[i] = Vector3::Normalize(t - (n * Vector3::Dot(t, n)));
-
-		// Orthogonal bitangent checked agaisnt bitangent for direction.
-		m_Tangent[i].w = (Vector3::Dot(Vector3::Cross(t, b), n) > 0.0f) ? 1.0f : -1.0f;
+		LogError("Cannot Generate Bounds when vertices are null.");
+		return;
 	}
 
-	m_IsDirty = true;
+	m_BoundsMin = m_Vertices[0];
+	m_BoundsMax = m_Vertices[0];
+	for (const Vector3& vertex : m_Vertices)
+	{
+		m_BoundsMin = Vector3::Min(m_BoundsMin, vertex);
+		m_BoundsMax = Vector3::Max(m_BoundsMax, vertex);
+	}
 }
 
 void Mesh::Upload(bool markNoLongerReadable, GraphicsDevice* device, CommandList cmd)
 {
+	// Cooked meshes come straight from the file, theres no cpu copy too check
+	bool viewed = m_VertexView != nullptr;
 	if (m_VertexCount == 0) { LogError("No vertices to set."); return; }
-	if (m_Indicies.empty()) { LogError("No Indices to set."); return; }
-	if (m_IsReadable == false) { LogError("Cannot update non readable buffer"); return; }
+	if (viewed == false && m_Indicies.empty()) { LogError("No Indices to set."); return; }
+	if (viewed == false && m_IsReadable == false) { LogError("Cannot update non readable buffer"); return; }
 	if (m_IsDirty == false) { return; }
 
 	// Set Mesh Part to be entire mesh
@@ -449,7 +485,11 @@ void Mesh::Upload(bool markNoLongerReadable, GraphicsDevice* device, CommandList
 		m_VertexBuffer = GraphicsResource::CreateBuffer(device, HeapType::Default, m_VertexCount, (u32)m_VertexFormat, 0);
 	}
 
-	m_VertexBuffer->SetData(m_PackedMesh.data(), (u32)m_VertexFormat * m_VertexCount, 0, cmd);
+	// SetData only reads, it copies into the upload ring straight away
+	Byte* vertices = viewed ? (Byte*)m_VertexView : m_PackedMesh.data();
+	Byte* indices = viewed ? (Byte*)m_IndexView : (Byte*)m_Indicies.data();
+
+	m_VertexBuffer->SetData(vertices, (u32)m_VertexFormat * m_VertexCount, 0, cmd);
 
 	u32 stride = m_IndexFormat == IndexFormat::I16 ? 2 : 4;
 	// Create IndexBuffer
@@ -458,7 +498,7 @@ void Mesh::Upload(bool markNoLongerReadable, GraphicsDevice* device, CommandList
 		m_IndexBuffer = GraphicsResource::CreateBuffer(device, HeapType::Default, m_IndexCount, stride, 0);
 	}
 
-	m_IndexBuffer->SetData((byte*)m_Indicies.data(), m_Indicies.size() * stride, 0, cmd);
+	m_IndexBuffer->SetData(indices, (u64)m_IndexCount * stride, 0, cmd);
 
 	if (markNoLongerReadable)
 	{
@@ -497,6 +537,16 @@ u32 Mesh::MeshPartCount()const
 	return (u32)m_MeshParts.size();
 }
 
+Vector3 Mesh::BoundsMin()const
+{
+	return m_BoundsMin;
+}
+
+Vector3 Mesh::BoundsMax()const
+{
+	return m_BoundsMax;
+}
+
 std::shared_ptr<GraphicsResource> Mesh::VertexBuffer()
 {
 	return m_VertexBuffer;
@@ -513,9 +563,9 @@ Mesh Mesh::LoadFromFile(const std::string& fileName)
 	//--Get Extension--
 	std::string ext = fileName.c_str();
 	ext = ext.substr(ext.find_last_of(".") + 1);
-	for (int i = 0; i < 3; i++)
+	for (size_t i = 0; i < ext.length(); i++)
 	{
-		ext[i] = tolower(ext[i]);
+		ext[i] = (char)tolower(ext[i]);
 	}
 
 	if (ext == "obj")
@@ -524,164 +574,168 @@ Mesh Mesh::LoadFromFile(const std::string& fileName)
 	}
 	else if (ext == "mesh")
 	{
-		// RE ADD SUPPORT FOR CUSTOM FORMAT
-		//BinaryFile file;
-		//if (file.Open(fileName.c_str(), FileMode::Read))
-		//{
-		//	assert(file.ReadDword() == MESH_MAGIC && "Failed To Read Mesh.");
-		//	u32 vertexCount = file.ReadDword();
-		//	u32 indexCount = file.ReadDword();
-		//	VertexMesh* vertexData = new VertexMesh[vertexCount];
-		//	u32* indexData = new u32[indexCount];
-		//
-		//	if (!file.ReadBuffer((Byte*)vertexData, (u32)VertexFormat::VertexMesh * vertexCount))
-		//	{
-		//		assert(0 && "Failed To Load Mesh.");
-		//	}
-		//
-		//	if (!file.ReadBuffer((Byte*)indexData, sizeof(u32) * indexCount))
-		//	{
-		//		assert(0 && "Failed To Load Mesh.");
-		//	}
-		//
-		//	//--Read Submeshes--
-		//	u32 subMeshCount = file.ReadDword();
-		//	for (u32 i = 0; i < subMeshCount; ++i)
-		//	{
-		//		u32 indexCount = file.ReadDword();
-		//		u32 indexOffset = file.ReadDword();
-		//		SetSubMesh((u32)i, indexCount, indexOffset);
-		//	}
-		//
-		//	SetVertexData(vertexData, vertexCount);
-		//	SetIndices(indexData, indexCount);
-		//	m_IsDirty = true;
-		//	m_IsReadable = true;
-		//	m_IsPacked = true;
-		//	m_FilePath = fileName.c_str();
-		//	m_Name = fileName.c_str();
-		//	Apply(); // Submit to GPU
-		//
-		//	//--Clean data--
-		//	delete[] vertexData;
-		//	delete[] indexData;
-		//	return;
-		//}
+		return LoadFromBinary(fileName);
 	}
 
 	assert(0 && "Failed To Load Mesh.");
 	return Mesh();
 }
 
-Mesh Mesh::LoadFromObj(const std::string& filePath)
+Mesh Mesh::LoadFromMemory(const Byte* data, u64 byteCount, const std::string& fileName)
 {
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-
-	std::string warning;
-	std::string error;
-
-	bool result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, filePath.c_str());
-
-	if (!warning.empty())
+	Mesh mesh;
+	MeshView view;
+	if (view.Open(data, byteCount))
 	{
-		LogWarning(warning);
+		mesh.m_VertexView = view.m_Vertices;
+		mesh.m_IndexView = view.m_Indices;
+		mesh.m_VertexCount = view.m_VertexCount;
+		mesh.m_IndexCount = view.m_IndexCount;
+		mesh.m_MeshParts = std::move(view.m_Parts);
+		mesh.m_BoundsMin = view.m_BoundsMin;
+		mesh.m_BoundsMax = view.m_BoundsMax;
+		mesh.m_VertexFormat = VertexFormat::VertexMesh;
+		mesh.m_IndexFormat = IndexFormat::I32;
+		mesh.m_IsPacked = true;
+		mesh.m_IsDirty = true;
 	}
-
-	if (!error.empty())
+	else
 	{
-		LogWarning(error);
+		// Cooked on the other endian, has too be copied and swapped
+		CookedMesh cooked;
+		MemoryArchive archive(data, byteCount);
+		if (Serialize(archive, cooked) == false)
+		{
+			LogError("Failed too load mesh: " + fileName);
+			assert(0 && "Failed To Load Mesh.");
+			return Mesh();
+		}
+		mesh.SetCooked(cooked);
 	}
 
-	if (!result)
-	{
-		assert(0 && "Failed To Load Mesh.");
-	}
+	mesh.m_FilePath = fileName.c_str();
+	mesh.m_Name = fileName.c_str();
+	return mesh;
+}
 
-	if (attrib.texcoords.empty())
+bool Mesh::SaveToFile(const std::string& filePath)
+{
+	if (m_IsReadable == false)
 	{
-		attrib.texcoords.resize(attrib.vertices.size());
+		LogError("Cannot save a mesh thats no longer readable");
+		return false;
 	}
 
-	if (attrib.colors.empty())
+	// Set Mesh Part to be entire mesh
+	if (m_MeshParts.empty())
 	{
-		attrib.colors.resize(attrib.vertices.size());
+		m_MeshParts.emplace_back(0, m_IndexCount);
 	}
 
-	if (attrib.normals.empty())
+	PackMesh();
+	if (m_IsPacked == false || m_VertexFormat != VertexFormat::VertexMesh || m_PackedMesh.size() < (u64)m_VertexCount * sizeof(VertexMesh))
 	{
-		attrib.normals.resize(attrib.vertices.size());
+		LogError("Only VertexMesh data can be cooked");
+		return false;
 	}
 
-	Mesh mesh;
-
-	u32 index_offset = 0;
-	// Could hash instead?
-	std::unordered_map<u64, u64> indexMap = {};
+	CookedMesh cooked;
+	cooked.m_Vertices.resize(m_VertexCount);
+	std::memcpy(cooked.m_Vertices.data(), m_PackedMesh.data(), (u64)m_VertexCount * sizeof(VertexMesh));
+	cooked.m_Indices.assign(m_Indicies.begin(), m_Indicies.begin() + std::min((u64)m_IndexCount, (u64)m_Indicies.size()));
+	cooked.m_Parts = m_MeshParts;
+	return MeshCooker::Save(filePath, cooked);
+}
 
-	// Loop over shapes
-	for (size_t s = 0; s < shapes.size(); s++)
+Mesh Mesh::LoadFromBinary(const std::string& filePath)
+{
+	std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+	if (mapping->Open(filePath))
 	{
-		// Set submesh
-		mesh.SetMeshPart((u32)s, (u32)shapes[s].mesh.indices.size(), index_offset);
-		for (u32 i = 0; i < (u32)shapes[s].mesh.indices.size(); i++)
+		Mesh mesh = LoadFromMemory(mapping->Data(), mapping->Size(), filePath);
+		if (mesh.m_VertexView)
 		{
-			// access to vertex
-			tinyobj::index_t idx = shapes[s].mesh.indices[i];
-
-			if (idx.texcoord_index < 0)
-			{
-				idx.texcoord_index = 0;
-			}
-
-			if (idx.normal_index < 0)
-			{
-				idx.normal_index = 0;
-			}
+			mesh.m_Mapping = std::move(mapping);
+		}
+		return mesh;
+	}
 
-			// We could just store packed, but we would end up repacking again anyways?
-			VertexMesh vertex;
-			vertex.m_Position	= Vector3(attrib.vertices[(u64)3 * idx.vertex_index + 0], attrib.vertices[(u64)3 * idx.vertex_index + 1], attrib.vertices[(u64)3 * idx.vertex_index + 2]);
-			vertex.m_Normal		= Vector3(attrib.normals[(u64)3 * idx.normal_index + 0], attrib.normals[(u64)3 * idx.normal_index + 1], attrib.normals[(u64)3 * idx.normal_index + 2]);
-			vertex.m_Texture	= Vector2(attrib.texcoords[(u64)2 * idx.texcoord_index + 0], 1.0f - attrib.texcoords[(u64)2 * idx.texcoord_index + 1]);
-			vertex.m_Color		= Color(attrib.colors[(u64)3 * idx.vertex_index + 0], attrib.colors[(u64)3 * idx.vertex_index + 1], attrib.colors[(u64)3 * idx.vertex_index + 2]);
+	// No mapping on this platform, read it through instead
+	CookedMesh cooked;
+	BinaryFile file(filePath, FileMode::Read);
+	BinaryFileArchive archive(file);
+	if (Serialize(archive, cooked) == false)
+	{
+		LogError("Failed too load mesh: " + filePath);
+		assert(0 && "Failed To Load Mesh.");
+		return Mesh();
+	}
 
-			// Tangent is 0,0,0 but should still be okay
-			u32 hash = Hash32::ComputeHash((Byte*)&vertex, (u64)VertexFormat::VertexMesh);
+	Mesh mesh;
+	mesh.SetCooked(cooked);
+	mesh.m_FilePath = filePath.c_str();
+	mesh.m_Name = filePath.c_str();
+	return mesh;
+}
 
-			// Check if this vertex is unique
-			std::unordered_map<u64, u64>::iterator itr = indexMap.find(hash);
-			u64 index = (int)mesh.m_Vertices.size();
-			if (itr == indexMap.end())
-			{
-				// Push back the data and assign the index
-				mesh.m_Vertices.push_back(vertex.m_Position);
-				mesh.m_Normals.push_back(vertex.m_Normal);
-				mesh.m_TexCords.push_back(vertex.m_Texture);
-				mesh.m_Colors.push_back(vertex.m_Color);
-				indexMap[hash] = index;
-			}
-			else
-			{
-				index = itr->second;
-			}
+void Mesh::SetCooked(CookedMesh& cooked)
+{
+	m_VertexCount = (u32)cooked.m_Vertices.size();
+	m_IndexCount = (u32)cooked.m_Indices.size();
+	m_PackedMesh.resize(cooked.m_Vertices.size() * sizeof(VertexMesh));
+	std::memcpy(m_PackedMesh.data(), cooked.m_Vertices.data(), m_PackedMesh.size());
+	m_Indicies = std::move(cooked.m_Indices);
+	m_MeshParts = std::move(cooked.m_Parts);
+	m_BoundsMin = cooked.m_BoundsMin;
+	m_BoundsMax = cooked.m_BoundsMax;
+	m_VertexFormat = VertexFormat::VertexMesh;
+	m_IndexFormat = IndexFormat::I32;
+	m_IsPacked = true;
+	m_IsDirty = true;
+	m_IsReadable = true;
+}
 
-			mesh.m_Indicies.push_back(index);
-		}
+Mesh Mesh::LoadFromObj(const std::string& filePath)
+{
+	CookedMesh cooked;
+	if (MeshCooker::ImportObj(filePath, cooked) == false)
+	{
+		LogError("Failed too load mesh: " + filePath);
+		assert(0 && "Failed To Load Mesh.");
+		return Mesh();
+	}
 
-		index_offset += (u32)shapes[s].mesh.indices.size();
+	// Kept as separate streams so the mesh stays editable, PackMesh packs it on Upload
+	Mesh mesh;
+	u32 count = (u32)cooked.m_Vertices.size();
+	mesh.m_Vertices.resize(count);
+	mesh.m_Normals.resize(count);
+	mesh.m_Tangent.resize(count);
+	mesh.m_Colors.resize(count);
+	mesh.m_TexCords.resize(count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		const VertexMesh& vertex = cooked.m_Vertices[i];
+		mesh.m_Vertices[i] = vertex.m_Position;
+		mesh.m_Normals[i] = vertex.m_Normal;
+		mesh.m_Tangent[i] = vertex.m_Tangent;
+		mesh.m_Colors[i] = vertex.m_Color;
+		mesh.m_TexCords[i] = vertex.m_Texture;
 	}
 
 	//--Set counts--
-	mesh.m_VertexCount = (u32)mesh.m_Vertices.size();
-	mesh.m_IndexCount = index_offset;
+	mesh.m_Indicies = std::move(cooked.m_Indices);
+	mesh.m_MeshParts = std::move(cooked.m_Parts);
+	mesh.m_BoundsMin = cooked.m_BoundsMin;
+	mesh.m_BoundsMax = cooked.m_BoundsMax;
+	mesh.m_VertexCount = count;
+	mesh.m_IndexCount = (u32)mesh.m_Indicies.size();
+	mesh.m_IndexFormat = IndexFormat::I32;
 	mesh.m_IsDirty = true;
 	mesh.m_IsReadable = true;
 	mesh.m_IsPacked = false; // Urgg had to change this
 	mesh.m_FilePath = filePath.c_str();
 	mesh.m_Name = filePath.c_str();
-	mesh.RecalculateTangents();
 
 	return mesh;
-}
\ No newline at end of file
+}
@@ -0,0 +1,279 @@
+#include "Resource/MeshCooker.h"
+#include "System/Assert.h"
+#include "System/Logger.h"
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/Serialize.h"
+#include "Resource/ObjParser.h"
+#include "Resource/VertexWelder.h"
+#include "Resource/MeshOptimizer.h"
+
+SERIALIZE_BITWISE(MeshPart, 8)
+
+void CookedMesh::RecalculateBounds()
+{
+	if (m_Vertices.empty())
+	{
+		m_BoundsMin = Vector3(0, 0, 0);
+		m_BoundsMax = Vector3(0, 0, 0);
+		return;
+	}
+
+	m_BoundsMin = m_Vertices[0].m_Position;
+	m_BoundsMax = m_Vertices[0].m_Position;
+	for (const VertexMesh& vertex : m_Vertices)
+	{
+		m_BoundsMin = Vector3::Min(m_BoundsMin, vertex.m_Position);
+		m_BoundsMax = Vector3::Max(m_BoundsMax, vertex.m_Position);
+	}
+}
+
+// Every part has too stay inside the index buffer, the gpu wont check for us
+static bool PartsInRange(const std::vector<MeshPart>& parts, u64 indexCount)
+{
+	for (const MeshPart& part : parts)
+	{
+		if (part.m_Start > indexCount || part.m_Count > indexCount - part.m_Start)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Everything before the vertex array, shared by the copy and view paths
+static bool SerializeMeshHeader(Archive& archive, Vector3& boundsMin, Vector3& boundsMax, std::vector<MeshPart>& parts)
+{
+	u32 vertexStride = (u32)sizeof(VertexMesh);
+	u32 indexStride = (u32)sizeof(u32);
+	if (SerializeHeader(archive, MESH_MAGIC, MESH_VERSION) == false)
+	{
+		return false;
+	}
+
+	// Version 1 was Mesh's separate streams, needs recooking
+	if (archive.Version() < 2)
+	{
+		return archive.Fail();
+	}
+
+	if (Serialize(archive, vertexStride) == false || Serialize(archive, indexStride) == false)
+	{
+		return false;
+	}
+
+	// Catches VertexMesh changing size without a version bump
+	if (vertexStride != (u32)sizeof(VertexMesh) || indexStride != (u32)sizeof(u32))
+	{
+		return archive.Fail();
+	}
+
+	return Serialize(archive, boundsMin) && Serialize(archive, boundsMax) && Serialize(archive, parts);
+}
+
+bool Serialize(Archive& archive, CookedMesh& mesh)
+{
+	bool result = SerializeMeshHeader(archive, mesh.m_BoundsMin, mesh.m_BoundsMax, mesh.m_Parts) &&
+		Serialize(archive, mesh.m_Vertices) &&
+		Serialize(archive, mesh.m_Indices);
+
+	if (result && archive.IsLoading() && PartsInRange(mesh.m_Parts, mesh.m_Indices.size()) == false)
+	{
+		return archive.Fail();
+	}
+	return result;
+}
+
+bool MeshView::Open(const Byte* data, u64 size)
+{
+	*this = MeshView();
+	MemoryArchive archive(data, size);
+	if (SerializeMeshHeader(archive, m_BoundsMin, m_BoundsMax, m_Parts) == false || archive.IsSwapped())
+	{
+		m_Parts.clear();
+		return false;
+	}
+
+	u32 vertexCount = 0;
+	u32 indexCount = 0;
+	const Byte* vertices = Serialize(archive, vertexCount) ? archive.View((u64)vertexCount * sizeof(VertexMesh)) : nullptr;
+	const Byte* indices = Serialize(archive, indexCount) ? archive.View((u64)indexCount * sizeof(u32)) : nullptr;
+	if (vertices == nullptr || indices == nullptr || PartsInRange(m_Parts, indexCount) == false)
+	{
+		m_Parts.clear();
+		return false;
+	}
+
+	m_Vertices = vertices;
+	m_Indices = indices;
+	m_VertexCount = vertexCount;
+	m_IndexCount = indexCount;
+	return true;
+}
+
+bool MeshCooker::ImportObj(const std::string& filePath, CookedMesh& mesh)
+{
+	ObjData obj;
+	if (ObjParser::Load(filePath, obj) == false)
+	{
+		return false;
+	}
+
+	if (obj.m_TexCoords.empty())
+	{
+		obj.m_TexCoords.resize(obj.m_Positions.size());
+	}
+
+	if (obj.m_Colors.empty())
+	{
+		obj.m_Colors.resize(obj.m_Positions.size());
+	}
+
+	if (obj.m_Normals.empty())
+	{
+		obj.m_Normals.resize(obj.m_Positions.size());
+	}
+
+	mesh = CookedMesh();
+
+	u32 index_offset = 0;
+	// Most objs share positions between faces, so about one welded vertex per position
+	VertexWelder welder(sizeof(VertexMesh), obj.m_Positions.size() / 3);
+	mesh.m_Indices.reserve(obj.m_Indices.size());
+
+	// Loop over shapes
+	for (const MeshPart& shape : obj.m_Shapes)
+	{
+		// Set submesh
+		mesh.m_Parts.emplace_back(index_offset, shape.m_Count);
+		for (u64 i = 0; i < shape.m_Count; i++)
+		{
+			// access to vertex
+			ObjIndex idx = obj.m_Indices[shape.m_Start + i];
+
+			if (idx.m_TexCoord < 0)
+			{
+				idx.m_TexCoord = 0;
+			}
+
+			if (idx.m_Normal < 0)
+			{
+				idx.m_Normal = 0;
+			}
+
+			VertexMesh vertex;
+			vertex.m_Position	= Vector3(obj.m_Positions[(u64)3 * idx.m_Vertex + 0], obj.m_Positions[(u64)3 * idx.m_Vertex + 1], obj.m_Positions[(u64)3 * idx.m_Vertex + 2]);
+			vertex.m_Normal		= Vector3(obj.m_Normals[(u64)3 * idx.m_Normal + 0], obj.m_Normals[(u64)3 * idx.m_Normal + 1], obj.m_Normals[(u64)3 * idx.m_Normal + 2]);
+			vertex.m_Texture	= Vector2(obj.m_TexCoords[(u64)2 * idx.m_TexCoord + 0], 1.0f - obj.m_TexCoords[(u64)2 * idx.m_TexCoord + 1]);
+			vertex.m_Color		= Color(obj.m_Colors[(u64)3 * idx.m_Vertex + 0], obj.m_Colors[(u64)3 * idx.m_Vertex + 1], obj.m_Colors[(u64)3 * idx.m_Vertex + 2]);
+
+			// Tangent is 0,0,0 but should still be okay
+			mesh.m_Indices.push_back(welder.Add(&vertex));
+		}
+
+		index_offset += (u32)shape.m_Count;
+	}
+
+	const VertexMesh* welded = (const VertexMesh*)welder.Vertices();
+	mesh.m_Vertices.assign(welded, welded + welder.Count());
+
+	// Obj face order is whatever the exporter felt like, vertices go into first use order last
+	u32 vertexCount = (u32)mesh.m_Vertices.size();
+	MeshOptimizer::OptimizeVertexCache(mesh.m_Indices.data(), vertexCount, mesh.m_Parts);
+	if (vertexCount > 0)
+	{
+		MeshOptimizer::OptimizeOverdraw(mesh.m_Indices.data(), StridedArray<Vector3>(&mesh.m_Vertices[0].m_Position, sizeof(VertexMesh)), vertexCount, mesh.m_Parts);
+	}
+
+	std::vector<u32> remap(vertexCount);
+	MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), mesh.m_Indices.data(), mesh.m_Indices.size(), vertexCount);
+	MeshOptimizer::RemapIndices(mesh.m_Indices.data(), mesh.m_Indices.size(), remap.data());
+	MeshOptimizer::RemapVertices(mesh.m_Vertices, remap.data());
+
+	if (mesh.m_Vertices.empty())
+	{
+		mesh.RecalculateBounds();
+		return true;
+	}
+
+	VertexMesh* vertices = mesh.m_Vertices.data();
+	ComputeTangents(StridedArray<Vector3>(&vertices->m_Position, sizeof(VertexMesh)), StridedArray<Vector3>(&vertices->m_Normal, sizeof(VertexMesh)),
+		StridedArray<Vector2>(&vertices->m_Texture, sizeof(VertexMesh)), StridedArray<Vector4>(&vertices->m_Tangent, sizeof(VertexMesh)),
+		(u32)mesh.m_Vertices.size(), mesh.m_Indices.data(), mesh.m_Parts);
+
+	mesh.RecalculateBounds();
+	return true;
+}
+
+bool MeshCooker::Save(const std::string& filePath, CookedMesh& mesh)
+{
+	mesh.RecalculateBounds();
+
+	BinaryFile file(filePath, FileMode::Write);
+	file.SetWriteBuffer(1024 * 1024);
+	BinaryFileArchive archive(file);
+	bool result = Serialize(archive, mesh) && file.Flush();
+	file.Close();
+	return result;
+}
+
+void MeshCooker::ComputeTangents(StridedArray<Vector3> positions, StridedArray<Vector3> normals, StridedArray<Vector2> uvs,
+	StridedArray<Vector4> tangentsOut, u32 vertexCount, const u32* indices, const std::vector<MeshPart>& parts)
+{
+	std::vector<Vector3> tangents(vertexCount, Vector3());
+	std::vector<Vector3> bitangents(vertexCount, Vector3());
+
+	// Loop each submesh, and each submehses triangles!
+	for (const MeshPart& mesh : parts)
+	{
+		for (u32 i = 0; i + 2 < mesh.m_Count; i += 3)
+		{
+			u64 index = mesh.m_Start + i;
+
+			//--Indices--
+			u32 i0 = indices[index];
+			u32 i1 = indices[index + 1];
+			u32 i2 = indices[index + 2];
+
+			// Triangle
+			Vector3& p0 = positions[i0];
+			Vector3& p1 = positions[i1];
+			Vector3& p2 = positions[i2];
+
+			//--Uv Edges--
+			Vector2 uv1 = uvs[i1] - uvs[i0];
+			Vector2 uv2 = uvs[i2] - uvs[i0];
+
+			//--Triangle Edges--
+			Vector3 E1 = p1 - p0;
+			Vector3 E2 = p2 - p0;
+
+			//--Formula--
+			float r = 1.0f / (uv1.x * uv2.y - uv2.x * uv1.y);
+			Vector3 t = (E1 * uv2.y - E2 * uv1.y) * r;
+			Vector3 b = (E2 * uv1.x - E1 * uv2.x) * r;
+
+			// Accumulate for smoothing between shared vertexs
+			tangents[i0] += t;
+			tangents[i1] += t;
+			tangents[i2] += t;
+
+			bitangents[i0] += b;
+			bitangents[i1] += b;
+			bitangents[i2] += b;
+		}
+	}
+
+	for (u32 i = 0; i < vertexCount; i++)
+	{
+		Vector3 t = Vector3::Normalize(tangents[i]);
+		Vector3 b = Vector3::Normalize(bitangents[i]);
+		Vector3 n = Vector3::Normalize(normals[i]);
+
+		// Ortho-normalize tangent
+		Vector4& tangent = tangentsOut[i];
+		tangent = Vector3::Normalize(t - (n * Vector3::Dot(t, n)));
+
+		// Orthogonal bitangent checked agaisnt bitangent for direction.
+		tangent.w = (Vector3::Dot(Vector3::Cross(t, b), n) > 0.0f) ? 1.0f : -1.0f;
+	}
+}
@@ -0,0 +1,661 @@
+#include "Resource/MeshOptimizer.h"
+#include "System/Assert.h"
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+
+// Forsyth's tuned constants, the simulated cache is bigger than the real one on purpose
+static const u32 s_CacheSize = 32;
+static const float s_CacheDecayPower = 1.5f;
+static const float s_LastTriangleScore = 0.75f;
+static const float s_ValenceBoostScale = 2.0f;
+static const float s_ValenceBoostPower = 0.5f;
+static const u32 s_ValenceTableSize = 64;
+static const u32 s_NoTriangle = UINT32_MAX;
+
+static float ComputeVertexScore(s32 cachePosition, u32 valence)
+{
+	// Nothing left too draw with it, never pick it
+	if (valence == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertices get a fixed score, so the next one doesnt just
+		// reuse the same edge and strip along
+		if (cachePosition < 3)
+		{
+			score = s_LastTriangleScore;
+		}
+		else
+		{
+			const float scaler = 1.0f / (s_CacheSize - 3);
+			score = std::pow(1.0f - (cachePosition - 3) * scaler, s_CacheDecayPower);
+		}
+	}
+
+	// Vertices with few triangles left get a boost so they get finished off
+	score += s_ValenceBoostScale * std::pow((float)valence, -s_ValenceBoostPower);
+	return score;
+}
+
+// Rescoring is the inner loop, the pow calls are looked up for all but huge valences
+static float VertexScore(s32 cachePosition, u32 valence)
+{
+	struct ScoreTable
+	{
+		float m_Scores[s_CacheSize + 1][s_ValenceTableSize];
+
+		ScoreTable()
+		{
+			for (s32 position = -1; position < (s32)s_CacheSize; ++position)
+			{
+				for (u32 valence = 0; valence < s_ValenceTableSize; ++valence)
+				{
+					m_Scores[position + 1][valence] = ComputeVertexScore(position, valence);
+				}
+			}
+		}
+	};
+	static const ScoreTable table;
+
+	return valence < s_ValenceTableSize ? table.m_Scores[cachePosition + 1][valence] : ComputeVertexScore(cachePosition, valence);
+}
+
+void MeshOptimizer::OptimizeVertexCache(u32* destination, const u32* indices, u64 indexCount, u32 vertexCount)
+{
+	u32 triangleCount = (u32)(indexCount / 3);
+	std::vector<u32> source(indices, indices + indexCount);
+
+	// Triangles around each vertex, live[v] of them still not emitted
+	std::vector<u32> live(vertexCount, 0);
+	for (u64 i = 0; i < (u64)triangleCount * 3; ++i)
+	{
+		assert(source[i] < vertexCount);
+		live[source[i]]++;
+	}
+
+	std::vector<u32> offsets(vertexCount, 0);
+	u32 offset = 0;
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		offsets[v] = offset;
+		offset += live[v];
+	}
+
+	std::vector<u32> adjacency(offset);
+	std::vector<u32> filled(vertexCount, 0);
+	for (u32 t = 0; t < triangleCount; ++t)
+	{
+		for (u32 k = 0; k < 3; ++k)
+		{
+			u32 v = source[(u64)t * 3 + k];
+			adjacency[offsets[v] + filled[v]++] = t;
+		}
+	}
+	filled = std::vector<u32>();
+
+	std::vector<s32> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		vertexScore[v] = VertexScore(-1, live[v]);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	for (u32 t = 0; t < triangleCount; ++t)
+	{
+		const u32* triangle = &source[(u64)t * 3];
+		triangleScore[t] = vertexScore[triangle[0]] + vertexScore[triangle[1]] + vertexScore[triangle[2]];
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<u32> cache;
+	std::vector<u32> newCache;
+	cache.reserve(s_CacheSize + 3);
+	newCache.reserve(s_CacheSize + 3);
+
+	u32 cursor = 0;
+	u32 best = s_NoTriangle;
+	for (u32 out = 0; out < triangleCount; ++out)
+	{
+		// Nothing in the cache has triangles left, carry on in the input's order
+		if (best == s_NoTriangle)
+		{
+			while (emitted[cursor])
+			{
+				cursor++;
+			}
+			best = cursor;
+		}
+
+		const u32* triangle = &source[(u64)best * 3];
+		destination[(u64)out * 3 + 0] = triangle[0];
+		destination[(u64)out * 3 + 1] = triangle[1];
+		destination[(u64)out * 3 + 2] = triangle[2];
+		emitted[best] = true;
+
+		// Take it out of each vertex's live triangles, and put its vertices at the front
+		newCache.clear();
+		for (u32 k = 0; k < 3; ++k)
+		{
+			u32 v = triangle[k];
+			u32* begin = &adjacency[offsets[v]];
+			u32* end = begin + live[v];
+			u32* found = std::find(begin, end, best);
+			*found = *(end - 1);
+			live[v]--;
+
+			if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+			{
+				newCache.push_back(v);
+			}
+		}
+
+		size_t front = newCache.size();
+		for (u32 v : cache)
+		{
+			if (std::find(newCache.begin(), newCache.begin() + front, v) == newCache.begin() + front)
+			{
+				newCache.push_back(v);
+			}
+		}
+
+		// Rescore everything that moved, the overflow has just been evicted
+		for (u32 i = 0; i < (u32)newCache.size(); ++i)
+		{
+			u32 v = newCache[i];
+			cachePosition[v] = i < s_CacheSize ? (s32)i : -1;
+
+			float score = VertexScore(cachePosition[v], live[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			for (u32 a = 0; a < live[v]; ++a)
+			{
+				triangleScore[adjacency[offsets[v] + a]] += delta;
+			}
+		}
+
+		newCache.resize(std::min<size_t>(newCache.size(), s_CacheSize));
+		std::swap(cache, newCache);
+
+		// Best triangle still touching the cache
+		best = s_NoTriangle;
+		float bestScore = -1.0f;
+		for (u32 v : cache)
+		{
+			for (u32 a = 0; a < live[v]; ++a)
+			{
+				u32 t = adjacency[offsets[v] + a];
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+	}
+
+	for (u64 i = (u64)triangleCount * 3; i < indexCount; ++i)
+	{
+		destination[i] = source[i];
+	}
+}
+
+void MeshOptimizer::OptimizeVertexCache(u32* indices, u32 vertexCount, const std::vector<MeshPart>& parts)
+{
+	for (const MeshPart& part : parts)
+	{
+		OptimizeVertexCache(indices + part.m_Start, indices + part.m_Start, part.m_Count, vertexCount);
+	}
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const u32* indices, u64 indexCount, u32 vertexCount, u32 cacheSize, CacheModel model)
+{
+	VertexCacheStats stats;
+	u64 triangleCount = indexCount / 3;
+	if (triangleCount == 0 || cacheSize == 0)
+	{
+		return stats;
+	}
+
+	std::vector<bool> used(vertexCount, false);
+	u64 unique = 0;
+
+	if (model == CacheModel::Fifo)
+	{
+		// A vertex is still cached if fewer than cacheSize misses happened since its own
+		std::vector<u64> timestamps(vertexCount, 0);
+		u64 time = (u64)cacheSize + 1;
+		for (u64 i = 0; i < triangleCount * 3; ++i)
+		{
+			u32 v = indices[i];
+			assert(v < vertexCount);
+			if (time - timestamps[v] > cacheSize)
+			{
+				timestamps[v] = time++;
+				stats.m_Transforms++;
+			}
+
+			if (used[v] == false)
+			{
+				used[v] = true;
+				unique++;
+			}
+		}
+	}
+	else
+	{
+		std::vector<u32> cache;
+		cache.reserve(cacheSize + 1);
+		for (u64 i = 0; i < triangleCount * 3; ++i)
+		{
+			u32 v = indices[i];
+			assert(v < vertexCount);
+			std::vector<u32>::iterator itr = std::find(cache.begin(), cache.end(), v);
+			if (itr != cache.end())
+			{
+				cache.erase(itr);
+			}
+			else
+			{
+				stats.m_Transforms++;
+				if (cache.size() == cacheSize)
+				{
+					cache.pop_back();
+				}
+			}
+			cache.insert(cache.begin(), v);
+
+			if (used[v] == false)
+			{
+				used[v] = true;
+				unique++;
+			}
+		}
+	}
+
+	stats.m_Acmr = (float)stats.m_Transforms / triangleCount;
+	stats.m_Atvr = (float)stats.m_Transforms / unique;
+	return stats;
+}
+
+// Post transform cache the cluster splits and fetch stats assume, like AnalyzeVertexCache's default
+static const u32 s_FifoSize = 16;
+static const u32 s_RasterSize = 256;
+static const u32 s_FetchLineSize = 64;
+static const u32 s_FetchLineCount = 64;
+
+// Misses of one triangle in a FIFO cache using timestamps, like AnalyzeVertexCache
+static u32 TriangleMisses(const u32* triangle, std::vector<u64>& timestamps, u64& time)
+{
+	u32 misses = 0;
+	for (u32 k = 0; k < 3; ++k)
+	{
+		u32 v = triangle[k];
+		if (time - timestamps[v] > s_FifoSize)
+		{
+			timestamps[v] = time++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+// 1 if cross(p1 - p0, p2 - p0) points out of the mesh, -1 if it points in. Objs wind counter
+// clockwise and d3d defaults too clockwise, so the passes work it out from the signed volume.
+static float Orientation(const u32* indices, u64 triangleCount, StridedArray<Vector3> positions)
+{
+	double volume = 0.0;
+	for (u64 t = 0; t < triangleCount; ++t)
+	{
+		Vector3& p0 = positions[indices[t * 3 + 0]];
+		Vector3& p1 = positions[indices[t * 3 + 1]];
+		Vector3& p2 = positions[indices[t * 3 + 2]];
+		volume += Vector3::Dot(p0, Vector3::Cross(p1 - p0, p2 - p0));
+	}
+	return volume < 0.0 ? -1.0f : 1.0f;
+}
+
+void MeshOptimizer::OptimizeOverdraw(u32* destination, const u32* indices, u64 indexCount, StridedArray<Vector3> positions, u32 vertexCount, float threshold)
+{
+	u32 triangleCount = (u32)(indexCount / 3);
+	std::vector<u32> source(indices, indices + indexCount);
+	if (triangleCount == 0)
+	{
+		std::copy(source.begin(), source.end(), destination);
+		return;
+	}
+
+	// Hard boundaries, every vertex of the triangle missed so the cache is cold anyway
+	std::vector<u32> hard;
+	std::vector<u64> timestamps(vertexCount, 0);
+	u64 time = (u64)s_FifoSize + 1;
+	for (u32 t = 0; t < triangleCount; ++t)
+	{
+		if (TriangleMisses(&source[(u64)t * 3], timestamps, time) == 3)
+		{
+			hard.push_back(t);
+		}
+	}
+	hard.push_back(triangleCount);
+
+	// Soft boundaries, cut as soon as the cluster so far is within threshold of its whole
+	// run's ACMR. A cut costs a cold cache, which is what the threshold pays for.
+	std::vector<u32> clusters;
+	for (size_t h = 0; h + 1 < hard.size(); ++h)
+	{
+		u32 begin = hard[h];
+		u32 end = hard[h + 1];
+
+		time += s_FifoSize + 1;
+		u32 misses = 0;
+		for (u32 t = begin; t < end; ++t)
+		{
+			misses += TriangleMisses(&source[(u64)t * 3], timestamps, time);
+		}
+		float runAcmr = (float)misses / (end - begin);
+
+		time += s_FifoSize + 1;
+		misses = 0;
+		u32 start = begin;
+		for (u32 t = begin; t < end; ++t)
+		{
+			misses += TriangleMisses(&source[(u64)t * 3], timestamps, time);
+			if ((float)misses / (t - start + 1) <= runAcmr * threshold)
+			{
+				clusters.push_back(start);
+				start = t + 1;
+				misses = 0;
+				time += s_FifoSize + 1;
+			}
+		}
+
+		if (start < end)
+		{
+			clusters.push_back(start);
+		}
+	}
+	clusters.push_back(triangleCount);
+
+	// Area weighted centroid and outward normal of each cluster, and of the whole mesh
+	float orientation = Orientation(source.data(), triangleCount, positions);
+	u32 clusterCount = (u32)clusters.size() - 1;
+	std::vector<Vector3> centroids(clusterCount);
+	std::vector<Vector3> normals(clusterCount);
+	Vector3 meshCentroid;
+	float meshArea = 0.0f;
+	for (u32 c = 0; c < clusterCount; ++c)
+	{
+		Vector3 centroid;
+		Vector3 normal;
+		float area = 0.0f;
+		for (u32 t = clusters[c]; t < clusters[c + 1]; ++t)
+		{
+			const u32* triangle = &source[(u64)t * 3];
+			Vector3& p0 = positions[triangle[0]];
+			Vector3& p1 = positions[triangle[1]];
+			Vector3& p2 = positions[triangle[2]];
+
+			Vector3 cross = Vector3::Cross(p1 - p0, p2 - p0);
+			float triangleArea = std::sqrt(Vector3::Dot(cross, cross));
+			centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normal += cross * orientation;
+			area += triangleArea;
+		}
+
+		meshCentroid += centroid;
+		meshArea += area;
+		centroids[c] = area > 0.0f ? centroid * (1.0f / area) : Vector3();
+		normals[c] = Vector3::Dot(normal, normal) > 0.0f ? Vector3::Normalize(normal) : Vector3();
+	}
+	meshCentroid = meshArea > 0.0f ? meshCentroid * (1.0f / meshArea) : Vector3();
+
+	// Clusters further out along their own normal are drawn first
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<u32> order(clusterCount);
+	for (u32 c = 0; c < clusterCount; ++c)
+	{
+		sortKeys[c] = Vector3::Dot(centroids[c] - meshCentroid, normals[c]);
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](u32 a, u32 b) { return sortKeys[a] > sortKeys[b]; });
+
+	u64 out = 0;
+	for (u32 c : order)
+	{
+		for (u64 i = (u64)clusters[c] * 3; i < (u64)clusters[c + 1] * 3; ++i)
+		{
+			destination[out++] = source[i];
+		}
+	}
+
+	for (u64 i = (u64)triangleCount * 3; i < indexCount; ++i)
+	{
+		destination[i] = source[i];
+	}
+}
+
+void MeshOptimizer::OptimizeOverdraw(u32* indices, StridedArray<Vector3> positions, u32 vertexCount, const std::vector<MeshPart>& parts, float threshold)
+{
+	for (const MeshPart& part : parts)
+	{
+		OptimizeOverdraw(indices + part.m_Start, indices + part.m_Start, part.m_Count, positions, vertexCount, threshold);
+	}
+}
+
+// Edge function, twice the signed area of a, b, c
+static inline float Edge(float ax, float ay, float bx, float by, float cx, float cy)
+{
+	return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+OverdrawStats MeshOptimizer::AnalyzeOverdraw(const u32* indices, u64 indexCount, StridedArray<Vector3> positions, u32 vertexCount)
+{
+	OverdrawStats stats;
+	u64 triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return stats;
+	}
+
+	float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (u64 i = 0; i < triangleCount * 3; ++i)
+	{
+		// Release builds too, positions would be read past the end
+		if (indices[i] >= vertexCount)
+		{
+			assert(false && "AnalyzeOverdraw Index Past The End Of The Vertices");
+			return stats;
+		}
+
+		const Vector3& p = positions[indices[i]];
+		const float xyz[3] = { p.x, p.y, p.z };
+		for (u32 a = 0; a < 3; ++a)
+		{
+			boundsMin[a] = std::min(boundsMin[a], xyz[a]);
+			boundsMax[a] = std::max(boundsMax[a], xyz[a]);
+		}
+	}
+
+	float orientation = Orientation(indices, triangleCount, positions);
+	std::vector<float> depth(s_RasterSize * s_RasterSize);
+	for (u32 view = 0; view < 6; ++view)
+	{
+		// Looking down axis, from the min side then the max side
+		u32 axis = view / 2;
+		u32 uAxis = (axis + 1) % 3;
+		u32 vAxis = (axis + 2) % 3;
+		float direction = (view % 2) ? -1.0f : 1.0f;
+		float uScale = boundsMax[uAxis] > boundsMin[uAxis] ? s_RasterSize / (boundsMax[uAxis] - boundsMin[uAxis]) : 0.0f;
+		float vScale = boundsMax[vAxis] > boundsMin[vAxis] ? s_RasterSize / (boundsMax[vAxis] - boundsMin[vAxis]) : 0.0f;
+		std::fill(depth.begin(), depth.end(), FLT_MAX);
+
+		for (u64 t = 0; t < triangleCount; ++t)
+		{
+			float x[3], y[3], z[3];
+			for (u32 k = 0; k < 3; ++k)
+			{
+				const Vector3& p = positions[indices[t * 3 + k]];
+				const float xyz[3] = { p.x, p.y, p.z };
+				x[k] = (xyz[uAxis] - boundsMin[uAxis]) * uScale;
+				y[k] = (xyz[vAxis] - boundsMin[vAxis]) * vScale;
+				z[k] = xyz[axis] * direction;
+			}
+
+			// Back faces are culled, outward normals have too point back at the viewer
+			Vector3& p0 = positions[indices[t * 3 + 0]];
+			Vector3 normal = Vector3::Cross(positions[indices[t * 3 + 1]] - p0, positions[indices[t * 3 + 2]] - p0) * orientation;
+			const float facing[3] = { normal.x, normal.y, normal.z };
+			if (facing[axis] * direction >= 0.0f)
+			{
+				continue;
+			}
+
+			// Projected winding depends on the view, flip so inside is always positive
+			float area = Edge(x[0], y[0], x[1], y[1], x[2], y[2]);
+			if (area == 0.0f)
+			{
+				continue;
+			}
+
+			if (area < 0.0f)
+			{
+				std::swap(x[1], x[2]);
+				std::swap(y[1], y[2]);
+				std::swap(z[1], z[2]);
+				area = -area;
+			}
+
+			s32 minX = std::max((s32)std::floor(std::min({ x[0], x[1], x[2] })), 0);
+			s32 minY = std::max((s32)std::floor(std::min({ y[0], y[1], y[2] })), 0);
+			s32 maxX = std::min((s32)std::ceil(std::max({ x[0], x[1], x[2] })), (s32)s_RasterSize - 1);
+			s32 maxY = std::min((s32)std::ceil(std::max({ y[0], y[1], y[2] })), (s32)s_RasterSize - 1);
+
+			for (s32 py = minY; py <= maxY; ++py)
+			{
+				for (s32 px = minX; px <= maxX; ++px)
+				{
+					// Sampled at pixel centres
+					float sx = px + 0.5f;
+					float sy = py + 0.5f;
+					float w0 = Edge(x[1], y[1], x[2], y[2], sx, sy);
+					float w1 = Edge(x[2], y[2], x[0], y[0], sx, sy);
+					float w2 = Edge(x[0], y[0], x[1], y[1], sx, sy);
+					if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+					{
+						continue;
+					}
+
+					float fragment = (w0 * z[0] + w1 * z[1] + w2 * z[2]) / area;
+					float& stored = depth[(size_t)py * s_RasterSize + px];
+					if (fragment < stored)
+					{
+						stored = fragment;
+						stats.m_Shaded++;
+					}
+				}
+			}
+		}
+
+		for (float value : depth)
+		{
+			stats.m_Covered += value != FLT_MAX ? 1 : 0;
+		}
+	}
+
+	stats.m_Overdraw = stats.m_Covered ? (float)stats.m_Shaded / stats.m_Covered : 0.0f;
+	return stats;
+}
+
+u32 MeshOptimizer::OptimizeVertexFetchRemap(u32* remap, const u32* indices, u64 indexCount, u32 vertexCount)
+{
+	std::fill(remap, remap + vertexCount, UINT32_MAX);
+
+	u32 next = 0;
+	for (u64 i = 0; i < indexCount; ++i)
+	{
+		u32 v = indices[i];
+		assert(v < vertexCount);
+		if (remap[v] == UINT32_MAX)
+		{
+			remap[v] = next++;
+		}
+	}
+
+	// Nothing uses these, but the streams keep them so vertex counts dont change
+	u32 used = next;
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		if (remap[v] == UINT32_MAX)
+		{
+			remap[v] = next++;
+		}
+	}
+	return used;
+}
+
+void MeshOptimizer::RemapIndices(u32* indices, u64 indexCount, const u32* remap)
+{
+	for (u64 i = 0; i < indexCount; ++i)
+	{
+		indices[i] = remap[indices[i]];
+	}
+}
+
+VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const u32* indices, u64 indexCount, u32 vertexCount, u32 vertexSize)
+{
+	VertexFetchStats stats;
+	std::vector<u64> timestamps(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	std::vector<u64> lines;
+	lines.reserve(s_FetchLineCount + 1);
+	u64 time = (u64)s_FifoSize + 1;
+	u64 unique = 0;
+
+	for (u64 i = 0; i < indexCount; ++i)
+	{
+		u32 v = indices[i];
+		assert(v < vertexCount);
+		if (used[v] == false)
+		{
+			used[v] = true;
+			unique++;
+		}
+
+		// Only a transform fetches
+		if (time - timestamps[v] <= s_FifoSize)
+		{
+			continue;
+		}
+		timestamps[v] = time++;
+
+		u64 first = (u64)v * vertexSize / s_FetchLineSize;
+		u64 last = ((u64)v * vertexSize + vertexSize - 1) / s_FetchLineSize;
+		for (u64 line = first; line <= last; ++line)
+		{
+			std::vector<u64>::iterator itr = std::find(lines.begin(), lines.end(), line);
+			if (itr != lines.end())
+			{
+				lines.erase(itr);
+			}
+			else
+			{
+				stats.m_BytesFetched += s_FetchLineSize;
+				if (lines.size() == s_FetchLineCount)
+				{
+					lines.pop_back();
+				}
+			}
+			lines.insert(lines.begin(), line);
+		}
+	}
+
+	stats.m_Overfetch = unique ? (float)stats.m_BytesFetched / ((float)unique * vertexSize) : 0.0f;
+	return stats;
+}
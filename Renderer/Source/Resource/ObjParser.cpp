@@ -0,0 +1,708 @@
+#include "Resource/ObjParser.h"
+#include "FileSystem/File/TextReader.h"
+#include "System/ThreadPool.h"
+#include "System/Logger.h"
+#include "tinyobj/tiny_obj_loader.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+// Smaller than this and the threads cost more than they save
+static const size_t s_MinChunkSize = 1024 * 1024;
+// Chunks per thread, a few spare so uneven chunks (all v vs all f) still balance
+static const u32 s_ChunksPerThread = 4;
+
+struct ObjChunk
+{
+	const char*				m_Begin = nullptr;
+	const char*				m_End = nullptr;
+	std::vector<float>		m_Positions;
+	std::vector<float>		m_TexCoords;
+	std::vector<float>		m_Normals;
+	std::vector<float>		m_Colors;
+	std::vector<ObjIndex>	m_Corners;
+	std::vector<u8>			m_FaceSizes;	// 3 or 4
+	std::vector<u64>		m_Relative;		// corner * 3 + slot of each negative index, needs the base adding
+	std::vector<u64>		m_Breaks;		// Output corner count at each o/g
+	u64						m_OutputCorners = 0;
+	ObjResult				m_Result = ObjResult::Ok;
+
+	// Per slot (v, vt, vn), largest "index - count so far" and smallest relative result,
+	// checked against the base once its known so forward/negative references bail out
+	s64						m_MaxAhead[3] = { INT64_MIN, INT64_MIN, INT64_MIN };
+	s64						m_MinRelative[3] = { INT64_MAX, INT64_MAX, INT64_MAX };
+
+	// Filled by the merge
+	u64						m_Base[3] = {};
+	u64						m_CornerBase = 0;
+};
+
+static inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+static inline bool IsDigit(char c)
+{
+	return (unsigned int)(c - '0') < 10u;
+}
+
+static inline const char* SkipSpace(const char* token, const char* end)
+{
+	while (token < end && IsSpace(*token))
+	{
+		++token;
+	}
+	return token;
+}
+
+// strcspn(" \t\r") bounded by the line
+static inline const char* TokenEnd(const char* token, const char* end)
+{
+	while (token < end && IsSpace(*token) == false && *token != '\r')
+	{
+		++token;
+	}
+	return token;
+}
+
+// tinyobj's tryParseDouble step for step, so every float rounds the same way
+static bool ParseDouble(const char* s, const char* end, double* result)
+{
+	if (s >= end)
+	{
+		return false;
+	}
+
+	double mantissa = 0.0;
+	int exponent = 0;
+	char sign = '+';
+	char expSign = '+';
+	const char* curr = s;
+	int read = 0;
+	bool endNotReached = false;
+	bool leadingDecimalDots = false;
+
+	if (*curr == '+' || *curr == '-')
+	{
+		sign = *curr;
+		curr++;
+		if ((curr != end) && (*curr == '.'))
+		{
+			leadingDecimalDots = true;
+		}
+	}
+	else if (IsDigit(*curr))
+	{
+	}
+	else if (*curr == '.')
+	{
+		leadingDecimalDots = true;
+	}
+	else
+	{
+		return false;
+	}
+
+	// Integer part
+	endNotReached = (curr != end);
+	if (!leadingDecimalDots)
+	{
+		while (endNotReached && IsDigit(*curr))
+		{
+			mantissa *= 10;
+			mantissa += (int)(*curr - 0x30);
+			curr++;
+			read++;
+			endNotReached = (curr != end);
+		}
+
+		if (read == 0)
+		{
+			return false;
+		}
+	}
+
+	if (endNotReached)
+	{
+		// Decimal part
+		bool exponentNext = false;
+		if (*curr == '.')
+		{
+			curr++;
+			read = 1;
+			endNotReached = (curr != end);
+			while (endNotReached && IsDigit(*curr))
+			{
+				static const double powLut[] = { 1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001 };
+				const int lutEntries = sizeof(powLut) / sizeof(powLut[0]);
+
+				mantissa += (int)(*curr - 0x30) * (read < lutEntries ? powLut[read] : std::pow(10.0, -read));
+				read++;
+				curr++;
+				endNotReached = (curr != end);
+			}
+			exponentNext = endNotReached;
+		}
+		else
+		{
+			exponentNext = (*curr == 'e' || *curr == 'E');
+		}
+
+		// Exponent part
+		if (exponentNext && (*curr == 'e' || *curr == 'E'))
+		{
+			curr++;
+			endNotReached = (curr != end);
+			if (endNotReached && (*curr == '+' || *curr == '-'))
+			{
+				expSign = *curr;
+				curr++;
+			}
+			else if (endNotReached && IsDigit(*curr))
+			{
+			}
+			else
+			{
+				// Empty E isnt allowed
+				return false;
+			}
+
+			read = 0;
+			endNotReached = (curr != end);
+			while (endNotReached && IsDigit(*curr))
+			{
+				if (exponent > (2147483647 / 10))
+				{
+					return false;
+				}
+				exponent *= 10;
+				exponent += (int)(*curr - 0x30);
+				curr++;
+				read++;
+				endNotReached = (curr != end);
+			}
+			exponent *= (expSign == '+' ? 1 : -1);
+			if (read == 0)
+			{
+				return false;
+			}
+		}
+	}
+
+	*result = (sign == '+' ? 1 : -1) * (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+	return true;
+}
+
+static inline float ParseReal(const char*& token, const char* end, double defaultValue = 0.0)
+{
+	token = SkipSpace(token, end);
+	const char* tokenEnd = TokenEnd(token, end);
+	double value = defaultValue;
+	ParseDouble(token, tokenEnd, &value);
+	token = tokenEnd;
+	return (float)value;
+}
+
+static inline bool ParseReal(const char*& token, const char* end, float* out)
+{
+	token = SkipSpace(token, end);
+	const char* tokenEnd = TokenEnd(token, end);
+	double value;
+	bool result = ParseDouble(token, tokenEnd, &value);
+	if (result)
+	{
+		*out = (float)value;
+	}
+	token = tokenEnd;
+	return result;
+}
+
+// atoi, skips leading whitespace and stops at the first non digit
+static inline int ParseInt(const char* token, const char* end)
+{
+	while (token < end && (IsSpace(*token) || *token == '\v' || *token == '\f'))
+	{
+		++token;
+	}
+
+	bool negative = false;
+	if (token < end && (*token == '+' || *token == '-'))
+	{
+		negative = *token == '-';
+		++token;
+	}
+
+	u32 value = 0;
+	while (token < end && IsDigit(*token))
+	{
+		value = value * 10 + (u32)(*token - '0');
+		++token;
+	}
+	return negative ? -(int)value : (int)value;
+}
+
+// strcspn("/ \t\r") bounded by the line
+static inline const char* IndexEnd(const char* token, const char* end)
+{
+	while (token < end && *token != '/' && IsSpace(*token) == false && *token != '\r')
+	{
+		++token;
+	}
+	return token;
+}
+
+// fixIndex, positive is 1 based, negative counts back from the last one read. Relative
+// ones can only be resolved against this chunk, the merge adds the base later.
+static inline bool ResolveIndex(ObjChunk& chunk, int index, u32 slot, u64 corner, int& out)
+{
+	s64 count = (s64)(slot == 0 ? chunk.m_Positions.size() / 3 : (slot == 1 ? chunk.m_TexCoords.size() / 2 : chunk.m_Normals.size() / 3));
+	if (index > 0)
+	{
+		out = index - 1;
+		chunk.m_MaxAhead[slot] = std::max(chunk.m_MaxAhead[slot], (s64)out - count);
+		return true;
+	}
+
+	if (index == 0)
+	{
+		// Zero isnt allowed by the spec
+		return false;
+	}
+
+	s64 local = count + index;
+	out = (int)local;
+	chunk.m_MinRelative[slot] = std::min(chunk.m_MinRelative[slot], local);
+	chunk.m_Relative.push_back(corner * 3 + slot);
+	return true;
+}
+
+// tinyobj's parseTriple, i, i/j, i//k or i/j/k
+static bool ParseTriple(ObjChunk& chunk, const char*& token, const char* end, u64 corner, ObjIndex& out)
+{
+	out = ObjIndex();
+	if (ResolveIndex(chunk, ParseInt(token, end), 0, corner, out.m_Vertex) == false)
+	{
+		return false;
+	}
+
+	token = IndexEnd(token, end);
+	if (token == end || *token != '/')
+	{
+		return true;
+	}
+	token++;
+
+	// i//k
+	if (token < end && *token == '/')
+	{
+		token++;
+		if (ResolveIndex(chunk, ParseInt(token, end), 2, corner, out.m_Normal) == false)
+		{
+			return false;
+		}
+		token = IndexEnd(token, end);
+		return true;
+	}
+
+	// i/j/k or i/j
+	if (ResolveIndex(chunk, ParseInt(token, end), 1, corner, out.m_TexCoord) == false)
+	{
+		return false;
+	}
+
+	token = IndexEnd(token, end);
+	if (token == end || *token != '/')
+	{
+		return true;
+	}
+
+	token++;
+	if (ResolveIndex(chunk, ParseInt(token, end), 2, corner, out.m_Normal) == false)
+	{
+		return false;
+	}
+	token = IndexEnd(token, end);
+	return true;
+}
+
+static void ParseLine(ObjChunk& chunk, const char* token, const char* end)
+{
+	token = SkipSpace(token, end);
+	if (token == end || *token == '#')
+	{
+		return;
+	}
+
+	char c1 = token + 1 < end ? token[1] : '\0';
+	char c2 = token + 2 < end ? token[2] : '\0';
+
+	if (token[0] == 'v' && IsSpace(c1))
+	{
+		token += 2;
+		float x = ParseReal(token, end);
+		float y = ParseReal(token, end);
+		float z = ParseReal(token, end);
+
+		// Colour only counts if all three are there, tinyobj falls back too white
+		float r, g, b;
+		if ((ParseReal(token, end, &r) && ParseReal(token, end, &g) && ParseReal(token, end, &b)) == false)
+		{
+			r = g = b = 1.0f;
+		}
+
+		chunk.m_Positions.insert(chunk.m_Positions.end(), { x, y, z });
+		chunk.m_Colors.insert(chunk.m_Colors.end(), { r, g, b });
+		return;
+	}
+
+	if (token[0] == 'v' && c1 == 'n' && IsSpace(c2))
+	{
+		token += 3;
+		float x = ParseReal(token, end);
+		float y = ParseReal(token, end);
+		float z = ParseReal(token, end);
+		chunk.m_Normals.insert(chunk.m_Normals.end(), { x, y, z });
+		return;
+	}
+
+	if (token[0] == 'v' && c1 == 't' && IsSpace(c2))
+	{
+		token += 3;
+		float x = ParseReal(token, end);
+		float y = ParseReal(token, end);
+		chunk.m_TexCoords.insert(chunk.m_TexCoords.end(), { x, y });
+		return;
+	}
+
+	if (token[0] == 'f' && IsSpace(c1))
+	{
+		token = SkipSpace(token + 2, end);
+
+		u64 first = chunk.m_Corners.size();
+		while (token < end)
+		{
+			ObjIndex index;
+			if (ParseTriple(chunk, token, end, chunk.m_Corners.size(), index) == false)
+			{
+				chunk.m_Result = ObjResult::Error;
+				return;
+			}
+
+			chunk.m_Corners.push_back(index);
+			while (token < end && (IsSpace(*token) || *token == '\r'))
+			{
+				++token;
+			}
+		}
+
+		// Ear clipping and degenerate faces stay with tinyobj
+		u64 corners = chunk.m_Corners.size() - first;
+		if (corners != 3 && corners != 4)
+		{
+			chunk.m_Result = ObjResult::Unsupported;
+			return;
+		}
+
+		chunk.m_FaceSizes.push_back((u8)corners);
+		chunk.m_OutputCorners += corners == 3 ? 3 : 6;
+		return;
+	}
+
+	if ((token[0] == 'g' || token[0] == 'o') && IsSpace(c1))
+	{
+		chunk.m_Breaks.push_back(chunk.m_OutputCorners);
+		return;
+	}
+
+	if ((token[0] == 'l' || token[0] == 'p') && IsSpace(c1))
+	{
+		chunk.m_Result = ObjResult::Unsupported;
+		return;
+	}
+
+	// usemtl, mtllib, s, t... dont change the geometry
+}
+
+static void ParseChunk(ObjChunk& chunk)
+{
+	const char* text = chunk.m_Begin;
+	const char* end = chunk.m_End;
+	while (text < end && chunk.m_Result == ObjResult::Ok)
+	{
+		// Lines end at \n, \r or \r\n like safeGetline, a \0 cuts the line short like c_str
+		const char* line = text;
+		while (text < end && *text != '\n' && *text != '\r' && *text != '\0')
+		{
+			++text;
+		}
+
+		ParseLine(chunk, line, text);
+
+		while (text < end && *text != '\n' && *text != '\r')
+		{
+			++text;
+		}
+		++text;
+	}
+}
+
+// Quads split along the shorter diagonal, exactly as tinyobj does it
+static void Triangulate(const ObjChunk& chunk, const std::vector<float>& positions, ObjIndex* output)
+{
+	const ObjIndex* corner = chunk.m_Corners.data();
+	for (u8 size : chunk.m_FaceSizes)
+	{
+		if (size == 3)
+		{
+			output[0] = corner[0];
+			output[1] = corner[1];
+			output[2] = corner[2];
+			output += 3;
+			corner += 3;
+			continue;
+		}
+
+		const float* v0 = &positions[(size_t)corner[0].m_Vertex * 3];
+		const float* v1 = &positions[(size_t)corner[1].m_Vertex * 3];
+		const float* v2 = &positions[(size_t)corner[2].m_Vertex * 3];
+		const float* v3 = &positions[(size_t)corner[3].m_Vertex * 3];
+
+		float e02x = v2[0] - v0[0];
+		float e02y = v2[1] - v0[1];
+		float e02z = v2[2] - v0[2];
+		float e13x = v3[0] - v1[0];
+		float e13y = v3[1] - v1[1];
+		float e13z = v3[2] - v1[2];
+
+		float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+		float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+		static const u8 split02[6] = { 0, 1, 2, 0, 2, 3 };
+		static const u8 split13[6] = { 0, 1, 3, 1, 2, 3 };
+		const u8* order = sqr02 < sqr13 ? split02 : split13;
+		for (u32 i = 0; i < 6; ++i)
+		{
+			output[i] = corner[order[i]];
+		}
+		output += 6;
+		corner += 4;
+	}
+}
+
+ObjResult ObjParser::Parse(const char* text, size_t size, ObjData& obj, u32 threadCount)
+{
+	obj = ObjData();
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	// Line aligned chunks, a cut only ever lands just after a \n or \r
+	size_t chunkCount = std::max<size_t>(1, std::min<size_t>((size_t)threadCount * s_ChunksPerThread, size / s_MinChunkSize));
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* start = text;
+	const char* end = text + size;
+	for (size_t i = 0; i < chunkCount; ++i)
+	{
+		const char* cut = (i + 1 == chunkCount) ? end : std::max(start, text + size / chunkCount * (i + 1));
+		while (cut < end && cut[-1] != '\n' && cut[-1] != '\r')
+		{
+			++cut;
+		}
+
+		chunks[i].m_Begin = start;
+		chunks[i].m_End = cut;
+		start = cut;
+	}
+
+	// The reading thread helps, so the pool itself is one short
+	std::unique_ptr<ThreadPool> pool = (threadCount > 1 && chunkCount > 1) ? std::make_unique<ThreadPool>(threadCount - 1) : nullptr;
+	auto parallelFor = [&pool](u32 count, const std::function<bool(u32)>& task)
+	{
+		if (pool)
+		{
+			return pool->ParallelFor(count, task);
+		}
+
+		bool result = true;
+		for (u32 i = 0; i < count; ++i)
+		{
+			result &= task(i);
+		}
+		return result;
+	};
+
+	parallelFor((u32)chunkCount, [&chunks](u32 index)
+	{
+		ParseChunk(chunks[index]);
+		return true;
+	});
+
+	// Prefix sums, also the checks that needed the bases
+	u64 base[3] = {};
+	u64 corners = 0;
+	for (ObjChunk& chunk : chunks)
+	{
+		if (chunk.m_Result != ObjResult::Ok)
+		{
+			return chunk.m_Result;
+		}
+
+		u64 counts[3] = { chunk.m_Positions.size() / 3, chunk.m_TexCoords.size() / 2, chunk.m_Normals.size() / 3 };
+		for (u32 slot = 0; slot < 3; ++slot)
+		{
+			// Forward references and relative ones before the first element, tinyobj
+			// skips some of these faces and keeps others
+			if (chunk.m_MaxAhead[slot] >= (s64)base[slot] || chunk.m_MinRelative[slot] < -(s64)base[slot])
+			{
+				return ObjResult::Unsupported;
+			}
+
+			chunk.m_Base[slot] = base[slot];
+			base[slot] += counts[slot];
+		}
+
+		chunk.m_CornerBase = corners;
+		corners += chunk.m_OutputCorners;
+	}
+
+	// Everything has too stay addressable by tinyobj's int indices
+	if (base[0] > INT32_MAX || base[1] > INT32_MAX || base[2] > INT32_MAX)
+	{
+		return ObjResult::Unsupported;
+	}
+
+	obj.m_Positions.resize((size_t)base[0] * 3);
+	obj.m_Colors.resize((size_t)base[0] * 3);
+	obj.m_TexCoords.resize((size_t)base[1] * 2);
+	obj.m_Normals.resize((size_t)base[2] * 3);
+	obj.m_Indices.resize((size_t)corners);
+
+	// Attributes first, quads need the merged positions too pick their diagonal
+	parallelFor((u32)chunkCount, [&chunks, &obj](u32 index)
+	{
+		ObjChunk& chunk = chunks[index];
+		std::copy(chunk.m_Positions.begin(), chunk.m_Positions.end(), obj.m_Positions.begin() + chunk.m_Base[0] * 3);
+		std::copy(chunk.m_Colors.begin(), chunk.m_Colors.end(), obj.m_Colors.begin() + chunk.m_Base[0] * 3);
+		std::copy(chunk.m_TexCoords.begin(), chunk.m_TexCoords.end(), obj.m_TexCoords.begin() + chunk.m_Base[1] * 2);
+		std::copy(chunk.m_Normals.begin(), chunk.m_Normals.end(), obj.m_Normals.begin() + chunk.m_Base[2] * 3);
+		chunk.m_Positions = std::vector<float>();
+		chunk.m_Colors = std::vector<float>();
+		chunk.m_TexCoords = std::vector<float>();
+		chunk.m_Normals = std::vector<float>();
+
+		// Relative indices are only chunk local until now
+		for (u64 relative : chunk.m_Relative)
+		{
+			ObjIndex& corner = chunk.m_Corners[relative / 3];
+			u32 slot = (u32)(relative % 3);
+			int& value = slot == 0 ? corner.m_Vertex : (slot == 1 ? corner.m_TexCoord : corner.m_Normal);
+			value += (int)chunk.m_Base[slot];
+		}
+		return true;
+	});
+
+	parallelFor((u32)chunkCount, [&chunks, &obj](u32 index)
+	{
+		ObjChunk& chunk = chunks[index];
+		Triangulate(chunk, obj.m_Positions, obj.m_Indices.data() + chunk.m_CornerBase);
+		chunk.m_Corners = std::vector<ObjIndex>();
+		return true;
+	});
+
+	// Shapes are the runs between o/g lines, tinyobj drops the empty ones
+	u64 shapeStart = 0;
+	for (const ObjChunk& chunk : chunks)
+	{
+		for (u64 localBreak : chunk.m_Breaks)
+		{
+			u64 position = chunk.m_CornerBase + localBreak;
+			if (position > shapeStart)
+			{
+				obj.m_Shapes.emplace_back(shapeStart, position - shapeStart);
+			}
+			shapeStart = position;
+		}
+	}
+
+	if (corners > shapeStart)
+	{
+		obj.m_Shapes.emplace_back(shapeStart, corners - shapeStart);
+	}
+	return ObjResult::Ok;
+}
+
+bool ObjParser::Load(const std::string& filePath, ObjData& obj, u32 threadCount)
+{
+	TextReader reader(filePath);
+	if (reader.IsOpen() == false)
+	{
+		LogWarning("Failed too open obj: " + filePath);
+		return false;
+	}
+
+	ObjResult result = Parse(reader.Text().data(), reader.Text().size(), obj, threadCount);
+	if (result == ObjResult::Unsupported)
+	{
+		reader.Close();
+		return LoadTinyObj(filePath, obj);
+	}
+
+	if (result == ObjResult::Error)
+	{
+		LogWarning("Failed parse `f' line(e.g. zero value for face index) in " + filePath);
+		obj = ObjData();
+		return false;
+	}
+	return true;
+}
+
+bool ObjParser::LoadTinyObj(const std::string& filePath, ObjData& obj)
+{
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+
+	std::string warning;
+	std::string error;
+
+	bool result = tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, filePath.c_str());
+
+	if (!warning.empty())
+	{
+		LogWarning(warning);
+	}
+
+	if (!error.empty())
+	{
+		LogWarning(error);
+	}
+
+	obj = ObjData();
+	if (!result)
+	{
+		return false;
+	}
+
+	obj.m_Positions = std::move(attrib.vertices);
+	obj.m_TexCoords = std::move(attrib.texcoords);
+	obj.m_Normals = std::move(attrib.normals);
+	obj.m_Colors = std::move(attrib.colors);
+
+	for (const tinyobj::shape_t& shape : shapes)
+	{
+		obj.m_Shapes.emplace_back(obj.m_Indices.size(), shape.mesh.indices.size());
+		for (const tinyobj::index_t& index : shape.mesh.indices)
+		{
+			ObjIndex corner;
+			corner.m_Vertex = index.vertex_index;
+			corner.m_TexCoord = index.texcoord_index;
+			corner.m_Normal = index.normal_index;
+			obj.m_Indices.push_back(corner);
+		}
+	}
+	return true;
+}
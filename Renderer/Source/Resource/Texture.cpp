@@ -5,6 +5,8 @@
 #include "System/Logger.h"
 #include "System/Window.h"
 #include "FileSystem/Path.h"
+#include "FileSystem/File/BinaryFile.h"
+#include "FileSystem/Serialize.h"
 #include "Math/Mathf.h"
 #include "Engine/Application.h"
 #include "System/Assert.h"
@@ -265,7 +267,7 @@ std::shared_ptr<Texture> Texture::LoadFromFile(const std::string& fileName)
 		
 		if (Path::FileExists(filePath))
 		{
-			//LoadFromBinary(filePath); Re-Add This back in
+			texture = LoadFromBinary(filePath);
 		}
 		else
 		{
@@ -279,7 +281,7 @@ std::shared_ptr<Texture> Texture::LoadFromFile(const std::string& fileName)
 	}
 	else if (ext == "texture")
 	{
-		// LoadFromBinary(filePath); Re-Add This back in
+		texture = LoadFromBinary(filePath);
 	}
 
 	if (texture)
@@ -290,6 +292,67 @@ std::shared_ptr<Texture> Texture::LoadFromFile(const std::string& fileName)
 	return texture;
 }
 
+bool Texture::SaveToFile(const std::string& fileName)
+{
+	if (m_Data == nullptr || m_Texture == nullptr)
+	{
+		LogError("Cannot save a texture without cpu data");
+		return false;
+	}
+
+	BinaryFile file(fileName, FileMode::Write);
+	file.SetWriteBuffer(1024 * 1024);
+	BinaryFileArchive archive(file);
+	bool result = Serialize(archive, *this) && file.Flush();
+	file.Close();
+	return result;
+}
+
+std::shared_ptr<Texture> Texture::LoadFromBinary(const std::string& fileName)
+{
+	BinaryFile file(fileName, FileMode::Read);
+	BinaryFileArchive archive(file);
+
+	std::shared_ptr<Texture> texture = std::make_shared<Texture>();
+	if (Serialize(archive, *texture) == false)
+	{
+		LogError("Failed too load texture: " + fileName);
+		assert(0 && "Failed to load texture.");
+		return nullptr;
+	}
+	return texture;
+}
+
+bool Serialize(Archive& archive, Texture& texture)
+{
+	ResourceDesc desc;
+	u32 byteCount = texture.m_ByteCount;
+	if (archive.IsSaving())
+	{
+		if (texture.m_Data == nullptr || texture.m_Texture == nullptr)
+		{
+			return archive.Fail();
+		}
+		desc = texture.GetTextureInfo();
+	}
+
+	if (SerializeTextureHeader(archive, desc, byteCount) == false)
+	{
+		return false;
+	}
+
+	if (archive.IsLoading())
+	{
+		texture.CreateTexture(Application::GEngine->Device(), desc);
+		if (texture.m_ByteCount != byteCount)
+		{
+			return archive.Fail();
+		}
+	}
+
+	return SerializeArray(archive, texture.m_Data, byteCount);
+}
+
 void Texture::Release()
 {
 	if (m_Data != nullptr)
@@ -317,49 +380,76 @@ std::shared_ptr<TextureResource> Texture::GetTextureResource() const
 
 std::shared_ptr<Texture> Texture::LoadFromSource(std::string fileName)
 {
-	std::shared_ptr<Texture> texture = nullptr;
 	int width = 0;
 	int height = 0;
 	int comp = 0;
 
 	unsigned char* p = stbi_load(fileName.c_str(), &width, &height, &comp, STBI_rgb_alpha);
+	if (p == nullptr)
+	{
+		assert(0 && "Failed to load texture.");
+		return nullptr;
+	}
+
+	std::shared_ptr<Texture> texture = CreateFromPixels(p, width, height, fileName);
+	stbi_image_free(p);
+	return texture;
+}
+
+std::shared_ptr<Texture> Texture::LoadFromMemory(const Byte* data, u32 byteCount, const std::string& fileName)
+{
+	int width = 0;
+	int height = 0;
+	int comp = 0;
+
+	unsigned char* p = stbi_load_from_memory(data, (int)byteCount, &width, &height, &comp, STBI_rgb_alpha);
+	if (p == nullptr)
+	{
+		assert(0 && "Failed to load texture.");
+		return nullptr;
+	}
+
+	std::shared_ptr<Texture> texture = CreateFromPixels(p, width, height, fileName);
+	stbi_image_free(p);
+
+	if (texture)
+	{
+		texture->SetPath(fileName);
+	}
+	return texture;
+}
+
+std::shared_ptr<Texture> Texture::CreateFromPixels(Byte* pixels, int width, int height, const std::string& fileName)
+{
+	std::shared_ptr<Texture> texture = nullptr;
 	ResourceDesc desc;
-	if (p != nullptr)
+	if (width != 0 && height != 0)
 	{
-		if (width != 0 && height != 0)
+		// i mean loading a source is already slow anyway, so do a check for non SRGB and covnert.
+		desc.Format = SurfaceFormat::R8G8B8A8_Unorm_SRGB;
+
+		size_t found = fileName.find_last_of("_");
+		if (found != std::string::npos)
 		{
-			// i mean loading a source is already slow anyway, so do a check for non SRGB and covnert.
-			desc.Format = SurfaceFormat::R8G8B8A8_Unorm_SRGB;
+			std::string type = fileName.substr(found + 1, fileName.find_last_of(".") - (found + 1));
 
-			size_t found = fileName.find_last_of("_");
-			if (found != std::string::npos)
+			if (type == "Normal" || type == "Roughness" || "type" == "Metalness")
 			{
-				std::string type = fileName.substr(found + 1, fileName.find_last_of(".") - (found + 1));
-
-				if (type == "Normal" || type == "Roughness" || "type" == "Metalness")
-				{
-					desc.Format = SurfaceFormat::R8G8B8A8_Unorm;
-				}
+				desc.Format = SurfaceFormat::R8G8B8A8_Unorm;
 			}
-
-			desc.Width = width;
-			desc.Height = height;
-			desc.DepthOrArraySize = 1;
-			desc.MipCount = 1;
-			desc.Stride = TextureHelper::PitchSize(desc.Format, width);
-			desc.Dimension = ResourceDimension::Texture2D;
-			desc.Flags = (u32)BindFlag::ShaderResource;
-
-			texture = std::make_shared<Texture>();
-			texture->CreateTexture(Application::GEngine->Device(), desc);
-			texture->SetData(p);
 		}
 
-		stbi_image_free(p);
-	}
-	else
-	{
-		assert(0 && "Failed to load texture.");
+		desc.Width = width;
+		desc.Height = height;
+		desc.DepthOrArraySize = 1;
+		desc.MipCount = 1;
+		desc.Stride = TextureHelper::PitchSize(desc.Format, width);
+		desc.Dimension = ResourceDimension::Texture2D;
+		desc.Flags = (u32)BindFlag::ShaderResource;
+
+		texture = std::make_shared<Texture>();
+		texture->CreateTexture(Application::GEngine->Device(), desc);
+		texture->SetData(pixels);
 	}
 
 	return texture;
@@ -0,0 +1,47 @@
+#include "Resource/TextureCooker.h"
+#include "FileSystem/Serialize.h"
+
+// Only what CreateTexture needs, the rest of the desc is derived or runtime state
+static bool Serialize(Archive& archive, ResourceDesc& desc)
+{
+	return Serialize(archive, desc.Dimension) &&
+		Serialize(archive, desc.Width) &&
+		Serialize(archive, desc.Height) &&
+		Serialize(archive, desc.DepthOrArraySize) &&
+		Serialize(archive, desc.MipCount) &&
+		Serialize(archive, desc.Format) &&
+		Serialize(archive, desc.Flags) &&
+		Serialize(archive, desc.Stride);
+}
+
+bool SerializeTextureHeader(Archive& archive, ResourceDesc& desc, u32& byteCount)
+{
+	if (SerializeHeader(archive, TEXTURE_MAGIC, TEXTURE_VERSION) == false ||
+		Serialize(archive, desc) == false ||
+		Serialize(archive, byteCount) == false)
+	{
+		return false;
+	}
+
+	// A bad count fails here instead of allocating it
+	if (archive.IsLoading() && byteCount > archive.Remaining())
+	{
+		return archive.Fail();
+	}
+	return true;
+}
+
+bool Serialize(Archive& archive, CookedTexture& texture)
+{
+	u32 byteCount = (u32)texture.m_Data.size();
+	if (SerializeTextureHeader(archive, texture.m_Desc, byteCount) == false)
+	{
+		return false;
+	}
+
+	if (archive.IsLoading())
+	{
+		texture.m_Data.resize(byteCount);
+	}
+	return SerializeArray(archive, texture.m_Data.data(), byteCount);
+}
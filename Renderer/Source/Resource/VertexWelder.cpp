@@ -0,0 +1,140 @@
+#include "Resource/VertexWelder.h"
+#include "System/Assert.h"
+#include "System/Hash64.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+static u64 DefaultHash(const Byte* key, u32 size)
+{
+	return Hash64::ComputeHash(key, size);
+}
+
+VertexWelder::VertexWelder(u32 vertexSize, u64 expectedCount, float epsilon) :
+	m_Hash(&DefaultHash), m_VertexSize(vertexSize), m_Epsilon(epsilon)
+{
+	assert(vertexSize > 0);
+	assert(epsilon == 0.0f || vertexSize % sizeof(float) == 0);
+
+	if (m_Epsilon > 0.0f)
+	{
+		m_Scratch.resize(vertexSize);
+	}
+	Reserve(expectedCount);
+}
+
+void VertexWelder::Reserve(u64 count)
+{
+	m_Vertices.reserve((size_t)(count * m_VertexSize));
+	m_Hashes.reserve((size_t)count);
+	if (m_Epsilon > 0.0f)
+	{
+		m_Keys.reserve((size_t)(count * m_VertexSize));
+	}
+
+	// Never more than half full, probes stay short
+	u64 capacity = 16;
+	while (capacity < count * 2)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity > m_Table.size())
+	{
+		Rehash(capacity);
+	}
+}
+
+void VertexWelder::Clear()
+{
+	std::fill(m_Table.begin(), m_Table.end(), 0);
+	m_Hashes.clear();
+	m_Vertices.clear();
+	m_Keys.clear();
+	m_Count = 0;
+}
+
+void VertexWelder::SetHashFunction(HashFunction hash)
+{
+	// Hashes already stored would no longer match
+	assert(m_Count == 0);
+	m_Hash = hash != nullptr ? hash : &DefaultHash;
+}
+
+const Byte* VertexWelder::Key(const void* vertex)
+{
+	if (m_Epsilon <= 0.0f)
+	{
+		return (const Byte*)vertex;
+	}
+
+	// memcpy, vertices dont have too be aligned
+	u32 floatCount = m_VertexSize / sizeof(float);
+	for (u32 i = 0; i < floatCount; ++i)
+	{
+		float value;
+		memcpy(&value, (const Byte*)vertex + i * sizeof(float), sizeof(float));
+
+		// + 0.0f turns -0 into 0, both round the same so they must weld
+		value = std::round(value / m_Epsilon) * m_Epsilon + 0.0f;
+		memcpy(m_Scratch.data() + i * sizeof(float), &value, sizeof(float));
+	}
+	return m_Scratch.data();
+}
+
+const Byte* VertexWelder::KeyAt(u32 index)const
+{
+	const std::vector<Byte>& keys = m_Epsilon > 0.0f ? m_Keys : m_Vertices;
+	return keys.data() + (size_t)index * m_VertexSize;
+}
+
+u32 VertexWelder::Add(const void* vertex)
+{
+	const Byte* key = Key(vertex);
+	u64 hash = m_Hash(key, m_VertexSize);
+
+	u64 slot = hash & m_Mask;
+	while (m_Table[slot] != 0)
+	{
+		u32 index = m_Table[slot] - 1;
+		if (m_Hashes[index] == hash && memcmp(KeyAt(index), key, m_VertexSize) == 0)
+		{
+			return index;
+		}
+		slot = (slot + 1) & m_Mask;
+	}
+
+	// Indices are u32 and 0 marks an empty slot
+	assert(m_Count < UINT32_MAX - 1);
+
+	u32 index = m_Count++;
+	m_Table[slot] = index + 1;
+	m_Hashes.push_back(hash);
+	m_Vertices.insert(m_Vertices.end(), (const Byte*)vertex, (const Byte*)vertex + m_VertexSize);
+	if (m_Epsilon > 0.0f)
+	{
+		m_Keys.insert(m_Keys.end(), key, key + m_VertexSize);
+	}
+
+	if ((u64)m_Count * 2 > m_Table.size())
+	{
+		Rehash(m_Table.size() * 2);
+	}
+	return index;
+}
+
+void VertexWelder::Rehash(u64 capacity)
+{
+	m_Table.assign((size_t)capacity, 0);
+	m_Mask = capacity - 1;
+
+	for (u32 index = 0; index < m_Count; ++index)
+	{
+		u64 slot = m_Hashes[index] & m_Mask;
+		while (m_Table[slot] != 0)
+		{
+			slot = (slot + 1) & m_Mask;
+		}
+		m_Table[slot] = index + 1;
+	}
+}
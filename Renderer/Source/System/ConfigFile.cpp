@@ -1,6 +1,8 @@
 #include "System/ConfigFile.h"
 #include "System/Logger.h"
 #include "FileSystem/File/TextFile.h"
+#include "FileSystem/File/TextReader.h"
+#include "System/StringUtil.h"
 #include <locale>
 
 
@@ -16,38 +18,48 @@ ConfigFile::~ConfigFile()
 void ConfigFile::Open(std::string fileName)
 {
 	//Load File into our file structure
-	TextFile configFile;
+	TextReader configFile;
 
-	if (configFile.Open(fileName.c_str(), FileMode::Read))
+	if (configFile.Open(fileName))
 	{
-		std::string line;
-		std::string key;
-		std::string value;
-
-		std::string currentSection = "";
+		std::string_view line;
 		Settings* currentSettings = nullptr;
 
 		//Load all Config settings into the Map
-		while (!configFile.IsEndOfFile())
+		while (configFile.ReadLine(line))
 		{
-			configFile.ReadLine(line, true);
+			line = StringUtil::TrimEnd(line);
 
-			if (line.length() > 0 && line.at(0) != '#') // ignore comments
+			if (line.length() > 0 && line.front() != '#') // ignore comments
 			{
-				if (line.at(0) == '[' && line.at(line.length() - 1) == ']')
+				if (line.front() == '[' && line.back() == ']')
 				{
-					// Section
-					currentSection = line.substr(1, line.length() - 2);
-					currentSettings = &m_Settings[currentSection];	// This creates the section if it doesnt exist already
+					// Section, only allocates the first time a name is seen
+					std::string_view name = line.substr(1, line.length() - 2);
+					SectionIterator itr = m_Settings.find(name);
+					if (itr == m_Settings.end())
+					{
+						itr = m_Settings.emplace(std::string(name), Settings()).first;
+					}
+					currentSettings = &itr->second;
 				}
 				else
 				{
-					int seperator_Pos = (int)line.find_first_of('=', (size_t)0);
-					if (seperator_Pos > 0)
+					size_t seperator_Pos = line.find('=');
+					if (seperator_Pos != std::string_view::npos && seperator_Pos > 0)
 					{
-						key = line.substr(0, seperator_Pos);
-						value = line.substr((size_t)seperator_Pos + 1);
-						currentSettings->insert(std::make_pair(key, value));
+						// Keys before any section used too crash, give them the unnamed one
+						if (currentSettings == nullptr)
+						{
+							currentSettings = &m_Settings[""];
+						}
+
+						// First one wins like before, so a repeat key costs nothing
+						std::string_view key = line.substr(0, seperator_Pos);
+						if (currentSettings->find(key) == currentSettings->end())
+						{
+							currentSettings->emplace(std::string(key), std::string(line.substr(seperator_Pos + 1)));
+						}
 					}
 				}
 			}
@@ -0,0 +1,110 @@
+#include "System/Hash64.h"
+#include <cstring>
+
+namespace
+{
+	const u64 Prime1 = 0x9E3779B185EBCA87ULL;
+	const u64 Prime2 = 0xC2B2AE3D27D4EB4FULL;
+	const u64 Prime3 = 0x165667B19E3779F9ULL;
+	const u64 Prime4 = 0x85EBCA77C2B2AE63ULL;
+	const u64 Prime5 = 0x27D4EB2F165667C5ULL;
+
+	inline u64 RotateLeft(u64 value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	// Little endian loads, memcpy so unaligned input is fine
+	inline u64 Read64(const Byte* data)
+	{
+		u64 value;
+		memcpy(&value, data, sizeof(u64));
+		return value;
+	}
+
+	inline u32 Read32(const Byte* data)
+	{
+		u32 value;
+		memcpy(&value, data, sizeof(u32));
+		return value;
+	}
+
+	inline u64 Round(u64 accumulator, u64 input)
+	{
+		accumulator += input * Prime2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * Prime1;
+	}
+
+	inline u64 MergeRound(u64 accumulator, u64 value)
+	{
+		accumulator ^= Round(0, value);
+		return accumulator * Prime1 + Prime4;
+	}
+}
+
+u64 Hash64::ComputeHash(const Byte* data, u64 size, u64 seed)
+{
+	const Byte* end = data + size;
+	u64 hash;
+
+	if (size >= 32)
+	{
+		// Four independent lanes over 32 byte stripes
+		u64 v1 = seed + Prime1 + Prime2;
+		u64 v2 = seed + Prime2;
+		u64 v3 = seed;
+		u64 v4 = seed - Prime1;
+
+		const Byte* limit = end - 32;
+		do
+		{
+			v1 = Round(v1, Read64(data));		data += 8;
+			v2 = Round(v2, Read64(data));		data += 8;
+			v3 = Round(v3, Read64(data));		data += 8;
+			v4 = Round(v4, Read64(data));		data += 8;
+		} while (data <= limit);
+
+		hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		hash = MergeRound(hash, v1);
+		hash = MergeRound(hash, v2);
+		hash = MergeRound(hash, v3);
+		hash = MergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + Prime5;
+	}
+
+	hash += size;
+
+	// Tail
+	while (data + 8 <= end)
+	{
+		hash ^= Round(0, Read64(data));
+		hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+		data += 8;
+	}
+
+	if (data + 4 <= end)
+	{
+		hash ^= (u64)Read32(data) * Prime1;
+		hash = RotateLeft(hash, 23) * Prime2 + Prime3;
+		data += 4;
+	}
+
+	while (data < end)
+	{
+		hash ^= (*data) * Prime5;
+		hash = RotateLeft(hash, 11) * Prime1;
+		++data;
+	}
+
+	// Avalanche
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
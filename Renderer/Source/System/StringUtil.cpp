@@ -1,5 +1,6 @@
 #pragma once
 #include "System/StringUtil.h"
+#include <cctype>
 
 namespace StringUtil
 {
@@ -153,4 +154,14 @@ namespace StringUtil
 
 		return stringList;
 	}
+
+	std::string_view TrimEnd(std::string_view text)
+	{
+		size_t length = text.size();
+		while (length > 0 && isspace((unsigned char)text[length - 1]))
+		{
+			--length;
+		}
+		return text.substr(0, length);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "System/ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+ThreadPool::ThreadPool(u32 threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	m_Running = true;
+	for (u32 i = 0; i < threadCount; ++i)
+	{
+		m_Threads.emplace_back(&ThreadPool::WorkerThread, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Running = false;
+	}
+
+	m_Signal.notify_all();
+	for (std::thread& thread : m_Threads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		m_Tasks.push_back(std::move(task));
+	}
+	m_Signal.notify_one();
+}
+
+bool ThreadPool::ParallelFor(u32 count, const std::function<bool(u32 index)>& task)
+{
+	struct State
+	{
+		std::atomic<u32>		m_Next{ 0 };
+		std::atomic<u32>		m_Done{ 0 };
+		std::atomic<bool>		m_Failed{ false };
+		std::mutex				m_Lock;
+		std::condition_variable m_Signal;
+	};
+
+	// Helpers can start after the work is gone, so the state outlives this call
+	std::shared_ptr<State> state = std::make_shared<State>();
+	const std::function<bool(u32)>* work = &task;
+	auto run = [state, work, count]()
+	{
+		// task is only touched while an index is still unclaimed, ie. before we return
+		for (u32 i = state->m_Next++; i < count; i = state->m_Next++)
+		{
+			if ((*work)(i) == false)
+			{
+				state->m_Failed = true;
+			}
+
+			if (++state->m_Done == count)
+			{
+				std::lock_guard<std::mutex> lock(state->m_Lock);
+				state->m_Signal.notify_all();
+			}
+		}
+	};
+
+	u32 helpers = std::min(ThreadCount(), count > 0 ? count - 1 : 0);
+	for (u32 i = 0; i < helpers; ++i)
+	{
+		Submit(run);
+	}
+
+	run();
+
+	std::unique_lock<std::mutex> lock(state->m_Lock);
+	state->m_Signal.wait(lock, [&state, count]() { return state->m_Done.load() == count; });
+	return state->m_Failed == false;
+}
+
+void ThreadPool::WorkerThread()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_Lock);
+			m_Signal.wait(lock, [this]() { return m_Running == false || m_Tasks.empty() == false; });
+			if (m_Running == false && m_Tasks.empty())
+			{
+				return;
+			}
+
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,38 @@
+//NOTE:
+/*
+	Tiny test runner for the Tests project, no framework too vendor. Each TEST registers
+	itself before main runs, main runs them all (or the ones whose name contains argv[1])
+	and returns how many failed so a build step can check it.
+
+	CHECK records a failure and carries on, REQUIRE records it and leaves the test. Tests
+	write any files they need into the working directory and remove them again.
+*/
+#pragma once
+#include "System/Types.h"
+#include <string>
+#include <vector>
+
+namespace Test
+{
+	typedef void (*Function)();
+
+	bool Register(const char* name, Function function);
+	void Fail(const char* file, int line, const char* expression);
+
+	// Deterministic data for a seed, random bytes dont compress, text does
+	std::vector<u8> RandomBytes(u32 size, u32 seed);
+	std::vector<u8> RandomText(u32 size, u32 seed);
+	bool WriteFile(const std::string& path, const std::vector<u8>& data);
+	bool ReadFile(const std::string& path, std::vector<u8>& data);
+	void RemoveFile(const std::string& path);
+	// Handles (fds on linux) the process has open right now, for spotting leaks
+	u32 OpenHandleCount();
+};
+
+#define TEST(name) \
+	static void Test_##name(); \
+	static const bool s_Registered_##name = Test::Register(#name, &Test_##name); \
+	static void Test_##name()
+
+#define CHECK(x) if (x) { } else { Test::Fail(__FILE__, __LINE__, #x); }
+#define REQUIRE(x) if (x) { } else { Test::Fail(__FILE__, __LINE__, #x); return; }
@@ -0,0 +1,82 @@
+#include "Test.h"
+#include "FileSystem/File/TextReader.h"
+#include "System/ConfigFile.h"
+#include <cstring>
+
+namespace
+{
+	std::vector<u8> Text(const char* text)
+	{
+		return std::vector<u8>(text, text + strlen(text));
+	}
+};
+
+TEST(TextReaderLines)
+{
+	const char* text = "first\r\nsecond\n\n  third  \r\nlast";
+	TextReader reader(text, strlen(text));
+
+	std::vector<std::string> lines;
+	std::string_view line;
+	while (reader.ReadLine(line))
+	{
+		lines.emplace_back(line);
+	}
+	CHECK(lines == std::vector<std::string>({ "first", "second", "", "  third  ", "last" }));
+	CHECK(reader.IsEndOfFile());
+
+	reader.Rewind();
+	CHECK(reader.ReadLine(line) && line == "first");
+
+	// Through a file, mapped where the platform can
+	REQUIRE(Test::WriteFile("TestConfig_Lines.txt", Text("a\nb\r\n")));
+	{
+		TextReader file("TestConfig_Lines.txt");
+		REQUIRE(file.IsOpen());
+		CHECK(file.ReadLine(line) && line == "a");
+		CHECK(file.ReadLine(line) && line == "b");
+		CHECK(file.ReadLine(line) == false);
+	}
+	Test::RemoveFile("TestConfig_Lines.txt");
+
+	TextReader empty("", 0);
+	CHECK(empty.ReadLine(line) == false);
+}
+
+TEST(ConfigFileParse)
+{
+	REQUIRE(Test::WriteFile("TestConfig_Settings.ini", Text(
+		"Loose=before any section\n"
+		"[Window]\r\n"
+		"# Comment=ignored\n"
+		"Width=1280   \n"
+		"Height=720\n"
+		"Width=640\n"
+		"=no key\n"
+		"no separator\n"
+		"\n"
+		"[Graphics]\n"
+		"VSync=true\n"
+		"Scale=1.5\n"
+		"[Window]\n"
+		"Title=Renderer = Demo")));
+
+	ConfigFile config;
+	config.Open("TestConfig_Settings.ini");
+	CHECK(config.IsOpen());
+
+	// Trailing space trimmed, first of a repeated key wins, a repeated section merges
+	CHECK(config.GetInt("Window", "Width") == 1280);
+	CHECK(config.GetInt("Window", "Height") == 720);
+	CHECK(config.GetString("Window", "Title") == "Renderer = Demo");
+	CHECK(config.GetBool("Graphics", "VSync") == true);
+	CHECK(config.GetFloat("Graphics", "Scale") == 1.5f);
+	CHECK(config.GetString("", "Loose") == "before any section");
+	CHECK(config.m_Settings.size() == 3);
+	CHECK(config.m_Settings["Window"].size() == 3);
+	CHECK(config.GetString("Window", "# Comment", "missing") == "missing");
+
+	// Close would write it back out
+	config.Clear();
+	Test::RemoveFile("TestConfig_Settings.ini");
+}
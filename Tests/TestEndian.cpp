@@ -0,0 +1,42 @@
+#include "Test.h"
+#include "FileSystem/Endian.h"
+
+TEST(EndianSwapKernels)
+{
+	// Odd counts and an unaligned start so every kernel runs its scalar tail too
+	std::vector<u8> source = Test::RandomBytes(64 * 1024 + 3, 1);
+	for (u32 wordSize = 2; wordSize <= 8; wordSize *= 2)
+	{
+		u64 count = (source.size() - 1) / wordSize;
+		std::vector<u8> expected = source;
+		for (u64 i = 0; i < count; ++i)
+		{
+			u8* word = expected.data() + 1 + i * wordSize;
+			for (u32 b = 0; b < wordSize / 2; ++b)
+			{
+				std::swap(word[b], word[wordSize - 1 - b]);
+			}
+		}
+
+		for (u32 k = (u32)SwapKernel::Scalar; k <= (u32)SwapKernel::Best; ++k)
+		{
+			for (u64 length : { (u64)0, (u64)1, (u64)7, (u64)33, count })
+			{
+				std::vector<u8> data = source;
+				SwapEndian(data.data() + 1, length, wordSize, (SwapKernel)k);
+				CHECK(std::equal(data.begin(), data.begin() + 1 + length * wordSize, expected.begin()));
+				CHECK(std::equal(data.begin() + 1 + length * wordSize, data.end(), source.begin() + 1 + length * wordSize));
+			}
+		}
+	}
+
+	u16 value16 = 0x1234;
+	u32 value32 = 0x12345678;
+	u64 value64 = 0x0123456789ABCDEF;
+	SwapEndian16(&value16, 1);
+	SwapEndian32(&value32, 1);
+	SwapEndian64(&value64, 1);
+	CHECK(value16 == 0x3412 && value16 == ByteSwap16(0x1234));
+	CHECK(value32 == 0x78563412 && value32 == ByteSwap32(0x12345678));
+	CHECK(value64 == 0xEFCDAB8967452301 && value64 == ByteSwap64(0x0123456789ABCDEF));
+}
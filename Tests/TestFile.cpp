@@ -0,0 +1,82 @@
+#include "Test.h"
+#include "FileSystem/File/BinaryFile.h"
+#include <cstdio>
+
+namespace
+{
+	std::vector<u8> Counting(u32 size)
+	{
+		std::vector<u8> data(size);
+		for (u32 i = 0; i < size; ++i)
+		{
+			data[i] = (u8)i;
+		}
+		return data;
+	}
+};
+
+TEST(BinaryFileSeek)
+{
+	REQUIRE(Test::WriteFile("TestFile_Seek.bin", Counting(256)));
+	{
+		BinaryFile file("TestFile_Seek.bin", FileMode::Read);
+		REQUIRE(file.IsOpen());
+
+		// Seek(origin, offset) like every other BaseFile
+		file.Seek(SEEK_SET, 10);
+		CHECK(file.FilePosition() == 10);
+		CHECK(file.ReadByte() == 10);
+
+		file.Seek(SEEK_CUR, 5);
+		CHECK(file.FilePosition() == 16);
+		CHECK(file.ReadByte() == 16);
+
+		file.SeekEnd();
+		CHECK(file.FilePosition() == 256);
+		file.SeekStart();
+		CHECK(file.ReadByte() == 0);
+
+		u8 data[4] = {};
+		CHECK(file.ReadFrom(data, 100, 4));
+		CHECK(data[0] == 100 && data[3] == 103);
+		CHECK(file.FilePosition() == 104);
+		file.Close();
+	}
+	Test::RemoveFile("TestFile_Seek.bin");
+}
+
+TEST(BinaryFileFlushesOnDestroy)
+{
+	std::vector<u8> data = Counting(1000);
+	{
+		// Buffered writes that never reach Close, like an early return would leave them
+		BinaryFile file("TestFile_Buffered.bin", FileMode::Write);
+		REQUIRE(file.IsOpen());
+		REQUIRE(file.SetWriteBuffer(4096));
+		REQUIRE(file.Write(data.data(), (u32)data.size()));
+	}
+
+	std::vector<u8> read;
+	CHECK(Test::ReadFile("TestFile_Buffered.bin", read));
+	CHECK(read == data);
+
+	{
+		BinaryFile file("TestFile_Buffered.bin", FileMode::Write);
+		REQUIRE(file.SetWriteBuffer(4096));
+		REQUIRE(file.Write(data.data(), 10));
+		file.Close();
+		file.Close();
+		CHECK(file.IsOpen() == false);
+
+		// Reopening flushes and closes the previous file first
+		REQUIRE(file.Open("TestFile_Buffered.bin", FileMode::Write));
+		REQUIRE(file.SetWriteBuffer(4096));
+		REQUIRE(file.Write(data.data(), 20));
+		REQUIRE(file.Open("TestFile_Other.bin", FileMode::Write));
+	}
+
+	CHECK(Test::ReadFile("TestFile_Buffered.bin", read));
+	CHECK(read.size() == 20);
+	Test::RemoveFile("TestFile_Buffered.bin");
+	Test::RemoveFile("TestFile_Other.bin");
+}
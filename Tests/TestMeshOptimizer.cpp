@@ -0,0 +1,343 @@
+#include "Test.h"
+#include "Resource/MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// Quad grid triangles in row order, side * side vertices
+	std::vector<u32> GridIndices(u32 quads)
+	{
+		u32 side = quads + 1;
+		std::vector<u32> indices;
+		indices.reserve((size_t)quads * quads * 6);
+		for (u32 y = 0; y < quads; ++y)
+		{
+			for (u32 x = 0; x < quads; ++x)
+			{
+				u32 a = y * side + x;
+				u32 quad[6] = { a, a + side, a + 1, a + 1, a + side, a + side + 1 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+		return indices;
+	}
+
+	// Triangle order shuffled, each triangle also rotated so its first corner changes
+	void ShuffleTriangles(u32* indices, u64 indexCount, u32 seed)
+	{
+		std::mt19937 random(seed);
+		u64 triangleCount = indexCount / 3;
+		for (u64 i = triangleCount; i > 1; --i)
+		{
+			u64 j = random() % i;
+			std::swap_ranges(indices + (i - 1) * 3, indices + i * 3, indices + j * 3);
+		}
+
+		for (u64 t = 0; t < triangleCount; ++t)
+		{
+			std::rotate(indices + t * 3, indices + t * 3 + random() % 3, indices + t * 3 + 3);
+		}
+	}
+
+	// Sorted triangles, each rotated too start at its smallest index so winding is kept
+	std::vector<std::array<u32, 3>> Triangles(const u32* indices, u64 indexCount)
+	{
+		std::vector<std::array<u32, 3>> triangles;
+		for (u64 i = 0; i + 3 <= indexCount; i += 3)
+		{
+			std::array<u32, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	float Acmr(const std::vector<u32>& indices, u32 vertexCount, CacheModel model = CacheModel::Fifo)
+	{
+		return MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, 16, model).m_Acmr;
+	}
+
+	// Closed bumpy sphere, rings * segments quads with the poles as degenerate triangles
+	void AddBlob(std::vector<Vector3>& positions, std::vector<u32>& indices, const Vector3& centre, u32 rings, u32 segments)
+	{
+		const float pi = 3.14159265f;
+		u32 base = (u32)positions.size();
+		for (u32 r = 0; r <= rings; ++r)
+		{
+			float theta = pi * r / rings;
+			for (u32 s = 0; s < segments; ++s)
+			{
+				float phi = 2.0f * pi * s / segments;
+				float radius = 1.0f + 0.2f * std::sin(5.0f * theta) * std::cos(4.0f * phi);
+				positions.push_back(centre + Vector3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)) * radius);
+			}
+		}
+
+		for (u32 r = 0; r < rings; ++r)
+		{
+			for (u32 s = 0; s < segments; ++s)
+			{
+				u32 a = base + r * segments + s;
+				u32 b = base + r * segments + (s + 1) % segments;
+				u32 quad[6] = { a, a + segments, b, b, a + segments, b + segments };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	// Overlapping blobs so every view has something behind something else
+	void Blobs(std::vector<Vector3>& positions, std::vector<u32>& indices, u32 count)
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			AddBlob(positions, indices, Vector3(i * 1.2f, (i % 2) * 0.8f, (i % 3) * 0.7f), 24, 32);
+		}
+	}
+
+	OverdrawStats Overdraw(std::vector<u32>& indices, std::vector<Vector3>& positions)
+	{
+		return MeshOptimizer::AnalyzeOverdraw(indices.data(), indices.size(), StridedArray<Vector3>(positions.data()), (u32)positions.size());
+	}
+};
+
+TEST(MeshOptimizerVertexCache)
+{
+	const u32 quads = 100;
+	const u32 vertexCount = (quads + 1) * (quads + 1);
+	std::vector<u32> grid = GridIndices(quads);
+
+	std::vector<u32> shuffled = grid;
+	ShuffleTriangles(shuffled.data(), shuffled.size(), 1);
+
+	std::vector<u32> optimized(shuffled.size());
+	MeshOptimizer::OptimizeVertexCache(optimized.data(), shuffled.data(), shuffled.size(), vertexCount);
+
+	CHECK(Triangles(optimized.data(), optimized.size()) == Triangles(grid.data(), grid.size()));
+
+	// Shuffled is about as bad as it gets, optimized has too beat it and the row order too
+	float before = Acmr(shuffled, vertexCount);
+	float after = Acmr(optimized, vertexCount);
+	CHECK(before > 2.5f);
+	CHECK(after < before);
+	CHECK(after < Acmr(grid, vertexCount));
+	CHECK(after < 0.8f);
+	CHECK(Acmr(optimized, vertexCount, CacheModel::Lru) < Acmr(shuffled, vertexCount, CacheModel::Lru));
+
+	// Same result in place
+	std::vector<u32> inPlace = shuffled;
+	MeshOptimizer::OptimizeVertexCache(inPlace.data(), inPlace.data(), inPlace.size(), vertexCount);
+	CHECK(inPlace == optimized);
+
+	// Indices that dont make a whole triangle are copied as is
+	std::vector<u32> trailing = shuffled;
+	trailing.push_back(7);
+	trailing.push_back(3);
+	MeshOptimizer::OptimizeVertexCache(trailing.data(), trailing.data(), trailing.size(), vertexCount);
+	CHECK(trailing[trailing.size() - 2] == 7 && trailing[trailing.size() - 1] == 3);
+	CHECK(Triangles(trailing.data(), trailing.size()) == Triangles(grid.data(), grid.size()));
+
+	// Nothing too do
+	MeshOptimizer::OptimizeVertexCache(optimized.data(), optimized.data(), 0, vertexCount);
+}
+
+TEST(MeshOptimizerVertexCacheParts)
+{
+	// Two grids sharing one vertex buffer, each part has too keep exactly its own triangles
+	const u32 quads = 60;
+	const u32 side = quads + 1;
+	const u32 vertexCount = side * side * 2;
+	std::vector<u32> indices = GridIndices(quads);
+	u64 split = indices.size();
+	for (u64 i = 0; i < split; ++i)
+	{
+		indices.push_back(indices[i] + side * side);
+	}
+
+	std::vector<MeshPart> parts = { MeshPart(0, split), MeshPart(split, indices.size() - split) };
+	ShuffleTriangles(indices.data(), split, 2);
+	ShuffleTriangles(indices.data() + split, indices.size() - split, 3);
+	std::vector<u32> shuffled = indices;
+
+	MeshOptimizer::OptimizeVertexCache(indices.data(), vertexCount, parts);
+
+	for (const MeshPart& part : parts)
+	{
+		const u32* before = shuffled.data() + part.m_Start;
+		const u32* after = indices.data() + part.m_Start;
+		CHECK(Triangles(after, part.m_Count) == Triangles(before, part.m_Count));
+
+		std::vector<u32> partBefore(before, before + part.m_Count);
+		std::vector<u32> partAfter(after, after + part.m_Count);
+		CHECK(Acmr(partAfter, vertexCount) < Acmr(partBefore, vertexCount));
+	}
+}
+
+TEST(MeshOptimizerOverdraw)
+{
+	std::vector<Vector3> positions;
+	std::vector<u32> indices;
+	Blobs(positions, indices, 6);
+	u32 vertexCount = (u32)positions.size();
+	StridedArray<Vector3> stream(positions.data());
+
+	// Overdraw runs on cache ordered triangles, that's the ACMR it's allowed too give up
+	ShuffleTriangles(indices.data(), indices.size(), 5);
+	std::vector<u32> cached(indices.size());
+	MeshOptimizer::OptimizeVertexCache(cached.data(), indices.data(), indices.size(), vertexCount);
+	OverdrawStats before = Overdraw(cached, positions);
+	REQUIRE(before.m_Overdraw > 1.0f);
+
+	for (float threshold : { 1.05f, 1.5f })
+	{
+		std::vector<u32> optimized(cached.size());
+		MeshOptimizer::OptimizeOverdraw(optimized.data(), cached.data(), cached.size(), stream, vertexCount, threshold);
+		CHECK(Triangles(optimized.data(), optimized.size()) == Triangles(cached.data(), cached.size()));
+
+		// Same pixels covered, fewer of them shaded twice
+		OverdrawStats after = Overdraw(optimized, positions);
+		CHECK(after.m_Covered == before.m_Covered);
+		CHECK(after.m_Overdraw <= before.m_Overdraw);
+		CHECK(after.m_Overdraw >= 1.0f);
+		CHECK(Acmr(optimized, vertexCount) <= Acmr(cached, vertexCount) * threshold);
+	}
+
+	// A looser threshold makes more clusters too sort, it has too actually win something
+	std::vector<u32> loose(cached.size());
+	MeshOptimizer::OptimizeOverdraw(loose.data(), cached.data(), cached.size(), stream, vertexCount, 1.5f);
+	CHECK(Overdraw(loose, positions).m_Overdraw < before.m_Overdraw);
+
+	// Same result in place
+	std::vector<u32> inPlace = cached;
+	MeshOptimizer::OptimizeOverdraw(inPlace.data(), inPlace.data(), inPlace.size(), stream, vertexCount, 1.5f);
+	CHECK(inPlace == loose);
+
+	// Flipping every triangle's winding flips what's front facing, the stats cant change
+	std::vector<u32> flipped = cached;
+	for (u64 i = 0; i < flipped.size(); i += 3)
+	{
+		std::swap(flipped[i + 1], flipped[i + 2]);
+	}
+	OverdrawStats flippedStats = Overdraw(flipped, positions);
+	CHECK(flippedStats.m_Covered == before.m_Covered);
+	CHECK(flippedStats.m_Shaded == before.m_Shaded);
+}
+
+TEST(MeshOptimizerOverdrawParts)
+{
+	// Each part's blobs have too stay inside its own range
+	std::vector<Vector3> positions;
+	std::vector<u32> indices;
+	Blobs(positions, indices, 2);
+	u64 split = indices.size();
+	Blobs(positions, indices, 4);
+	u32 vertexCount = (u32)positions.size();
+
+	std::vector<MeshPart> parts = { MeshPart(0, split), MeshPart(split, indices.size() - split) };
+	MeshOptimizer::OptimizeVertexCache(indices.data(), vertexCount, parts);
+	std::vector<u32> cached = indices;
+
+	MeshOptimizer::OptimizeOverdraw(indices.data(), StridedArray<Vector3>(positions.data()), vertexCount, parts, 1.5f);
+	for (const MeshPart& part : parts)
+	{
+		const u32* before = cached.data() + part.m_Start;
+		const u32* after = indices.data() + part.m_Start;
+		CHECK(Triangles(after, part.m_Count) == Triangles(before, part.m_Count));
+
+		std::vector<u32> partBefore(before, before + part.m_Count);
+		std::vector<u32> partAfter(after, after + part.m_Count);
+		CHECK(Acmr(partAfter, vertexCount) <= Acmr(partBefore, vertexCount) * 1.5f);
+		CHECK(Overdraw(partAfter, positions).m_Overdraw <= Overdraw(partBefore, positions).m_Overdraw);
+	}
+}
+
+TEST(MeshOptimizerVertexFetch)
+{
+	// A grid with its vertices shuffled through memory, and a few nothing uses
+	const u32 quads = 80;
+	const u32 side = quads + 1;
+	const u32 unused = 10;
+	const u32 vertexCount = side * side + unused;
+	std::vector<u32> shuffle(vertexCount);
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		shuffle[v] = v;
+	}
+	std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(6));
+
+	std::vector<Vector3> positions(vertexCount);
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		positions[shuffle[v]] = Vector3((float)(v % side), 0.0f, (float)(v / side));
+	}
+
+	std::vector<u32> indices = GridIndices(quads);
+	for (u32& index : indices)
+	{
+		index = shuffle[index];
+	}
+	MeshOptimizer::OptimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount);
+
+	std::vector<u32> remap(vertexCount);
+	u32 used = MeshOptimizer::OptimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertexCount);
+	CHECK(used == side * side);
+
+	// A permutation, with the unused vertices at the end in their old order
+	std::vector<u32> sorted = remap;
+	std::sort(sorted.begin(), sorted.end());
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		REQUIRE(sorted[v] == v);
+	}
+
+	u32 last = 0;
+	for (u32 i = 0; i < unused; ++i)
+	{
+		u32 v = shuffle[side * side + i];
+		CHECK(remap[v] >= used);
+	}
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		if (remap[v] >= used)
+		{
+			CHECK(remap[v] >= last);
+			last = remap[v];
+		}
+	}
+
+	std::vector<u32> remapped = indices;
+	MeshOptimizer::RemapIndices(remapped.data(), remapped.size(), remap.data());
+	std::vector<Vector3> remappedPositions = positions;
+	MeshOptimizer::RemapVertices(remappedPositions, remap.data());
+
+	// Every corner still lands on the same position, and vertices are first used in order
+	u32 next = 0;
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		const Vector3& a = positions[indices[i]];
+		const Vector3& b = remappedPositions[remapped[i]];
+		REQUIRE(a.x == b.x && a.y == b.y && a.z == b.z);
+		REQUIRE(remapped[i] <= next);
+		next += remapped[i] == next ? 1 : 0;
+	}
+
+	// Fetch walks memory forwards now, so vertices smaller than a line share them
+	for (u32 vertexSize : { 12u, 36u })
+	{
+		VertexFetchStats before = MeshOptimizer::AnalyzeVertexFetch(indices.data(), indices.size(), vertexCount, vertexSize);
+		VertexFetchStats after = MeshOptimizer::AnalyzeVertexFetch(remapped.data(), remapped.size(), vertexCount, vertexSize);
+		CHECK(after.m_Overfetch < before.m_Overfetch);
+		CHECK(after.m_Overfetch >= 1.0f);
+	}
+
+	// A packed VertexMesh is exactly one line, order cant help or hurt it
+	VertexFetchStats before = MeshOptimizer::AnalyzeVertexFetch(indices.data(), indices.size(), vertexCount, 64);
+	VertexFetchStats after = MeshOptimizer::AnalyzeVertexFetch(remapped.data(), remapped.size(), vertexCount, 64);
+	CHECK(after.m_Overfetch <= before.m_Overfetch);
+
+	// Only reorders vertices, the cache sees the same thing
+	CHECK(Acmr(remapped, vertexCount) == Acmr(indices, vertexCount));
+}
@@ -0,0 +1,196 @@
+#include "Test.h"
+#include "Resource/ObjParser.h"
+#include <cstdarg>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+	bool SameObj(const ObjData& a, const ObjData& b)
+	{
+		if (a.m_Positions != b.m_Positions || a.m_TexCoords != b.m_TexCoords || a.m_Normals != b.m_Normals || a.m_Colors != b.m_Colors ||
+			a.m_Indices.size() != b.m_Indices.size() || a.m_Shapes.size() != b.m_Shapes.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < a.m_Indices.size(); ++i)
+		{
+			const ObjIndex& x = a.m_Indices[i];
+			const ObjIndex& y = b.m_Indices[i];
+			if (x.m_Vertex != y.m_Vertex || x.m_TexCoord != y.m_TexCoord || x.m_Normal != y.m_Normal)
+			{
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < a.m_Shapes.size(); ++i)
+		{
+			if (a.m_Shapes[i].m_Start != b.m_Shapes[i].m_Start || a.m_Shapes[i].m_Count != b.m_Shapes[i].m_Count)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Append(std::string& text, const char* format, ...)
+	{
+		char line[256];
+		va_list args;
+		va_start(args, format);
+		int length = vsnprintf(line, sizeof(line), format, args);
+		va_end(args);
+		text.append(line, (size_t)length);
+	}
+
+	// Bumpy grids, one per o/g group, with every face form the fast path reads: quads and
+	// triangles, v, v/vt, v//vn and v/vt/vn corners, negative indices, vertex colours,
+	// comments, blank lines, \r\n endings and lines tinyobj ignores.
+	std::string MakeObj(u32 groups, u32 quads, u32 seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> bump(-0.25f, 0.25f);
+
+		std::string text = "# Generated for ObjParser tests\nmtllib None.mtl\n";
+		u32 side = quads + 1;
+		u32 positions = 0;
+		u32 texCoords = 0;
+		u32 normals = 0;
+		for (u32 group = 0; group < groups; ++group)
+		{
+			Append(text, (group % 2 == 0) ? "o Object%u\n" : "g Group%u\r\n", group);
+
+			bool colors = group % 3 == 1;
+			for (u32 y = 0; y < side; ++y)
+			{
+				for (u32 x = 0; x < side; ++x)
+				{
+					float height = bump(random);
+					if (colors)
+					{
+						Append(text, "v %f %f %f %f %f %f\n", (float)x, height, (float)y, x / (float)quads, height + 0.5f, y / (float)quads);
+					}
+					else
+					{
+						Append(text, "v %f %f %f\n", (float)x, height, (float)y);
+					}
+					Append(text, "vt %f %f\nvn %f 1 %f\n", x / (float)quads, y / (float)quads, bump(random), bump(random));
+				}
+			}
+			text += "\nusemtl None\ns 1\n";
+
+			bool negative = group % 2 == 1;
+			u32 form = group % 4;
+			for (u32 y = 0; y < quads; ++y)
+			{
+				for (u32 x = 0; x < quads; ++x)
+				{
+					u32 local[4] = { y * side + x, y * side + x + 1, (y + 1) * side + x + 1, (y + 1) * side + x };
+					bool quad = (x + y) % 3 != 0;
+
+					std::string face = "f";
+					for (u32 corner = 0; corner < (quad ? 4u : 3u); ++corner)
+					{
+						// Negative counts back from the last element read so far
+						int v = negative ? (int)local[corner] - (int)side * (int)side : (int)(positions + local[corner] + 1);
+						int t = negative ? v : (int)(texCoords + local[corner] + 1);
+						int n = negative ? v : (int)(normals + local[corner] + 1);
+						switch (form)
+						{
+							case 0: Append(face, " %d", v); break;
+							case 1: Append(face, " %d/%d", v, t); break;
+							case 2: Append(face, " %d//%d", v, n); break;
+							default: Append(face, " %d/%d/%d", v, t, n); break;
+						}
+					}
+					text += face + ((x % 7 == 0) ? "\r\n" : "\n");
+				}
+			}
+
+			positions += side * side;
+			texCoords += side * side;
+			normals += side * side;
+		}
+		return text;
+	}
+
+	// Every thread count through Parse, then Load, has too match tinyobj exactly
+	void CheckMatchesTinyObj(const std::string& path)
+	{
+		ObjData reference;
+		REQUIRE(ObjParser::LoadTinyObj(path, reference));
+		REQUIRE(reference.m_Indices.empty() == false);
+
+		std::vector<u8> text;
+		REQUIRE(Test::ReadFile(path, text));
+
+		for (u32 threads : { 1u, 2u, 3u, 8u, 0u })
+		{
+			ObjData obj;
+			CHECK(ObjParser::Parse((const char*)text.data(), text.size(), obj, threads) == ObjResult::Ok);
+			CHECK(SameObj(reference, obj));
+		}
+
+		ObjData loaded;
+		CHECK(ObjParser::Load(path, loaded));
+		CHECK(SameObj(reference, loaded));
+	}
+};
+
+TEST(ObjParserMatchesTinyObjMaterialBall)
+{
+	// Tests run from their project folder
+	CheckMatchesTinyObj("../Renderer/Content/MaterialBall/MaterialBall.obj");
+}
+
+TEST(ObjParserMatchesTinyObjGenerated)
+{
+	std::string text = MakeObj(8, 120, 1);
+	REQUIRE(text.size() > 4 * 1024 * 1024);
+	REQUIRE(Test::WriteFile("TestObj_Generated.obj", std::vector<u8>(text.begin(), text.end())));
+
+	CheckMatchesTinyObj("TestObj_Generated.obj");
+
+	// Each group is its own shape
+	ObjData obj;
+	CHECK(ObjParser::Parse(text.data(), text.size(), obj) == ObjResult::Ok);
+	CHECK(obj.m_Shapes.size() == 8);
+	Test::RemoveFile("TestObj_Generated.obj");
+}
+
+TEST(ObjParserFallsBack)
+{
+	// Pentagons need ear clipping, lines and forward references depend on more than one
+	// line, Parse leaves them all too tinyobj and Load still matches it
+	const char* files[] =
+	{
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0.5 1.5 0\nv 0 1 0\nf 1 2 3 4 5\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nl 1 2\nf 1 2 3\n",
+		"v 0 0 0\nf 1 2 3\nv 1 0 0\nv 1 1 0\nf 1 2 3\n",
+	};
+
+	for (const char* file : files)
+	{
+		std::string text = file;
+		REQUIRE(Test::WriteFile("TestObj_Fallback.obj", std::vector<u8>(text.begin(), text.end())));
+
+		ObjData obj;
+		CHECK(ObjParser::Parse(text.data(), text.size(), obj) == ObjResult::Unsupported);
+
+		ObjData reference;
+		ObjData loaded;
+		CHECK(ObjParser::LoadTinyObj("TestObj_Fallback.obj", reference));
+		CHECK(ObjParser::Load("TestObj_Fallback.obj", loaded));
+		CHECK(SameObj(reference, loaded));
+	}
+
+	// Index 0 is never valid, both fail
+	std::string bad = "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 0 1 2\n";
+	REQUIRE(Test::WriteFile("TestObj_Fallback.obj", std::vector<u8>(bad.begin(), bad.end())));
+	ObjData obj;
+	CHECK(ObjParser::Parse(bad.data(), bad.size(), obj) == ObjResult::Error);
+	CHECK(ObjParser::Load("TestObj_Fallback.obj", obj) == false);
+	CHECK(ObjParser::LoadTinyObj("TestObj_Fallback.obj", obj) == false);
+	Test::RemoveFile("TestObj_Fallback.obj");
+}
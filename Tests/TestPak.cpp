@@ -0,0 +1,646 @@
+#include "Test.h"
+#include "FileSystem/Pak/PakBuilder.h"
+#include "FileSystem/Pak/PakCodec.h"
+#include "FileSystem/Pak/PakLZ4.h"
+#include "FileSystem/Pak/PakFile.h"
+#include "FileSystem/Pak/PakFileSystem.h"
+#include "FileSystem/Pak/PakIOQueue.h"
+#include "System/Hash32.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <random>
+#include <thread>
+
+namespace
+{
+	u32 PathHash(const std::string& path)
+	{
+		return Hash32::ComputeHash((const Byte*)path.c_str(), (u32)path.length());
+	}
+
+	bool ReadWhole(PakArchive& archive, const std::string& path, std::vector<u8>& data)
+	{
+		const PakEntry* entry = archive.FindEntry(PathHash(path));
+		std::unique_ptr<PakFile> file = archive.GetFile(path);
+		if (entry == nullptr || file == nullptr)
+		{
+			return false;
+		}
+
+		data.resize(entry->m_UncompressedSize);
+		return data.empty() || file->Read(data.data(), (u32)data.size());
+	}
+
+	// Source files for the compressed pak tests, big enough for plenty of chunks
+	struct PakContent
+	{
+		std::vector<std::string>		m_Paths;
+		std::vector<std::vector<u8>>	m_Data;
+
+		void Add(const std::string& path, const std::vector<u8>& data)
+		{
+			m_Paths.push_back(path);
+			m_Data.push_back(data);
+		}
+
+		bool Build(const std::string& pakPath, PakCodec codec, int level = 0)
+		{
+			PakBuildSettings settings;
+			settings.m_Codec = codec;
+			settings.m_Level = level;
+			settings.m_ThreadCount = 2;
+
+			PakBuilder builder(settings);
+			for (size_t i = 0; i < m_Paths.size(); ++i)
+			{
+				std::string sourcePath = "TestPak_" + std::to_string(i) + ".bin";
+				if (Test::WriteFile(sourcePath, m_Data[i]) == false || builder.AddFile(sourcePath, m_Paths[i]) == false)
+				{
+					return false;
+				}
+			}
+
+			bool result = builder.Build(pakPath);
+			for (size_t i = 0; i < m_Paths.size(); ++i)
+			{
+				Test::RemoveFile("TestPak_" + std::to_string(i) + ".bin");
+			}
+			return result;
+		}
+	};
+
+	PakContent MakeContent(u32 seed)
+	{
+		PakContent content;
+		content.Add("Text\\Big.txt", Test::RandomText(PAK_CHUNK_SIZE * 9 + 1234, seed));
+		content.Add("Text\\Small.txt", Test::RandomText(700, seed + 1));
+		content.Add("Text\\OneChunk.txt", Test::RandomText(PAK_CHUNK_SIZE, seed + 2));
+		content.Add("Noise.bin", Test::RandomBytes(PAK_CHUNK_SIZE * 2 + 17, seed + 3));
+		content.Add("Empty.bin", {});
+		return content;
+	}
+
+	const PakCodec s_Codecs[] = { PakCodec::LZ4, PakCodec::Zstd };
+
+	// Holds a single I/O thread inside its completion callback until Release, so every request
+	// submitted after it is still queued
+	struct IOBlocker
+	{
+		std::promise<void>			m_Started;
+		std::promise<void>			m_Release;
+		std::shared_future<void>	m_Released = m_Release.get_future().share();
+
+		PakRequest Request(u32 hashID, Byte* destination)
+		{
+			PakRequest request;
+			request.m_HashID = hashID;
+			request.m_Destination = destination;
+			request.m_Priority = UINT32_MAX;
+			request.m_OnComplete = [this](const PakRequest&, bool) { m_Started.set_value(); m_Released.wait(); };
+			return request;
+		}
+
+		void WaitStarted() { m_Started.get_future().wait(); }
+		void Release() { m_Release.set_value(); }
+	};
+
+	struct AsyncFiles
+	{
+		PakContent					m_Content;
+		std::vector<std::vector<u8>> m_Buffers;
+		std::vector<u32>			m_Completed;	// Index order the callbacks ran in, one I/O thread
+		std::vector<u32>			m_Failed;
+
+		PakRequest Request(u32 index, u32 priority)
+		{
+			m_Buffers[index].assign(m_Content.m_Data[index].size(), 0);
+			PakRequest request;
+			request.m_HashID = PathHash(m_Content.m_Paths[index]);
+			request.m_Destination = m_Buffers[index].data();
+			request.m_Priority = priority;
+			request.m_OnComplete = [this, index](const PakRequest&, bool success) { (success ? m_Completed : m_Failed).push_back(index); };
+			return request;
+		}
+	};
+};
+
+TEST(PakCodecsSupported)
+{
+	CHECK(PakCompression::IsSupported(PakCodec::None));
+	CHECK(PakCompression::IsSupported(PakCodec::LZ4));
+	CHECK(PakCompression::IsSupported(PakCodec::Zstd));
+}
+
+TEST(PakCodecRoundTrip)
+{
+	const u32 sizes[] = { 0, 1, 12, 13, 100, 4096, PAK_CHUNK_SIZE, 300000 };
+	const int levels[] = { 0, 1, 9 };
+
+	for (PakCodec codec : s_Codecs)
+	{
+		for (u32 size : sizes)
+		{
+			for (int kind = 0; kind < 2; ++kind)
+			{
+				std::vector<u8> source = (kind == 0) ? Test::RandomText(size, size) : Test::RandomBytes(size, size);
+				for (int level : levels)
+				{
+					std::vector<u8> packed(PakCompression::CompressBound(codec, size));
+					u32 packedSize = PakCompression::Compress(codec, source.data(), size, packed.data(), (u32)packed.size(), level);
+					REQUIRE(packedSize > 0);
+					if (kind == 0 && size >= 4096)
+					{
+						CHECK(packedSize < size / 2);
+					}
+
+					std::vector<u8> decoded(size + 1);
+					CHECK(PakCompression::Decompress(codec, packed.data(), packedSize, decoded.data(), size));
+					CHECK(std::equal(source.begin(), source.end(), decoded.begin()));
+
+					// Wrong sizes and truncated blocks fail rather than handing back garbage
+					CHECK(PakCompression::Decompress(codec, packed.data(), packedSize, decoded.data(), size + 1) == false);
+					if (size > 0)
+					{
+						CHECK(PakCompression::Decompress(codec, packed.data(), packedSize - 1, decoded.data(), size) == false);
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(PakLZ4ReadsUpstreamBlocks)
+{
+	// LZ4_compress_default output from lz4 1.9.4
+	const char* text = "Pak files, pak files, pak files everywhere. Pak files, pak files, pak files everywhere!";
+	const u8 block[] =
+	{
+		0xCF, 0x50, 0x61, 0x6B, 0x20, 0x66, 0x69, 0x6C, 0x65, 0x73, 0x2C, 0x20, 0x70, 0x0B, 0x00, 0x00,
+		0xDF, 0x20, 0x65, 0x76, 0x65, 0x72, 0x79, 0x77, 0x68, 0x65, 0x72, 0x65, 0x2E, 0x20, 0x2C, 0x00,
+		0x13, 0x50, 0x68, 0x65, 0x72, 0x65, 0x21
+	};
+
+	u32 size = (u32)strlen(text);
+	std::vector<u8> decoded(size);
+	CHECK(PakLZ4::Decompress(block, sizeof(block), decoded.data(), size));
+	CHECK(memcmp(decoded.data(), text, size) == 0);
+
+	// Overlapping match, one literal then a 26 byte match one back, then the last 5 literals
+	const u8 run[] = { 0x1F, 'a', 0x01, 0x00, 0x07, 0x50, 'a', 'a', 'a', 'a', 'a' };
+	std::vector<u8> runDecoded(32);
+	CHECK(PakLZ4::Decompress(run, sizeof(run), runDecoded.data(), 32));
+	CHECK(std::vector<u8>(32, 'a') == runDecoded);
+
+	// Offset reaching before the start of the output
+	const u8 bad[] = { 0x1F, 'a', 0x02, 0x00, 0x07, 0x50, 'a', 'a', 'a', 'a', 'a' };
+	CHECK(PakLZ4::Decompress(bad, sizeof(bad), runDecoded.data(), 32) == false);
+}
+
+TEST(PakLZ4CorruptBlocks)
+{
+	std::vector<u8> source = Test::RandomText(20000, 7);
+	std::vector<u8> packed(PakLZ4::CompressBound((u32)source.size()));
+	u32 packedSize = PakLZ4::Compress(source.data(), (u32)source.size(), packed.data(), (u32)packed.size());
+	REQUIRE(packedSize > 0);
+	packed.resize(packedSize);
+
+	// Any damage has too fail or decode in bounds, asan/debug heap catch the rest
+	std::mt19937 random(3);
+	std::vector<u8> decoded(source.size());
+	for (u32 i = 0; i < 2000; ++i)
+	{
+		std::vector<u8> damaged = packed;
+		damaged[(size_t)(random() % damaged.size())] ^= (u8)(1 + random() % 255);
+		PakLZ4::Decompress(damaged.data(), (u32)damaged.size(), decoded.data(), (u32)decoded.size());
+	}
+
+	// Too small a destination fails the compress instead of overrunning it
+	CHECK(PakLZ4::Compress(source.data(), (u32)source.size(), packed.data(), packedSize - 1) == 0);
+}
+
+TEST(PakCompressedRead)
+{
+	PakContent content = MakeContent(11);
+	for (PakCodec codec : s_Codecs)
+	{
+		REQUIRE(content.Build("TestPak_Compressed.pak", codec, 0));
+		{
+			PakArchive archive("TestPak_Compressed.pak");
+			REQUIRE(archive.Mount());
+			CHECK(archive.Verify(2));
+
+			// Text shrinks so it stays compressed, noise doesnt so it gets stored
+			CHECK(archive.FindEntry(PathHash("Text\\Big.txt"))->m_Codec == codec);
+			CHECK(archive.FindEntry(PathHash("Noise.bin"))->m_Codec == PakCodec::None);
+
+			for (size_t i = 0; i < content.m_Paths.size(); ++i)
+			{
+				std::vector<u8> data;
+				CHECK(ReadWhole(archive, content.m_Paths[i], data));
+				CHECK(data == content.m_Data[i]);
+			}
+
+			// Small reads at random spots go through the chunk window
+			const std::vector<u8>& big = content.m_Data[0];
+			std::unique_ptr<PakFile> file = archive.GetFile("Text\\Big.txt");
+			REQUIRE(file != nullptr);
+
+			std::mt19937 random(5);
+			std::vector<u8> buffer;
+			for (u32 i = 0; i < 300; ++i)
+			{
+				u32 offset = random() % (u32)big.size();
+				u32 count = std::min((u32)(1 + random() % (PAK_CHUNK_SIZE * 2)), (u32)big.size() - offset);
+				buffer.assign(count, 0);
+				REQUIRE(file->ReadFrom(buffer.data(), offset, count));
+				CHECK(memcmp(buffer.data(), big.data() + offset, count) == 0);
+			}
+
+			// Streaming in odd sized pieces crosses every chunk boundary
+			file->SeekStart();
+			std::vector<u8> streamed;
+			while (streamed.size() < big.size())
+			{
+				u32 count = std::min(777u, (u32)(big.size() - streamed.size()));
+				buffer.assign(count, 0);
+				REQUIRE(file->Read(buffer.data(), count));
+				streamed.insert(streamed.end(), buffer.begin(), buffer.end());
+			}
+			CHECK(streamed == big);
+
+			// Whole reads split across the decode pool
+			archive.SetDecodeThreads(4);
+			std::vector<u8> data;
+			CHECK(ReadWhole(archive, "Text\\Big.txt", data));
+			CHECK(data == big);
+
+			std::shared_ptr<const std::vector<u8>> shared = archive.ReadShared(PathHash("Text\\OneChunk.txt"));
+			CHECK(shared != nullptr && *shared == content.m_Data[2]);
+		}
+		Test::RemoveFile("TestPak_Compressed.pak");
+	}
+}
+
+TEST(PakDeduplicates)
+{
+	std::vector<u8> shared = Test::RandomText(PAK_CHUNK_SIZE * 2 + 300, 51);
+	std::vector<u8> other = shared;
+	other[PAK_CHUNK_SIZE] ^= 0xFF;
+
+	const PakCodec codecs[] = { PakCodec::None, PakCodec::LZ4 };
+	for (PakCodec codec : codecs)
+	{
+		PakBuildSettings settings;
+		settings.m_Codec = codec;
+		PakBuilder builder(settings);
+
+		// Same size but different bytes must still get its own blob
+		REQUIRE(Test::WriteFile("TestPak_DupA.bin", shared) && Test::WriteFile("TestPak_DupB.bin", shared) && Test::WriteFile("TestPak_DupC.bin", other));
+		REQUIRE(builder.AddFile("TestPak_DupA.bin", "Dup\\A.txt"));
+		REQUIRE(builder.AddFile("TestPak_DupB.bin", "Dup\\B.txt"));
+		REQUIRE(builder.AddFile("TestPak_DupC.bin", "Dup\\C.txt"));
+		REQUIRE(builder.Build("TestPak_Dedup.pak"));
+		CHECK(builder.DuplicateCount() == 1);
+		CHECK(builder.SavedBytes() > 0);
+		{
+			PakArchive archive("TestPak_Dedup.pak");
+			REQUIRE(archive.Mount());
+			CHECK(archive.Verify());
+
+			const PakEntry* a = archive.FindEntry(PathHash("Dup\\A.txt"));
+			const PakEntry* b = archive.FindEntry(PathHash("Dup\\B.txt"));
+			const PakEntry* c = archive.FindEntry(PathHash("Dup\\C.txt"));
+			REQUIRE(a != nullptr && b != nullptr && c != nullptr);
+			CHECK(a->m_Offset == b->m_Offset);
+			CHECK(a->m_Offset != c->m_Offset);
+			CHECK(builder.SavedBytes() == a->m_CompressedSize);
+
+			std::vector<u8> data;
+			CHECK(ReadWhole(archive, "Dup\\A.txt", data) && data == shared);
+			CHECK(ReadWhole(archive, "Dup\\B.txt", data) && data == shared);
+			CHECK(ReadWhole(archive, "Dup\\C.txt", data) && data == other);
+
+			// One decoded copy for both paths while it's held
+			std::shared_ptr<const std::vector<u8>> first = archive.ReadShared(a->m_HashID);
+			std::shared_ptr<const std::vector<u8>> second = archive.ReadShared(b->m_HashID);
+			REQUIRE(first != nullptr);
+			CHECK(first == second);
+			CHECK(*first == shared);
+		}
+		Test::RemoveFile("TestPak_DupA.bin");
+		Test::RemoveFile("TestPak_DupB.bin");
+		Test::RemoveFile("TestPak_DupC.bin");
+		Test::RemoveFile("TestPak_Dedup.pak");
+	}
+}
+
+TEST(PakSpans)
+{
+	PakContent content = MakeContent(61);
+	REQUIRE(content.Build("TestPak_Spans.pak", PakCodec::LZ4));
+
+	const std::vector<u8>& noise = content.m_Data[3];
+	const std::vector<u8>& big = content.m_Data[0];
+	for (int mapped = 0; mapped < 2; ++mapped)
+	{
+		PakArchive archive("TestPak_Spans.pak", mapped == 1);
+		REQUIRE(archive.Mount());
+		REQUIRE(archive.FindEntry(PathHash("Noise.bin"))->m_Codec == PakCodec::None);
+		REQUIRE(archive.FindEntry(PathHash("Text\\Big.txt"))->m_Codec == PakCodec::LZ4);
+
+		// Stored entries point straight into the mapping, only when there is one
+		PakSpan span = archive.GetSpan(PathHash("Noise.bin"));
+		if (archive.IsMapped())
+		{
+			REQUIRE(span.IsValid());
+			CHECK(span.m_Size == noise.size() && std::equal(span.begin(), span.end(), noise.begin()));
+		}
+		else
+		{
+			CHECK(span.IsValid() == false && span.m_Size == 0);
+		}
+
+		std::vector<u8> storage;
+		span = archive.GetSpan(PathHash("Noise.bin"), storage);
+		REQUIRE(span.IsValid());
+		CHECK(span.m_Size == noise.size() && std::equal(span.begin(), span.end(), noise.begin()));
+		CHECK((span.m_Data == storage.data()) == (archive.IsMapped() == false));
+
+		// Compressed entries never have one, the overload reads them into storage
+		CHECK(archive.GetSpan(PathHash("Text\\Big.txt")).IsValid() == false);
+		span = archive.GetSpan(PathHash("Text\\Big.txt"), storage);
+		REQUIRE(span.IsValid());
+		CHECK(span.m_Data == storage.data());
+		CHECK(span.m_Size == big.size() && std::equal(span.begin(), span.end(), big.begin()));
+
+		u32 missing = PathHash("Missing.bin");
+		REQUIRE(archive.FindEntry(missing) == nullptr);
+		span = archive.GetSpan(missing);
+		CHECK(span.IsValid() == false && span.m_Size == 0);
+		span = archive.GetSpan(missing, storage);
+		CHECK(span.IsValid() == false && span.m_Size == 0);
+	}
+
+	Test::RemoveFile("TestPak_Spans.pak");
+}
+
+TEST(PakCompressedPatch)
+{
+	for (PakCodec codec : s_Codecs)
+	{
+		PakContent base = MakeContent(21);
+		REQUIRE(base.Build("TestPak_Base.pak", codec));
+
+		// Change a few bytes in the middle of the big file, drop one, add one
+		PakContent next = base;
+		next.m_Data[0][PAK_CHUNK_SIZE * 4 + 100] ^= 0xFF;
+		next.m_Data[0].insert(next.m_Data[0].end(), 5000, 'x');
+		next.m_Paths.erase(next.m_Paths.begin() + 1);
+		next.m_Data.erase(next.m_Data.begin() + 1);
+		next.Add("Text\\Added.txt", Test::RandomText(PAK_CHUNK_SIZE * 3, 99));
+		REQUIRE(next.Build("TestPak_Next.pak", codec));
+
+		PakPatchStats stats;
+		REQUIRE(PakBuilder::BuildPatch("TestPak_Base.pak", "TestPak_Next.pak", "TestPak_Patch.pak", &stats));
+		CHECK(stats.m_Changed == 1);
+		CHECK(stats.m_Added == 1);
+		CHECK(stats.m_ReusedChunks >= 8);
+		CHECK(stats.m_PatchBytes < stats.m_FullBytes / 2);
+		{
+			PakArchive baseArchive("TestPak_Base.pak");
+			PakArchive patch("TestPak_Patch.pak");
+			REQUIRE(baseArchive.Mount());
+			patch.SetBase(&baseArchive);
+			patch.SetLazyVerify(true);
+			REQUIRE(patch.Mount());
+
+			CHECK(patch.HasFile("Text\\Small.txt") == false);
+			for (size_t i = 0; i < next.m_Paths.size(); ++i)
+			{
+				std::vector<u8> data;
+				CHECK(ReadWhole(patch, next.m_Paths[i], data));
+				CHECK(data == next.m_Data[i]);
+			}
+
+			// Partial reads of a delta entry mix base and patch chunks
+			std::unique_ptr<PakFile> file = patch.GetFile("Text\\Big.txt");
+			REQUIRE(file != nullptr);
+			std::vector<u8> buffer(PAK_CHUNK_SIZE * 2);
+			u32 offset = PAK_CHUNK_SIZE * 3 + 500;
+			REQUIRE(file->ReadFrom(buffer.data(), offset, (u32)buffer.size()));
+			CHECK(memcmp(buffer.data(), next.m_Data[0].data() + offset, buffer.size()) == 0);
+		}
+		Test::RemoveFile("TestPak_Base.pak");
+		Test::RemoveFile("TestPak_Next.pak");
+		Test::RemoveFile("TestPak_Patch.pak");
+	}
+}
+
+TEST(PakUnmountReleasesFiles)
+{
+	PakContent content = MakeContent(31);
+	REQUIRE(content.Build("TestPak_Handles.pak", PakCodec::LZ4));
+
+	for (int mapped = 0; mapped < 2; ++mapped)
+	{
+		u32 before = Test::OpenHandleCount();
+		{
+			PakFileSystem fileSystem;
+			REQUIRE(fileSystem.Mount("TestPak_Handles.pak", 0, mapped == 1));
+			CHECK(Test::OpenHandleCount() > before);
+
+			std::vector<u8> data;
+			CHECK(fileSystem.ReadFile("Text\\Big.txt", data));
+			CHECK(data == content.m_Data[0]);
+
+			// Async reads start the I/O threads, they have too let go too
+			PakArchive* archive = fileSystem.FindArchive(PathHash("Text\\Small.txt"));
+			REQUIRE(archive != nullptr);
+			std::vector<u8> small(content.m_Data[1].size());
+			PakRequest request;
+			request.m_HashID = PathHash("Text\\Small.txt");
+			request.m_Destination = small.data();
+			CHECK(archive->ReadAsync({ request })->Wait());
+			CHECK(small == content.m_Data[1]);
+
+			u32 mountedCount = Test::OpenHandleCount();
+			CHECK(fileSystem.Remount("TestPak_Handles.pak"));
+			CHECK(Test::OpenHandleCount() <= mountedCount);
+
+			CHECK(fileSystem.Unmount("TestPak_Handles.pak"));
+			CHECK(Test::OpenHandleCount() == before);
+		}
+		CHECK(Test::OpenHandleCount() == before);
+	}
+
+	Test::RemoveFile("TestPak_Handles.pak");
+}
+
+TEST(PakFileSystemMountsPatches)
+{
+	PakContent base = MakeContent(41);
+	PakContent next = base;
+	next.m_Data[0][100] ^= 0xFF;
+	next.m_Paths.erase(next.m_Paths.begin() + 3);
+	next.m_Data.erase(next.m_Data.begin() + 3);
+	REQUIRE(base.Build("TestPak_FsBase.pak", PakCodec::LZ4));
+	REQUIRE(next.Build("TestPak_FsNext.pak", PakCodec::LZ4));
+	REQUIRE(PakBuilder::BuildPatch("TestPak_FsBase.pak", "TestPak_FsNext.pak", "TestPak_FsPatch.pak"));
+	{
+		PakFileSystem fileSystem;
+		std::vector<u8> data;
+
+		// No base mounted yet
+		CHECK(fileSystem.Mount("TestPak_FsPatch.pak") == false);
+		CHECK(fileSystem.Mount("TestPak_FsPatch.pak", "TestPak_FsBase.pak") == false);
+
+		REQUIRE(fileSystem.Mount("TestPak_FsBase.pak"));
+		REQUIRE(fileSystem.Mount("TestPak_FsPatch.pak", 1));
+		CHECK(fileSystem.ReadFile("Text\\Big.txt", data) && data == next.m_Data[0]);
+		CHECK(fileSystem.ReadFile("Text\\Small.txt", data) && data == next.m_Data[1]);
+
+		// Dropped from the new version, the base copy mustnt show through
+		CHECK(fileSystem.HasFile("Noise.bin") == false);
+		CHECK(fileSystem.ReadFile("Noise.bin", data) == false);
+		CHECK(fileSystem.FileCount() == (u32)next.m_Paths.size());
+
+		// The base has too outlive the patch on top of it
+		CHECK(fileSystem.Unmount("TestPak_FsBase.pak") == false);
+		CHECK(fileSystem.Remount("TestPak_FsBase.pak") == false);
+		CHECK(fileSystem.Remount("TestPak_FsPatch.pak"));
+		CHECK(fileSystem.ReadFile("Text\\Big.txt", data) && data == next.m_Data[0]);
+		CHECK(fileSystem.ReadFile("Noise.bin", data) == false);
+
+		CHECK(fileSystem.Unmount("TestPak_FsPatch.pak"));
+		CHECK(fileSystem.ReadFile("Text\\Big.txt", data) && data == base.m_Data[0]);
+		CHECK(fileSystem.ReadFile("Noise.bin", data) && data == base.m_Data[3]);
+		CHECK(fileSystem.FileCount() == (u32)base.m_Paths.size());
+
+		// Named base, a plain archive cant stand in for it
+		CHECK(fileSystem.Mount("TestPak_FsNext.pak"));
+		CHECK(fileSystem.Mount("TestPak_FsPatch.pak", "TestPak_FsNext.pak", 1) == false);
+		CHECK(fileSystem.Mount("TestPak_FsPatch.pak", "TestPak_FsBase.pak", 1));
+		CHECK(fileSystem.ReadFile("Text\\Big.txt", data) && data == next.m_Data[0]);
+		CHECK(fileSystem.ReadFile("Noise.bin", data) == false);
+		CHECK(fileSystem.Unmount("TestPak_FsPatch.pak"));
+		CHECK(fileSystem.Unmount("TestPak_FsBase.pak"));
+	}
+	Test::RemoveFile("TestPak_FsBase.pak");
+	Test::RemoveFile("TestPak_FsNext.pak");
+	Test::RemoveFile("TestPak_FsPatch.pak");
+}
+
+TEST(PakAsyncQueue)
+{
+	AsyncFiles files;
+	for (u32 i = 0; i < 12; ++i)
+	{
+		files.m_Content.Add("Async\\File" + std::to_string(i) + ".txt", Test::RandomText(1000 + i * 100, 50 + i));
+	}
+	files.m_Buffers.resize(files.m_Content.m_Paths.size());
+	REQUIRE(files.m_Content.Build("TestPak_Async.pak", PakCodec::None));
+	{
+		PakArchive archive("TestPak_Async.pak");
+		REQUIRE(archive.Mount());
+		archive.StartAsync(1);
+		std::vector<u8> blocked(files.m_Content.m_Data[0].size());
+
+		// Highest priority first, then archive order
+		{
+			IOBlocker blocker;
+			archive.ReadAsync({ blocker.Request(PathHash(files.m_Content.m_Paths[0]), blocked.data()) });
+			blocker.WaitStarted();
+
+			std::vector<PakRequest> requests;
+			std::vector<u32> expected;
+			for (u32 i = 1; i < 12; ++i)
+			{
+				requests.push_back(files.Request(i, i % 3));
+				expected.push_back(i);
+			}
+			std::shared_ptr<PakBatch> batch = archive.ReadAsync(requests);
+			CHECK(batch->IsComplete() == false);
+			blocker.Release();
+			CHECK(batch->Wait());
+			CHECK(batch->FailedCount() == 0);
+
+			std::sort(expected.begin(), expected.end(), [&](u32 a, u32 b)
+			{
+				if (a % 3 != b % 3)
+				{
+					return a % 3 > b % 3;
+				}
+				return archive.FindEntry(PathHash(files.m_Content.m_Paths[a]))->m_Offset < archive.FindEntry(PathHash(files.m_Content.m_Paths[b]))->m_Offset;
+			});
+			CHECK(files.m_Completed == expected);
+			for (u32 i = 1; i < 12; ++i)
+			{
+				CHECK(files.m_Buffers[i] == files.m_Content.m_Data[i]);
+			}
+		}
+
+		// Cancelling drops the queued low priority requests and fails them, the rest still run
+		{
+			files.m_Completed.clear();
+			IOBlocker blocker;
+			archive.ReadAsync({ blocker.Request(PathHash(files.m_Content.m_Paths[0]), blocked.data()) });
+			blocker.WaitStarted();
+
+			std::vector<PakRequest> requests;
+			for (u32 i = 1; i < 12; ++i)
+			{
+				requests.push_back(files.Request(i, i % 3));
+			}
+			std::shared_ptr<PakBatch> batch = archive.ReadAsync(requests);
+			CHECK(archive.CancelAsync(2) == 7);
+			CHECK(files.m_Failed.size() == 7);
+			blocker.Release();
+
+			CHECK(batch->Wait() == false);
+			CHECK(batch->FailedCount() == 7);
+			CHECK(files.m_Completed.size() == 4);
+			for (u32 i : files.m_Completed)
+			{
+				CHECK(i % 3 == 2);
+				CHECK(files.m_Buffers[i] == files.m_Content.m_Data[i]);
+			}
+			for (u32 i : files.m_Failed)
+			{
+				CHECK(i % 3 != 2);
+			}
+		}
+
+		// Shutting down with work queued fails all of it, even at the highest priority
+		{
+			files.m_Completed.clear();
+			files.m_Failed.clear();
+			std::shared_ptr<PakBatch> batch;
+			{
+				PakIOQueue queue(&archive, 1);
+				IOBlocker blocker;
+				queue.Submit({ blocker.Request(PathHash(files.m_Content.m_Paths[0]), blocked.data()) });
+				blocker.WaitStarted();
+
+				batch = queue.Submit({ files.Request(1, UINT32_MAX), files.Request(2, 0), files.Request(3, UINT32_MAX) });
+				std::thread stopper([&queue]() { queue.Shutdown(); });
+				// Let Shutdown stop the thread before it can pick up the next job
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				blocker.Release();
+				stopper.join();
+
+				// Too late for anything new
+				std::shared_ptr<PakBatch> late = queue.Submit({ files.Request(4, UINT32_MAX) });
+				CHECK(late->IsComplete() && late->Wait() == false);
+			}
+
+			CHECK(batch->IsComplete());
+			CHECK(batch->Future().wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+			CHECK(batch->FailedCount() == 3);
+			CHECK(files.m_Completed.empty());
+			CHECK(files.m_Failed.size() == 4);
+		}
+	}
+	Test::RemoveFile("TestPak_Async.pak");
+}
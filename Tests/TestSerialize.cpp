@@ -0,0 +1,337 @@
+#include "Test.h"
+#include "FileSystem/Serialize.h"
+#include "FileSystem/Endian.h"
+#include "Resource/MeshCooker.h"
+#include "Resource/TextureCooker.h"
+#include <cstring>
+#include <random>
+
+namespace
+{
+	CookedMesh RandomMesh(u32 vertexCount, u32 seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+
+		CookedMesh mesh;
+		mesh.m_Vertices.resize(vertexCount);
+		for (VertexMesh& vertex : mesh.m_Vertices)
+		{
+			vertex.m_Position = Vector3(value(random), value(random), value(random));
+			vertex.m_Normal = Vector3(value(random), value(random), value(random));
+			vertex.m_Tangent = Vector4(value(random), value(random), value(random), 1.0f);
+			vertex.m_Color = Color(value(random), value(random), value(random), value(random));
+			vertex.m_Texture = Vector2(value(random), value(random));
+		}
+
+		mesh.m_Indices.resize((u64)vertexCount * 3);
+		for (u32& index : mesh.m_Indices)
+		{
+			index = random() % vertexCount;
+		}
+
+		u64 split = mesh.m_Indices.size() / 3;
+		mesh.m_Parts.emplace_back(0, split);
+		mesh.m_Parts.emplace_back(split, mesh.m_Indices.size() - split);
+		mesh.RecalculateBounds();
+		return mesh;
+	}
+
+	bool SameParts(const std::vector<MeshPart>& a, const std::vector<MeshPart>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+
+		for (u64 i = 0; i < a.size(); ++i)
+		{
+			if (a[i].m_Start != b[i].m_Start || a[i].m_Count != b[i].m_Count)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Bytewise, a round trip has too be exact not just within Mathf::IsEqual
+	bool SameMesh(const CookedMesh& a, const CookedMesh& b)
+	{
+		return a.m_Vertices.size() == b.m_Vertices.size() &&
+			(a.m_Vertices.empty() || std::memcmp(a.m_Vertices.data(), b.m_Vertices.data(), a.m_Vertices.size() * sizeof(VertexMesh)) == 0) &&
+			a.m_Indices == b.m_Indices && SameParts(a.m_Parts, b.m_Parts) &&
+			a.m_BoundsMin == b.m_BoundsMin && a.m_BoundsMax == b.m_BoundsMax;
+	}
+
+	// What a big endian build would have written for mesh, every word flipped in place
+	std::vector<u8> SwapMeshFile(std::vector<u8> data, const CookedMesh& mesh)
+	{
+		// magic, version, strides, bounds and the part count are all 4 byte words
+		u64 headerBytes = 10 * sizeof(u32) + sizeof(u32);
+		u64 partBytes = mesh.m_Parts.size() * sizeof(MeshPart);
+		SwapEndian(data.data(), headerBytes / 4, 4);
+		SwapEndian(data.data() + headerBytes, partBytes / 8, 8);
+		SwapEndian(data.data() + headerBytes + partBytes, (data.size() - headerBytes - partBytes) / 4, 4);
+		return data;
+	}
+
+	template<typename T>
+	void Put(std::vector<u8>& data, T value)
+	{
+		const u8* bytes = (const u8*)&value;
+		data.insert(data.end(), bytes, bytes + sizeof(T));
+	}
+
+	// Stand in for an asset that grew a field in version 2, the per field path
+	struct Material
+	{
+		std::string					m_Name;
+		std::vector<std::string>	m_Textures;
+		Vector3						m_Tint;
+		float						m_Roughness = 0.5f;	// Version 2
+	};
+
+	u32 s_MaterialVersion = 2;
+
+	bool Serialize(Archive& archive, Material& material)
+	{
+		if (SerializeHeader(archive, 0x4C54414D, s_MaterialVersion) == false ||
+			Serialize(archive, material.m_Name) == false ||
+			Serialize(archive, material.m_Textures) == false ||
+			Serialize(archive, material.m_Tint) == false)
+		{
+			return false;
+		}
+
+		if (archive.Version() >= 2)
+		{
+			return Serialize(archive, material.m_Roughness);
+		}
+		return true;
+	}
+};
+
+TEST(SerializeCookedMesh)
+{
+	CookedMesh mesh = RandomMesh(5000, 1);
+
+	std::vector<u8> data;
+	MemoryArchive save(data);
+	REQUIRE(Serialize(save, mesh));
+
+	// Copy path, every array goes through as one block
+	CookedMesh loaded;
+	MemoryArchive load(data.data(), data.size());
+	REQUIRE(Serialize(load, loaded));
+	CHECK(load.Remaining() == 0);
+	CHECK(SameMesh(mesh, loaded));
+
+	// View path points straight into the same bytes
+	MeshView view;
+	REQUIRE(view.Open(data.data(), data.size()));
+	CHECK(view.m_VertexCount == mesh.m_Vertices.size());
+	CHECK(view.m_IndexCount == mesh.m_Indices.size());
+	CHECK(std::memcmp(view.m_Vertices, mesh.m_Vertices.data(), mesh.m_Vertices.size() * sizeof(VertexMesh)) == 0);
+	CHECK(std::memcmp(view.m_Indices, mesh.m_Indices.data(), mesh.m_Indices.size() * sizeof(u32)) == 0);
+	CHECK(SameParts(view.m_Parts, mesh.m_Parts));
+	CHECK(view.m_BoundsMin == mesh.m_BoundsMin && view.m_BoundsMax == mesh.m_BoundsMax);
+
+	// Through a file like PakBuilder -cookmesh writes it
+	REQUIRE(MeshCooker::Save("TestSerialize_Mesh.mesh", mesh));
+	std::vector<u8> file;
+	CHECK(Test::ReadFile("TestSerialize_Mesh.mesh", file));
+	CHECK(file == data);
+	Test::RemoveFile("TestSerialize_Mesh.mesh");
+
+	// Empty mesh still round trips
+	CookedMesh empty;
+	std::vector<u8> emptyData;
+	MemoryArchive saveEmpty(emptyData);
+	REQUIRE(Serialize(saveEmpty, empty));
+	CookedMesh loadedEmpty = mesh;
+	MemoryArchive loadEmpty(emptyData.data(), emptyData.size());
+	CHECK(Serialize(loadEmpty, loadedEmpty));
+	CHECK(SameMesh(empty, loadedEmpty));
+}
+
+TEST(SerializeSwappedMesh)
+{
+	CookedMesh mesh = RandomMesh(1000, 2);
+
+	std::vector<u8> data;
+	MemoryArchive save(data);
+	REQUIRE(Serialize(save, mesh));
+	std::vector<u8> swapped = SwapMeshFile(data, mesh);
+
+	// The copy path flips it back, the view path cant and refuses it
+	CookedMesh loaded;
+	MemoryArchive load(swapped.data(), swapped.size());
+	REQUIRE(Serialize(load, loaded));
+	CHECK(load.IsSwapped());
+	CHECK(SameMesh(mesh, loaded));
+
+	MeshView view;
+	CHECK(view.Open(swapped.data(), swapped.size()) == false);
+}
+
+TEST(SerializeOldMeshVersions)
+{
+	CookedMesh mesh = RandomMesh(100, 3);
+	std::vector<u8> data;
+	MemoryArchive save(data);
+	REQUIRE(Serialize(save, mesh));
+
+	// Version 1 was Mesh's separate streams, newer than this build cant be known, both refused
+	u32 versions[] = { 1, MESH_VERSION + 1, 0 };
+	for (u32 version : versions)
+	{
+		std::vector<u8> old = data;
+		std::memcpy(old.data() + sizeof(u32), &version, sizeof(u32));
+
+		CookedMesh loaded;
+		MemoryArchive load(old.data(), old.size());
+		CHECK(Serialize(load, loaded) == false);
+		CHECK(load.Failed());
+
+		MeshView view;
+		CHECK(view.Open(old.data(), old.size()) == false);
+	}
+
+	// A vertex stride that doesnt match VertexMesh anymore
+	std::vector<u8> stride = data;
+	stride[2 * sizeof(u32)] += 4;
+	CookedMesh loaded;
+	MemoryArchive loadStride(stride.data(), stride.size());
+	CHECK(Serialize(loadStride, loaded) == false);
+
+	// Truncated anywhere fails rather than reading past the end
+	for (u64 size = 0; size < data.size(); size += 97)
+	{
+		CookedMesh truncated;
+		MemoryArchive load(data.data(), size);
+		CHECK(Serialize(load, truncated) == false);
+
+		MeshView view;
+		CHECK(view.Open(data.data(), size) == false);
+	}
+
+	// Parts past the end of the index buffer
+	CookedMesh bad = mesh;
+	bad.m_Parts.emplace_back(mesh.m_Indices.size() - 3, 6);
+	std::vector<u8> badData;
+	MemoryArchive saveBad(badData);
+	REQUIRE(Serialize(saveBad, bad));
+	MemoryArchive loadBad(badData.data(), badData.size());
+	CHECK(Serialize(loadBad, loaded) == false);
+	MeshView view;
+	CHECK(view.Open(badData.data(), badData.size()) == false);
+}
+
+TEST(SerializeCookedTexture)
+{
+	CookedTexture texture;
+	texture.m_Desc.Dimension = ResourceDimension::Texture2D;
+	texture.m_Desc.Width = 64;
+	texture.m_Desc.Height = 32;
+	texture.m_Desc.DepthOrArraySize = 1;
+	texture.m_Desc.MipCount = 7;
+	texture.m_Desc.Format = SurfaceFormat::R8G8B8A8_Unorm;
+	texture.m_Desc.Flags = 8;
+	texture.m_Desc.Stride = 256;
+	texture.m_Data = Test::RandomBytes(10920, 4);
+
+	std::vector<u8> data;
+	MemoryArchive save(data);
+	REQUIRE(Serialize(save, texture));
+
+	// Pinned version 1 layout, a texture cooked by an older build has too keep loading
+	std::vector<u8> expected;
+	Put(expected, (u32)TEXTURE_MAGIC);
+	Put(expected, (u32)1);
+	Put(expected, ResourceDimension::Texture2D);
+	Put(expected, (u64)64);
+	Put(expected, (u32)32);
+	Put(expected, (u16)1);
+	Put(expected, (u16)7);
+	Put(expected, SurfaceFormat::R8G8B8A8_Unorm);
+	Put(expected, (u32)8);
+	Put(expected, (u32)256);
+	Put(expected, (u32)texture.m_Data.size());
+	expected.insert(expected.end(), texture.m_Data.begin(), texture.m_Data.end());
+	CHECK(data == expected);
+
+	CookedTexture loaded;
+	MemoryArchive load(expected.data(), expected.size());
+	REQUIRE(Serialize(load, loaded));
+	CHECK(load.Remaining() == 0);
+	CHECK(loaded.m_Desc.Dimension == texture.m_Desc.Dimension);
+	CHECK(loaded.m_Desc.Width == texture.m_Desc.Width);
+	CHECK(loaded.m_Desc.Height == texture.m_Desc.Height);
+	CHECK(loaded.m_Desc.DepthOrArraySize == texture.m_Desc.DepthOrArraySize);
+	CHECK(loaded.m_Desc.MipCount == texture.m_Desc.MipCount);
+	CHECK(loaded.m_Desc.Format == texture.m_Desc.Format);
+	CHECK(loaded.m_Desc.Flags == texture.m_Desc.Flags);
+	CHECK(loaded.m_Desc.Stride == texture.m_Desc.Stride);
+	CHECK(loaded.m_Data == texture.m_Data);
+
+	// Newer than this build
+	std::vector<u8> newer = expected;
+	u32 version = TEXTURE_VERSION + 1;
+	std::memcpy(newer.data() + sizeof(u32), &version, sizeof(u32));
+	MemoryArchive loadNewer(newer.data(), newer.size());
+	CHECK(Serialize(loadNewer, loaded) == false);
+
+	// A byte count bigger than the file fails before allocating it
+	std::vector<u8> truncated(expected.begin(), expected.end() - 1);
+	MemoryArchive loadTruncated(truncated.data(), truncated.size());
+	ResourceDesc desc;
+	u32 byteCount = 0;
+	CHECK(SerializeTextureHeader(loadTruncated, desc, byteCount) == false);
+}
+
+TEST(SerializeVersionedFields)
+{
+	Material material;
+	material.m_Name = "MaterialBall";
+	material.m_Textures = { "Albedo.png", "", "Normal.png" };
+	material.m_Tint = Vector3(0.25f, 0.5f, 1.0f);
+	material.m_Roughness = 0.9f;
+
+	// Written by the build before Roughness existed
+	s_MaterialVersion = 1;
+	std::vector<u8> old;
+	MemoryArchive saveOld(old);
+	bool saved = Serialize(saveOld, material);
+	s_MaterialVersion = 2;
+	REQUIRE(saved);
+
+	Material loaded;
+	MemoryArchive loadOld(old.data(), old.size());
+	REQUIRE(Serialize(loadOld, loaded));
+	CHECK(loadOld.Version() == 1);
+	CHECK(loadOld.Remaining() == 0);
+	CHECK(loaded.m_Name == material.m_Name);
+	CHECK(loaded.m_Textures == material.m_Textures);
+	CHECK(loaded.m_Tint == material.m_Tint);
+	CHECK(loaded.m_Roughness == 0.5f);
+
+	// Current version carries the new field
+	std::vector<u8> data;
+	MemoryArchive save(data);
+	REQUIRE(Serialize(save, material));
+	CHECK(data.size() == old.size() + sizeof(float));
+
+	Material current;
+	MemoryArchive load(data.data(), data.size());
+	REQUIRE(Serialize(load, current));
+	CHECK(load.Version() == 2);
+	CHECK(current.m_Textures == material.m_Textures);
+	CHECK(current.m_Roughness == material.m_Roughness);
+
+	// A string length running past the end fails instead of allocating it
+	std::vector<u8> bad = data;
+	u32 length = 0x7FFFFFFF;
+	std::memcpy(bad.data() + 2 * sizeof(u32), &length, sizeof(u32));
+	MemoryArchive loadBad(bad.data(), bad.size());
+	CHECK(Serialize(loadBad, current) == false);
+}
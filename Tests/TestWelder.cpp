@@ -0,0 +1,159 @@
+#include "Test.h"
+#include "Resource/VertexWelder.h"
+#include <cstring>
+#include <map>
+#include <random>
+
+namespace
+{
+	struct TestVertex
+	{
+		float m_Position[3];
+		float m_Normal[3];
+		float m_Texture[2];
+	};
+
+	// Every vertex lands on the same hash, every probe has too fall back too the bytes
+	u64 ConstantHash(const Byte*, u32)
+	{
+		return 42;
+	}
+
+	// A handful of buckets, long probe runs with plenty of equal hashes in them
+	u64 ByteHash(const Byte* key, u32 size)
+	{
+		return key[size - 1] & 7;
+	}
+
+	// Corners of a grid in face order, each vertex shows up about six times like an import
+	std::vector<TestVertex> GridCorners(u32 quads, u32 seed)
+	{
+		std::mt19937 random(seed);
+		u32 side = quads + 1;
+		std::vector<TestVertex> vertices(side * side);
+		for (u32 i = 0; i < vertices.size(); ++i)
+		{
+			TestVertex& vertex = vertices[i];
+			vertex = { { (float)(i % side), (float)(random() % 4), (float)(i / side) }, { 0, 1, 0 }, { (float)(i % side) / quads, (float)(i / side) / quads } };
+		}
+
+		std::vector<TestVertex> corners;
+		for (u32 y = 0; y < quads; ++y)
+		{
+			for (u32 x = 0; x < quads; ++x)
+			{
+				u32 a = y * side + x;
+				u32 quad[6] = { a, a + side, a + 1, a + 1, a + side, a + side + 1 };
+				for (u32 index : quad)
+				{
+					corners.push_back(vertices[index]);
+				}
+			}
+		}
+		return corners;
+	}
+
+	// Welds corners and checks it against a map of the raw bytes: same vertex count, first
+	// seen order, and every corner's index points at a vertex byte for byte equal too it
+	void CheckExactWeld(const std::vector<TestVertex>& corners, VertexWelder::HashFunction hash)
+	{
+		VertexWelder welder(sizeof(TestVertex));
+		welder.SetHashFunction(hash);
+
+		std::map<std::string, u32> reference;
+		for (const TestVertex& corner : corners)
+		{
+			std::string bytes((const char*)&corner, sizeof(TestVertex));
+			u32 expected = (u32)reference.emplace(bytes, (u32)reference.size()).first->second;
+
+			u32 index = welder.Add(&corner);
+			REQUIRE(index == expected);
+			REQUIRE(std::memcmp(welder.Vertices() + (size_t)index * sizeof(TestVertex), &corner, sizeof(TestVertex)) == 0);
+		}
+		CHECK(welder.Count() == reference.size());
+	}
+};
+
+TEST(VertexWelderCollisions)
+{
+	// Small enough that the constant hash's probe runs stay cheap, big enough too grow the
+	// table from its 16 slots several times
+	std::vector<TestVertex> small = GridCorners(12, 1);
+	CheckExactWeld(small, &ConstantHash);
+	CheckExactWeld(small, &ByteHash);
+
+	// Real hash on something import sized
+	CheckExactWeld(GridCorners(300, 2), nullptr);
+
+	// Clear keeps the hash and empties the table
+	VertexWelder welder(sizeof(TestVertex));
+	welder.SetHashFunction(&ConstantHash);
+	CHECK(welder.Add(&small[0]) == 0);
+	CHECK(welder.Add(&small[1]) == 1);
+	welder.Clear();
+	CHECK(welder.Count() == 0);
+	CHECK(welder.Add(&small[1]) == 0);
+	CHECK(welder.Add(&small[0]) == 1);
+	CHECK(welder.Add(&small[1]) == 0);
+}
+
+TEST(VertexWelderEpsilon)
+{
+	for (VertexWelder::HashFunction hash : { (VertexWelder::HashFunction)nullptr, &ConstantHash })
+	{
+		TestVertex a = { { 1.0f, 2.0f, 3.0f }, { 0.0f, 1.0f, 0.0f }, { 0.25f, 0.5f } };
+		TestVertex nearA = { { 1.00001f, 1.99999f, 3.00002f }, { -0.0f, 1.0f, 0.00001f }, { 0.25f, 0.50001f } };
+		TestVertex negativeZero = a;
+		negativeZero.m_Normal[0] = -0.0f;
+		// Closer than 0.001 too a, but across the rounding edge of a 0.001 grid
+		TestVertex acrossEdge = a;
+		acrossEdge.m_Texture[0] = 0.2506f;
+		TestVertex far = a;
+		far.m_Position[0] = 1.01f;
+
+		// Exact only merges identical bytes, -0 and 0 differ
+		VertexWelder exact(sizeof(TestVertex));
+		exact.SetHashFunction(hash);
+		CHECK(exact.Add(&a) == 0);
+		CHECK(exact.Add(&nearA) == 1);
+		CHECK(exact.Add(&negativeZero) == 2);
+		CHECK(exact.Add(&acrossEdge) == 3);
+		CHECK(exact.Add(&far) == 4);
+		CHECK(exact.Add(&a) == 0);
+		CHECK(exact.Count() == 5);
+
+		// Epsilon snaps too a 0.001 grid first
+		VertexWelder snapped(sizeof(TestVertex), 0, 0.001f);
+		snapped.SetHashFunction(hash);
+		CHECK(snapped.Add(&nearA) == 0);
+		CHECK(snapped.Add(&a) == 0);
+		CHECK(snapped.Add(&negativeZero) == 0);
+		CHECK(snapped.Add(&acrossEdge) == 1);
+		CHECK(snapped.Add(&far) == 2);
+		CHECK(snapped.Count() == 3);
+
+		// The first vertex seen is the one kept, not its snapped key
+		CHECK(std::memcmp(snapped.Vertices(), &nearA, sizeof(TestVertex)) == 0);
+		CHECK(std::memcmp(snapped.Vertices() + sizeof(TestVertex), &acrossEdge, sizeof(TestVertex)) == 0);
+	}
+
+	// A jittered grid welds back too the clean one's vertex count with an epsilon and not without
+	std::vector<TestVertex> corners = GridCorners(40, 3);
+	std::mt19937 random(4);
+	std::uniform_real_distribution<float> jitter(-0.00002f, 0.00002f);
+	for (TestVertex& corner : corners)
+	{
+		corner.m_Position[0] += jitter(random);
+		corner.m_Position[2] += jitter(random);
+	}
+
+	VertexWelder exact(sizeof(TestVertex), corners.size());
+	VertexWelder snapped(sizeof(TestVertex), corners.size(), 0.001f);
+	for (const TestVertex& corner : corners)
+	{
+		exact.Add(&corner);
+		snapped.Add(&corner);
+	}
+	CHECK(snapped.Count() == 41 * 41);
+	CHECK(exact.Count() > snapped.Count());
+}
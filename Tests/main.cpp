@@ -0,0 +1,160 @@
+#include "Test.h"
+#include "FileSystem/File/BinaryFile.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#ifdef WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <dirent.h>
+#endif
+
+namespace
+{
+	struct TestCase
+	{
+		const char*		m_Name;
+		Test::Function	m_Function;
+	};
+
+	// Function local so registration from other files cant run before it exists
+	std::vector<TestCase>& Tests()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	u32 s_Failures = 0;
+};
+
+bool Test::Register(const char* name, Function function)
+{
+	Tests().push_back({ name, function });
+	return true;
+}
+
+void Test::Fail(const char* file, int line, const char* expression)
+{
+	printf("    %s(%d): %s\n", file, line, expression);
+	++s_Failures;
+}
+
+std::vector<u8> Test::RandomBytes(u32 size, u32 seed)
+{
+	std::mt19937 random(seed);
+	std::vector<u8> data(size);
+	for (u8& value : data)
+	{
+		value = (u8)random();
+	}
+	return data;
+}
+
+std::vector<u8> Test::RandomText(u32 size, u32 seed)
+{
+	static const char* words[] = { "vertex ", "index ", "mesh ", "pak ", "chunk ", "texture ", "shader ", "\n" };
+
+	std::mt19937 random(seed);
+	std::vector<u8> data;
+	data.reserve(size);
+	while (data.size() < size)
+	{
+		const char* word = words[random() % 8];
+		while (*word != '\0' && data.size() < size)
+		{
+			data.push_back((u8)*word++);
+		}
+	}
+	return data;
+}
+
+bool Test::WriteFile(const std::string& path, const std::vector<u8>& data)
+{
+	BinaryFile file(path, FileMode::Write);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	bool result = data.empty() || file.Write(data.data(), (u32)data.size());
+	file.Close();
+	return result;
+}
+
+bool Test::ReadFile(const std::string& path, std::vector<u8>& data)
+{
+	BinaryFile file(path, FileMode::Read);
+	if (file.IsOpen() == false)
+	{
+		return false;
+	}
+
+	data.resize((size_t)file.FileSize());
+	bool result = data.empty() || file.Read(data.data(), (u32)data.size());
+	file.Close();
+	return result;
+}
+
+void Test::RemoveFile(const std::string& path)
+{
+	std::remove(path.c_str());
+}
+
+u32 Test::OpenHandleCount()
+{
+#ifdef WIN32
+	DWORD count = 0;
+	GetProcessHandleCount(GetCurrentProcess(), &count);
+	return (u32)count;
+#else
+	u32 count = 0;
+	DIR* directory = opendir("/proc/self/fd");
+	if (directory != nullptr)
+	{
+		while (readdir(directory) != nullptr)
+		{
+			++count;
+		}
+		closedir(directory);
+	}
+	return count;
+#endif
+}
+
+// Tests [Filter], runs every test whose name contains Filter and returns the failure count
+int main(int argc, char** argv)
+{
+	std::string filter = (argc > 1) ? argv[1] : "";
+
+	u32 run = 0;
+	u32 failed = 0;
+	for (const TestCase& test : Tests())
+	{
+		if (filter.empty() == false && std::string(test.m_Name).find(filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		printf("%s\n", test.m_Name);
+		u32 failures = s_Failures;
+		auto start = std::chrono::steady_clock::now();
+		test.m_Function();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		++run;
+		if (s_Failures != failures)
+		{
+			++failed;
+			printf("  FAILED (%.2fs)\n", seconds);
+		}
+		else
+		{
+			printf("  ok (%.2fs)\n", seconds);
+		}
+	}
+
+	printf("%u of %u tests passed\n", run - failed, run);
+	return (int)failed;
+}